@@ -0,0 +1,322 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "http_multipart.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace jessilib {
+
+namespace {
+
+constexpr size_t max_boundary_length = 70; // RFC 2046
+
+std::string_view trim_whitespace(std::string_view in_string) {
+	size_t begin = in_string.find_first_not_of(" \t");
+	if (begin == std::string_view::npos) {
+		return {};
+	}
+
+	size_t end = in_string.find_last_not_of(" \t");
+	return in_string.substr(begin, end - begin + 1);
+}
+
+bool equals_ignore_case(std::string_view in_lhs, std::string_view in_rhs) {
+	return std::equal(in_lhs.begin(), in_lhs.end(), in_rhs.begin(), in_rhs.end(), [](char in_lhs, char in_rhs) {
+		auto to_lower = [](char in_char) { return in_char >= 'A' && in_char <= 'Z' ? static_cast<char>(in_char + ('a' - 'A')) : in_char; };
+		return to_lower(in_lhs) == to_lower(in_rhs);
+	});
+}
+
+} // namespace
+
+multipart_parser::multipart_parser(std::string_view in_boundary, callbacks in_callbacks)
+	: m_callbacks{ std::move(in_callbacks) } {
+	if (in_boundary.empty() || in_boundary.size() > max_boundary_length) {
+		throw std::invalid_argument{ "Multipart boundary must be 1 to 70 characters long" };
+	}
+
+	m_delimiter = "\r\n--";
+	m_delimiter += in_boundary;
+
+	// Boyer-Moore-Horspool; shift by the distance from the last occurrence of the mismatched unit to the end
+	m_skip_table.fill(m_delimiter.size());
+	for (size_t index = 0; index != m_delimiter.size() - 1; ++index) {
+		m_skip_table[static_cast<unsigned char>(m_delimiter[index])] = m_delimiter.size() - 1 - index;
+	}
+
+	m_lookbehind.reserve(m_delimiter.size());
+	m_header_line.reserve(256);
+	reset();
+}
+
+template<typename CallbackT>
+bool multipart_parser::find_delimiter(std::string_view& inout_chunk, CallbackT&& in_data_callback) {
+	std::string_view delimiter = m_delimiter;
+
+	if (!m_lookbehind.empty()) {
+		// Check if the held back bytes and the start of this chunk make up a delimiter
+		std::string_view lookbehind = m_lookbehind;
+		for (size_t start = 0; start != lookbehind.size(); ++start) {
+			std::string_view held = lookbehind.substr(start);
+			if (!delimiter.starts_with(held)) {
+				continue;
+			}
+
+			std::string_view remaining = delimiter.substr(held.size());
+			std::string_view chunk_start = inout_chunk.substr(0, remaining.size());
+			if (!remaining.starts_with(chunk_start)) {
+				continue;
+			}
+
+			// Everything before the match is data
+			if (start != 0) {
+				in_data_callback(lookbehind.substr(0, start));
+			}
+
+			if (chunk_start.size() == remaining.size()) {
+				// Found the delimiter
+				m_lookbehind.clear();
+				inout_chunk.remove_prefix(remaining.size());
+				return true;
+			}
+
+			// Still only the start of a delimiter; keep holding it back
+			m_lookbehind.erase(0, start);
+			m_lookbehind += inout_chunk;
+			inout_chunk = {};
+			return false;
+		}
+
+		// The held back bytes weren't part of a delimiter after all
+		in_data_callback(lookbehind);
+		m_lookbehind.clear();
+	}
+
+	// Search the rest of the chunk
+	const char* data = inout_chunk.data();
+	size_t size = inout_chunk.size();
+	size_t position = 0;
+	while (position + delimiter.size() <= size) {
+		unsigned char last = static_cast<unsigned char>(data[position + delimiter.size() - 1]);
+		if (last == static_cast<unsigned char>(delimiter.back())
+			&& std::memcmp(data + position, delimiter.data(), delimiter.size() - 1) == 0) {
+			if (position != 0) {
+				in_data_callback(inout_chunk.substr(0, position));
+			}
+
+			inout_chunk.remove_prefix(position + delimiter.size());
+			return true;
+		}
+
+		position += m_skip_table[last];
+	}
+
+	// Hold back the longest suffix of the chunk which is the start of a delimiter
+	size_t hold_start = size >= delimiter.size() ? size - delimiter.size() + 1 : 0;
+	while (hold_start != size && !delimiter.starts_with(inout_chunk.substr(hold_start))) {
+		++hold_start;
+	}
+
+	if (hold_start != 0) {
+		in_data_callback(inout_chunk.substr(0, hold_start));
+	}
+
+	m_lookbehind.assign(inout_chunk.substr(hold_start));
+	inout_chunk = {};
+	return false;
+}
+
+bool multipart_parser::parse_header_line() {
+	std::string_view line = m_header_line;
+	if (!line.empty() && line.back() == '\r') {
+		line.remove_suffix(1);
+	}
+
+	if (line.empty()) {
+		// End of headers
+		m_state = state::data;
+		return true;
+	}
+
+	size_t colon = line.find(':');
+	if (colon == std::string_view::npos) {
+		return false;
+	}
+
+	if (m_callbacks.on_header) {
+		m_callbacks.on_header(trim_whitespace(line.substr(0, colon)), trim_whitespace(line.substr(colon + 1)));
+	}
+
+	m_header_line.clear();
+	return true;
+}
+
+bool multipart_parser::parse(std::string_view in_chunk) {
+	auto ignore_data = [](std::string_view) {};
+	auto pass_data = [this](std::string_view in_data) {
+		if (m_callbacks.on_data) {
+			m_callbacks.on_data(in_data);
+		}
+	};
+
+	while (!in_chunk.empty() && m_state != state::error) {
+		switch (m_state) {
+			case state::preamble:
+				if (find_delimiter(in_chunk, ignore_data)) {
+					m_state = state::boundary_end;
+				}
+				break;
+
+			case state::boundary_end: {
+				char unit = in_chunk.front();
+				in_chunk.remove_prefix(1);
+				if (unit == '-') {
+					m_state = state::boundary_close;
+				}
+				else if (unit == '\r') {
+					m_state = state::boundary_line_feed;
+				}
+				else if (unit == ' ' || unit == '\t') {
+					m_state = state::boundary_padding;
+				}
+				else {
+					m_state = state::error;
+				}
+				break;
+			}
+
+			case state::boundary_close:
+				m_state = in_chunk.front() == '-' ? state::epilogue : state::error;
+				in_chunk.remove_prefix(1);
+				break;
+
+			case state::boundary_padding: {
+				char unit = in_chunk.front();
+				in_chunk.remove_prefix(1);
+				if (unit == '\r') {
+					m_state = state::boundary_line_feed;
+				}
+				else if (unit != ' ' && unit != '\t') {
+					m_state = state::error;
+				}
+				break;
+			}
+
+			case state::boundary_line_feed:
+				if (in_chunk.front() != '\n') {
+					m_state = state::error;
+					break;
+				}
+
+				in_chunk.remove_prefix(1);
+				m_state = state::headers;
+				m_header_line.clear();
+				m_headers_size = 0;
+				if (m_callbacks.on_part_begin) {
+					m_callbacks.on_part_begin();
+				}
+				break;
+
+			case state::headers: {
+				size_t line_end = in_chunk.find('\n');
+				std::string_view line = in_chunk.substr(0, line_end);
+				m_headers_size += line.size();
+				if (m_headers_size > max_headers_size) {
+					m_state = state::error;
+					break;
+				}
+
+				m_header_line += line;
+				if (line_end == std::string_view::npos) {
+					// Rest of the line is in the next chunk
+					in_chunk = {};
+					break;
+				}
+
+				in_chunk.remove_prefix(line_end + 1);
+				if (!parse_header_line()) {
+					m_state = state::error;
+				}
+				break;
+			}
+
+			case state::data:
+				if (find_delimiter(in_chunk, pass_data)) {
+					if (m_callbacks.on_part_end) {
+						m_callbacks.on_part_end();
+					}
+					m_state = state::boundary_end;
+				}
+				break;
+
+			case state::epilogue:
+				in_chunk = {};
+				break;
+
+			case state::error:
+				break;
+		}
+	}
+
+	return m_state != state::error;
+}
+
+bool multipart_parser::complete() const {
+	return m_state == state::epilogue;
+}
+
+bool multipart_parser::failed() const {
+	return m_state == state::error;
+}
+
+void multipart_parser::reset() {
+	m_state = state::preamble;
+	m_header_line.clear();
+	m_headers_size = 0;
+
+	// The first boundary needn't be preceded by a line break
+	m_lookbehind = "\r\n";
+}
+
+std::string_view multipart_parser::content_type_boundary(std::string_view in_content_type) {
+	using namespace std::literals;
+	while (!in_content_type.empty()) {
+		size_t parameter_end = in_content_type.find(';');
+		std::string_view parameter = trim_whitespace(in_content_type.substr(0, parameter_end));
+		in_content_type.remove_prefix(parameter_end == std::string_view::npos ? in_content_type.size() : parameter_end + 1);
+
+		size_t equals = parameter.find('=');
+		if (equals == std::string_view::npos
+			|| !equals_ignore_case(trim_whitespace(parameter.substr(0, equals)), "boundary"sv)) {
+			continue;
+		}
+
+		std::string_view value = trim_whitespace(parameter.substr(equals + 1));
+		if (value.size() >= 2 && value.front() == '\"' && value.back() == '\"') {
+			value = value.substr(1, value.size() - 2);
+		}
+
+		return value;
+	}
+
+	return {};
+}
+
+} // namespace jessilib
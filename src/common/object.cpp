@@ -24,7 +24,7 @@ object::object(const object& in_object) {
 	m_value = in_object.m_value;
 }
 
-object::object(object&& in_object) {
+object::object(object&& in_object) noexcept {
 	m_value = std::move(in_object.m_value);
 }
 
@@ -20,47 +20,67 @@
 
 namespace jessilib {
 
-object json_parser::deserialize_bytes(bytes_view_type in_data, text_encoding in_write_encoding) {
-	object result;
+namespace {
 
-	if (in_write_encoding == text_encoding::utf_8) {
-		std::u8string_view data_view = jessilib::string_view_cast<char8_t>(in_data);
-		deserialize_json<char8_t, true>(result, data_view);
+// Calls in_callback with a native string_view over in_data, recoding or byteswapping into a temporary as needed
+template<typename CallbackT>
+void visit_json_bytes(parser::bytes_view_type in_data, text_encoding in_read_encoding, CallbackT&& in_callback) {
+	if (in_read_encoding == text_encoding::utf_8) {
+		in_callback(jessilib::string_view_cast<char8_t>(in_data));
 	}
-	else if (in_write_encoding == text_encoding::utf_16) {
-		std::u16string_view data_view = jessilib::string_view_cast<char16_t>(in_data);
-		deserialize_json<char16_t, true>(result, data_view);
+	else if (in_read_encoding == text_encoding::utf_16) {
+		in_callback(jessilib::string_view_cast<char16_t>(in_data));
 	}
-	else if (in_write_encoding == text_encoding::utf_32) {
-		std::u32string_view data_view = jessilib::string_view_cast<char32_t>(in_data);
-		deserialize_json<char32_t, true>(result, data_view);
+	else if (in_read_encoding == text_encoding::utf_32) {
+		in_callback(jessilib::string_view_cast<char32_t>(in_data));
 	}
-	else if (in_write_encoding == text_encoding::wchar) {
-		std::wstring_view data_view = jessilib::string_view_cast<wchar_t>(in_data);
-		deserialize_json<wchar_t, true>(result, data_view);
+	else if (in_read_encoding == text_encoding::wchar) {
+		in_callback(jessilib::string_view_cast<wchar_t>(in_data));
 	}
-	else if (in_write_encoding == text_encoding::multibyte) {
-		// TODO: support without copying
+	else if (in_read_encoding == text_encoding::multibyte) {
+		// Multi-byte data is already UTF-8 in UTF-8 locales, as is ASCII in ASCII-compatible ones
+		auto u8_view = jessilib::string_view_cast<char8_t>(in_data);
+		impl_unicode::multibyte_encoding encoding = impl_unicode::current_multibyte_encoding();
+		if (encoding == impl_unicode::multibyte_encoding::utf_8
+			|| (encoding == impl_unicode::multibyte_encoding::ascii && impl_unicode::is_ascii(u8_view))) {
+			in_callback(u8_view);
+			return;
+		}
+
 		auto u8_data = mbstring_to_ustring<char8_t>(jessilib::string_view_cast<char>(in_data));
-		std::u8string_view data_view = u8_data.second;
-		deserialize_json<char8_t, true>(result, data_view);
+		in_callback(std::u8string_view{ u8_data.second });
 	}
-	else if (in_write_encoding == text_encoding::utf_16_foreign) {
+	else if (in_read_encoding == text_encoding::utf_16_foreign) {
 		// TODO: support without copying
 		std::u16string u16_data{ jessilib::string_view_cast<char16_t>(in_data) };
 		array_byteswap(u16_data.data(), u16_data.data() + u16_data.size());
-		std::u16string_view data_view = u16_data;
-
-		deserialize_json<char16_t, true>(result, data_view);
+		in_callback(std::u16string_view{ u16_data });
 	}
-	else if (in_write_encoding == text_encoding::utf_32_foreign) {
+	else if (in_read_encoding == text_encoding::utf_32_foreign) {
 		// TODO: support without copying
 		std::u32string u32_data{ jessilib::string_view_cast<char32_t>(in_data) };
 		array_byteswap(u32_data.data(), u32_data.data() + u32_data.size());
-		std::u32string_view data_view = u32_data;
-
-		deserialize_json<char32_t, true>(result, data_view);
+		in_callback(std::u32string_view{ u32_data });
 	}
+}
+
+} // namespace
+
+object json_parser::deserialize_bytes(bytes_view_type in_data, text_encoding in_read_encoding) {
+	object result;
+	visit_json_bytes(in_data, in_read_encoding, [&result](auto in_data_view) {
+		using CharT = typename decltype(in_data_view)::value_type;
+		deserialize_json_iterative<CharT, true>(result, in_data_view);
+	});
+
+	return result;
+}
+
+json_parse_result json_parser::try_deserialize_bytes(bytes_view_type in_data, text_encoding in_read_encoding) {
+	json_parse_result result;
+	visit_json_bytes(in_data, in_read_encoding, [&result](auto in_data_view) {
+		result = try_deserialize_json(in_data_view);
+	});
 
 	return result;
 }
@@ -76,6 +96,9 @@ std::string json_parser::serialize_bytes(const object& in_object, text_encoding
 		case text_encoding::wchar:
 			return serialize_impl<wchar_t, char>(in_object);
 		case text_encoding::multibyte:
+			if (impl_unicode::current_multibyte_encoding() == impl_unicode::multibyte_encoding::utf_8) {
+				return serialize_impl<char8_t, char>(in_object);
+			}
 			return ustring_to_mbstring(serialize_impl<char8_t>(in_object)).second;
 
 			// Other-endianness
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "parsers/json_literal.hpp"
+
+namespace jessilib {
+
+namespace {
+
+object::string_type node_string(const char8_t* in_text, size_t in_offset, size_t in_size) {
+	return { in_text + in_offset, in_size };
+}
+
+object build_object(const json_literal_node*& inout_node, const char8_t* in_text) {
+	const json_literal_node& node = *inout_node;
+	++inout_node;
+
+	switch (node.type) {
+		case object::type::boolean:
+			return node.boolean;
+
+		case object::type::integer:
+			return node.integer;
+
+		case object::type::decimal:
+			return node.decimal;
+
+		case object::type::text:
+			return node_string(in_text, node.text_offset, node.text_size);
+
+		case object::type::array: {
+			object::array_type result;
+			result.reserve(node.size);
+			for (size_t index = 0; index != node.size; ++index) {
+				result.push_back(build_object(inout_node, in_text));
+			}
+
+			return result;
+		}
+
+		case object::type::map: {
+			object::map_type result;
+			for (size_t index = 0; index != node.size; ++index) {
+				const json_literal_node& member = *inout_node;
+				result.insert_or_assign(node_string(in_text, member.key_offset, member.key_size), build_object(inout_node, in_text));
+			}
+
+			return object{ std::move(result) };
+		}
+
+		default:
+			return {};
+	}
+}
+
+} // namespace
+
+object make_json_literal_object(const json_literal_node* in_nodes, const char8_t* in_text) {
+	return build_object(in_nodes, in_text);
+}
+
+} // namespace jessilib
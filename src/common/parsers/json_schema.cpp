@@ -0,0 +1,267 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "parsers/json_schema.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace jessilib {
+
+namespace {
+
+constexpr uint32_t type_bit(enum object::type in_type) {
+	return uint32_t{1} << static_cast<size_t>(in_type);
+}
+
+uint32_t parse_type_name(const object& in_name) {
+	using namespace std::literals;
+	object::string_type name = in_name.get<object::string_type>();
+	if (name == u8"null"sv) {
+		return type_bit(object::type::null);
+	}
+	if (name == u8"boolean"sv) {
+		return type_bit(object::type::boolean);
+	}
+	if (name == u8"integer"sv) {
+		return type_bit(object::type::integer);
+	}
+	if (name == u8"number"sv) {
+		return type_bit(object::type::integer) | type_bit(object::type::decimal);
+	}
+	if (name == u8"string"sv) {
+		return type_bit(object::type::text);
+	}
+	if (name == u8"array"sv) {
+		return type_bit(object::type::array);
+	}
+	if (name == u8"object"sv) {
+		return type_bit(object::type::map);
+	}
+
+	throw std::invalid_argument{ jessilib::join_mbstring(u8"Invalid JSON schema; unknown type: "sv, object::string_view_type{ name }) };
+}
+
+std::optional<long double> get_number(const object& in_object) {
+	switch (in_object.type()) {
+		case object::type::integer:
+			return static_cast<long double>(in_object.get<intmax_t>());
+		case object::type::decimal:
+			return in_object.get<long double>();
+		default:
+			return std::nullopt;
+	}
+}
+
+size_t get_count(const object& in_object, const char* in_keyword) {
+	if (in_object.type() != object::type::integer || in_object.get<intmax_t>() < 0) {
+		throw std::invalid_argument{ std::string{ "Invalid JSON schema; expected non-negative integer for " } + in_keyword };
+	}
+
+	return static_cast<size_t>(in_object.get<intmax_t>());
+}
+
+} // namespace
+
+/** json_schema */
+
+json_schema::json_schema(const object& in_schema) {
+	compile(in_schema);
+}
+
+size_t json_schema::compile(const object& in_schema) {
+	using namespace std::literals;
+	static const object::map_type s_null_map;
+	static const object::array_type s_null_array;
+
+	if (in_schema.type() != object::type::map) {
+		throw std::invalid_argument{ "Invalid JSON schema; schema must be an object" };
+	}
+
+	// Reserve our index up front; m_nodes may be resized by nested compile() calls, so don't hold references into it
+	size_t index = m_nodes.size();
+	m_nodes.emplace_back();
+	node result;
+
+	const object& types = in_schema[u8"type"s];
+	if (types.type() == object::type::text) {
+		result.types = parse_type_name(types);
+	}
+	else if (types.type() == object::type::array) {
+		result.types = 0;
+		for (auto& type : types.get<object::array_type>(s_null_array)) {
+			result.types |= parse_type_name(type);
+		}
+	}
+
+	const object& enum_values = in_schema[u8"enum"s];
+	if (enum_values.type() == object::type::array) {
+		result.enum_values = enum_values.get<object::array_type>(s_null_array);
+	}
+
+	result.minimum = get_number(in_schema[u8"minimum"s]);
+	result.maximum = get_number(in_schema[u8"maximum"s]);
+
+	const object& min_items = in_schema[u8"minItems"s];
+	if (!min_items.null()) {
+		result.min_items = get_count(min_items, "minItems");
+	}
+
+	const object& max_items = in_schema[u8"maxItems"s];
+	if (!max_items.null()) {
+		result.max_items = get_count(max_items, "maxItems");
+	}
+
+	const object& items = in_schema[u8"items"s];
+	if (!items.null()) {
+		result.items = compile(items);
+	}
+
+	for (auto& item : in_schema[u8"properties"s].get<object::map_type>(s_null_map)) {
+		result.properties[item.first] = { compile(item.second), npos };
+	}
+
+	for (auto& key : in_schema[u8"required"s].get<object::array_type>(s_null_array)) {
+		if (key.type() != object::type::text) {
+			throw std::invalid_argument{ "Invalid JSON schema; required must be an array of strings" };
+		}
+
+		if (result.required_count == max_required) {
+			throw std::invalid_argument{ "Invalid JSON schema; too many required properties" };
+		}
+
+		auto itr = result.properties.try_emplace(key.get<object::string_type>(), property{ npos, npos }).first;
+		if (itr->second.required_index == npos) {
+			itr->second.required_index = result.required_count++;
+		}
+	}
+
+	const object& additional_properties = in_schema[u8"additionalProperties"s];
+	if (additional_properties.type() == object::type::boolean) {
+		result.additional_properties = additional_properties.get<bool>();
+	}
+
+	m_nodes[index] = std::move(result);
+	return index;
+}
+
+bool json_schema::check_value(size_t in_node, const object& in_value) const {
+	const node& schema_node = m_nodes[in_node];
+	if ((schema_node.types & type_bit(in_value.type())) == 0) {
+		return false;
+	}
+
+	if (!schema_node.enum_values.empty()
+		&& std::find(schema_node.enum_values.begin(), schema_node.enum_values.end(), in_value) == schema_node.enum_values.end()) {
+		return false;
+	}
+
+	if (schema_node.minimum.has_value() || schema_node.maximum.has_value()) {
+		std::optional<long double> number = get_number(in_value);
+		if (number.has_value()) {
+			if ((schema_node.minimum.has_value() && *number < *schema_node.minimum)
+				|| (schema_node.maximum.has_value() && *number > *schema_node.maximum)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/** json_schema_validator */
+
+json_schema_validator::json_schema_validator(const json_schema& in_schema)
+	: m_schema{ in_schema } {
+	// Empty ctor body
+}
+
+void json_schema_validator::reset() {
+	m_stack.clear();
+	m_next_node = 0;
+}
+
+bool json_schema_validator::on_container_start(bool in_is_map) {
+	if (m_next_node != json_schema::npos) {
+		if ((m_schema.get_node(m_next_node).types & type_bit(in_is_map ? object::type::map : object::type::array)) == 0) {
+			return false;
+		}
+	}
+
+	m_stack.push_back({ m_next_node, 0, 0 });
+	return true;
+}
+
+bool json_schema_validator::on_element() {
+	frame& container = m_stack.back();
+	++container.count;
+	if (container.node == json_schema::npos) {
+		m_next_node = json_schema::npos;
+		return true;
+	}
+
+	const json_schema::node& schema_node = m_schema.get_node(container.node);
+	m_next_node = schema_node.items;
+	return container.count <= schema_node.max_items;
+}
+
+bool json_schema_validator::on_key(object::string_view_type in_key) {
+	frame& container = m_stack.back();
+	if (container.node == json_schema::npos) {
+		m_next_node = json_schema::npos;
+		return true;
+	}
+
+	const json_schema::node& schema_node = m_schema.get_node(container.node);
+	auto itr = schema_node.properties.find(in_key);
+	if (itr == schema_node.properties.end()) {
+		m_next_node = json_schema::npos;
+		return schema_node.additional_properties;
+	}
+
+	if (itr->second.required_index != json_schema::npos) {
+		container.required_seen |= uint64_t{1} << itr->second.required_index;
+	}
+
+	m_next_node = itr->second.node;
+	return true;
+}
+
+bool json_schema_validator::on_value(const object& in_value) {
+	return m_next_node == json_schema::npos
+		|| m_schema.check_value(m_next_node, in_value);
+}
+
+bool json_schema_validator::on_container_end(const object& in_container) {
+	frame container = m_stack.back();
+	m_stack.pop_back();
+	if (container.node == json_schema::npos) {
+		return true;
+	}
+
+	const json_schema::node& schema_node = m_schema.get_node(container.node);
+	if (container.count < schema_node.min_items
+		|| std::popcount(container.required_seen) != static_cast<int>(schema_node.required_count)) {
+		return false;
+	}
+
+	// Type was checked in on_container_start, but enum can only be checked once the container's complete
+	return schema_node.enum_values.empty()
+		|| m_schema.check_value(container.node, in_container);
+}
+
+} // namespace jessilib
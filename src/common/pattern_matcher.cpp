@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "pattern_matcher.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace jessilib {
+
+pattern_matcher::pattern_matcher(bool in_case_insensitive)
+	: m_case_insensitive{ in_case_insensitive } {
+	// Empty ctor body
+}
+
+bool pattern_matcher::remove(size_t in_pattern) {
+	if (in_pattern >= m_patterns.size()
+		|| !m_patterns[in_pattern].active) {
+		return false;
+	}
+
+	m_patterns[in_pattern].active = false;
+	--m_active_patterns;
+	if (in_pattern < m_pending_patterns) {
+		++m_removed_patterns;
+	}
+
+	return true;
+}
+
+void pattern_matcher::rebuild() {
+	if (m_removed_patterns > m_active_patterns) {
+		// Removed patterns make up most of the trie; start over with just the active ones
+		m_nodes.assign(1, node{});
+		m_pending_patterns = 0;
+		m_removed_patterns = 0;
+		m_max_length = 0;
+	}
+
+	for (; m_pending_patterns != m_patterns.size(); ++m_pending_patterns) {
+		if (m_patterns[m_pending_patterns].active) {
+			insert(static_cast<uint32_t>(m_pending_patterns));
+		}
+	}
+
+	// Breadth-first, so that every node's failure is processed before the node itself
+	std::vector<uint32_t> queue;
+	queue.reserve(m_nodes.size());
+	m_nodes[root].failure = root;
+	m_nodes[root].output = no_node;
+	queue.push_back(root);
+	for (size_t index = 0; index != queue.size(); ++index) {
+		uint32_t parent = queue[index];
+		for (auto& [codepoint, child_node] : m_nodes[parent].children) {
+			uint32_t failure = root;
+			if (parent != root) {
+				failure = next_state(m_nodes[parent].failure, codepoint);
+			}
+
+			node& child_data = m_nodes[child_node];
+			child_data.failure = failure;
+			child_data.output = m_nodes[failure].patterns.empty() ? m_nodes[failure].output : failure;
+			queue.push_back(child_node);
+		}
+	}
+
+	// Dense transitions for ASCII; missing children inherit the failure's transition
+	m_ascii_transitions.assign(m_nodes.size() * ascii_size, root);
+	for (uint32_t state : queue) {
+		uint32_t* transitions = &m_ascii_transitions[state * ascii_size];
+		if (state != root) {
+			const uint32_t* failure_transitions = &m_ascii_transitions[m_nodes[state].failure * ascii_size];
+			std::copy_n(failure_transitions, ascii_size, transitions);
+		}
+
+		for (auto& [codepoint, child_node] : m_nodes[state].children) {
+			if (codepoint >= ascii_size) {
+				// Children are sorted; everything after this isn't ASCII either
+				break;
+			}
+
+			transitions[codepoint] = child_node;
+		}
+	}
+
+	m_history_size = std::bit_ceil(m_max_length + 1);
+}
+
+void pattern_matcher::clear() {
+	m_patterns.clear();
+	m_pending_patterns = 0;
+	m_active_patterns = 0;
+	m_removed_patterns = 0;
+	m_max_length = 0;
+	m_history_size = 1;
+	m_nodes.assign(1, node{});
+	m_ascii_transitions.clear();
+}
+
+uint32_t pattern_matcher::child(uint32_t in_node, char32_t in_codepoint) const {
+	auto& children = m_nodes[in_node].children;
+	auto itr = std::lower_bound(children.begin(), children.end(), in_codepoint, [](const auto& in_child, char32_t in_codepoint) {
+		return in_child.first < in_codepoint;
+	});
+
+	if (itr == children.end() || itr->first != in_codepoint) {
+		return no_node;
+	}
+
+	return itr->second;
+}
+
+uint32_t pattern_matcher::next_state(uint32_t in_state, char32_t in_codepoint) const {
+	while (true) {
+		uint32_t result = child(in_state, in_codepoint);
+		if (result != no_node) {
+			return result;
+		}
+
+		if (in_state == root) {
+			return root;
+		}
+
+		in_state = m_nodes[in_state].failure;
+	}
+}
+
+void pattern_matcher::insert(uint32_t in_pattern) {
+	const std::u32string& codepoints = m_patterns[in_pattern].codepoints;
+	uint32_t state = root;
+	for (char32_t codepoint : codepoints) {
+		auto& children = m_nodes[state].children;
+		auto itr = std::lower_bound(children.begin(), children.end(), codepoint, [](const auto& in_child, char32_t in_codepoint) {
+			return in_child.first < in_codepoint;
+		});
+
+		if (itr != children.end() && itr->first == codepoint) {
+			state = itr->second;
+			continue;
+		}
+
+		// Add a new node; m_nodes may reallocate, so children must not be used past this point
+		uint32_t new_node = static_cast<uint32_t>(m_nodes.size());
+		children.emplace(itr, codepoint, new_node);
+		m_nodes.emplace_back();
+		state = new_node;
+	}
+
+	m_nodes[state].patterns.push_back(in_pattern);
+	m_max_length = std::max(m_max_length, codepoints.size());
+}
+
+} // namespace jessilib
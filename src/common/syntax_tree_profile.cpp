@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "syntax_tree_profile.hpp"
+#include <cstdio>
+#include "object.hpp"
+#include "unicode_base.hpp"
+
+namespace jessilib {
+
+namespace {
+
+thread_local syntax_tree_profile* g_current_profile{};
+
+object to_object(const syntax_tree_profile::counters& in_counters) {
+	object result;
+	result[u8"invocations"] = in_counters.invocations;
+	result[u8"bytes"] = in_counters.bytes;
+	return result;
+}
+
+} // namespace
+
+syntax_tree_profile::scope::scope(syntax_tree_profile& in_profile)
+	: m_previous{ g_current_profile } {
+	g_current_profile = &in_profile;
+}
+
+syntax_tree_profile::scope::~scope() {
+	g_current_profile = m_previous;
+}
+
+syntax_tree_profile* syntax_tree_profile::current() {
+	return g_current_profile;
+}
+
+void syntax_tree_profile::record_member(const void* in_tree, char32_t in_codepoint, size_t in_bytes) {
+	counters& member = get_tree(in_tree).members[in_codepoint];
+	++member.invocations;
+	member.bytes += in_bytes;
+}
+
+void syntax_tree_profile::record_default_action(const void* in_tree, size_t in_bytes, std::chrono::nanoseconds in_time) {
+	counters& default_action = get_tree(in_tree).default_action;
+	++default_action.invocations;
+	default_action.bytes += in_bytes;
+	default_action.time += in_time;
+}
+
+void syntax_tree_profile::set_tree_name(const void* in_tree, std::u8string in_name) {
+	get_tree(in_tree).name = std::move(in_name);
+}
+
+const std::unordered_map<const void*, syntax_tree_profile::tree_counters>& syntax_tree_profile::trees() const {
+	return m_trees;
+}
+
+void syntax_tree_profile::clear() {
+	// Keep the names, so that trees don't need to be renamed between runs
+	for (auto& tree : m_trees) {
+		tree.second.members.clear();
+		tree.second.default_action = {};
+	}
+}
+
+object syntax_tree_profile::to_object() const {
+	object result{ object::map_type{} };
+	for (auto& tree : m_trees) {
+		object tree_object{ object::map_type{} };
+		for (auto& member : tree.second.members) {
+			tree_object[encode_codepoint_u8(member.first)] = jessilib::to_object(member.second);
+		}
+
+		object& default_action = tree_object[u8"default_action"];
+		default_action = jessilib::to_object(tree.second.default_action);
+		default_action[u8"nanoseconds"] = tree.second.default_action.time.count();
+		result[tree.second.name] = std::move(tree_object);
+	}
+
+	return result;
+}
+
+syntax_tree_profile::tree_counters& syntax_tree_profile::get_tree(const void* in_tree) {
+	auto itr = m_trees.find(in_tree);
+	if (itr != m_trees.end()) {
+		return itr->second;
+	}
+
+	tree_counters& result = m_trees[in_tree];
+	char name[32];
+	int name_length = std::snprintf(name, sizeof(name), "tree@%p", in_tree);
+	result.name.assign(name, name + name_length);
+	return result;
+}
+
+} // namespace jessilib
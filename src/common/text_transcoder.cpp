@@ -0,0 +1,479 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "text_transcoder.hpp"
+#include <stdexcept>
+#include "unicode.hpp"
+#include "util.hpp"
+
+namespace jessilib {
+namespace {
+
+constexpr size_t block_units = 256; // Input units transcoded per block; bounds stack usage
+constexpr char32_t replacement_codepoint = 0xFFFD;
+constexpr size_t unencodable = static_cast<size_t>(-1);
+
+enum class read_status {
+	ok,
+	incomplete, // More input is needed to tell whether the sequence is valid
+	invalid
+};
+
+struct read_result {
+	read_status status;
+	char32_t codepoint;
+	size_t bytes;
+};
+
+enum class step_status {
+	ok,
+	incomplete,
+	output_full,
+	invalid
+};
+
+// Index into text_transcoder's function table; by data unit size, with multibyte as 0
+size_t unit_index(text_encoding in_encoding) {
+	switch (in_encoding) {
+		case text_encoding::multibyte:
+			// Multi-byte text in a UTF-8 locale needn't go through libc
+			return impl_unicode::current_multibyte_encoding() == impl_unicode::multibyte_encoding::utf_8 ? 1 : 0;
+		case text_encoding::utf_8:
+			return 1;
+		case text_encoding::utf_16_little:
+		case text_encoding::utf_16_big:
+			return 2;
+		case text_encoding::utf_32_little:
+		case text_encoding::utf_32_big:
+			return 3;
+		case text_encoding::wchar:
+			return sizeof(wchar_t) == sizeof(char16_t) ? 2 : 3;
+		default:
+			throw std::invalid_argument{ "Invalid text_encoding; cannot transcode to or from an unknown encoding" };
+	}
+}
+
+bool is_foreign(text_encoding in_encoding) {
+	return in_encoding == text_encoding::utf_16_foreign || in_encoding == text_encoding::utf_32_foreign;
+}
+
+// Copies data units out of (potentially unaligned) bytes, into native byte order
+template<typename CharT>
+void load_units(const char* in_data, size_t in_count, bool in_swap, CharT* out_units) {
+	std::memcpy(out_units, in_data, in_count * sizeof(CharT));
+	if constexpr (sizeof(CharT) > 1) {
+		if (in_swap) {
+			array_byteswap(out_units, out_units + in_count);
+		}
+	}
+}
+
+// Copies data units into (potentially unaligned) bytes, swapping them in place first if necessary
+template<typename CharT>
+void store_units(CharT* in_units, size_t in_count, bool in_swap, char* out_data) {
+	if constexpr (sizeof(CharT) > 1) {
+		if (in_swap) {
+			array_byteswap(in_units, in_units + in_count);
+		}
+	}
+	std::memcpy(out_data, in_units, in_count * sizeof(CharT));
+}
+
+// Number of units in in_units, less any sequence at the end which is cut short
+template<typename CharT>
+size_t complete_length(const CharT* in_units, size_t in_count) {
+	if constexpr (sizeof(CharT) == 1) {
+		// Back up over continuation bytes to the last lead byte, and check that its sequence fits
+		size_t lead = in_count;
+		while (lead != 0 && in_count - lead < 4) {
+			--lead;
+			uint8_t value = static_cast<uint8_t>(in_units[lead]);
+			if ((value & 0xC0) != 0x80) {
+				size_t expected = (value < 0xC2 || value > 0xF4) ? 1 : (value >= 0xF0 ? 4 : (value >= 0xE0 ? 3 : 2));
+				return in_count - lead < expected ? lead : in_count;
+			}
+		}
+
+		return in_count;
+	}
+	else if constexpr (sizeof(CharT) == 2) {
+		// Hold back a trailing high surrogate
+		return in_count != 0 && (in_units[in_count - 1] & 0xFC00) == 0xD800 ? in_count - 1 : in_count;
+	}
+	else {
+		return in_count;
+	}
+}
+
+template<typename CharT>
+read_result read_codepoint(const char* in_data, size_t in_size, bool in_swap) {
+	CharT units[4 / sizeof(CharT)];
+	size_t count = std::min(in_size / sizeof(CharT), std::size(units));
+	if (count == 0) {
+		return { read_status::incomplete, 0, 0 };
+	}
+	load_units(in_data, count, in_swap, units);
+
+	if constexpr (sizeof(CharT) == 1) {
+		uint8_t lead = static_cast<uint8_t>(units[0]);
+		if (lead < 0x80) {
+			return { read_status::ok, lead, 1 };
+		}
+
+		size_t length = impl_unicode::utf8_sequence_length(units, units + count);
+		if (length != 0) {
+			return { read_status::ok, decode_codepoint(units, length).codepoint, length };
+		}
+
+		// Either the sequence is invalid, or it's cut short; pad it out with the lowest valid continuation bytes to tell
+		size_t expected = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : 2);
+		if (lead >= 0xC2 && lead <= 0xF4 && count < expected) {
+			CharT padded[4];
+			std::copy_n(units, count, padded);
+			std::fill(padded + count, padded + expected, static_cast<CharT>(0x80));
+			if (count == 1) {
+				padded[1] = static_cast<CharT>(lead == 0xE0 ? 0xA0 : (lead == 0xF0 ? 0x90 : 0x80));
+			}
+
+			if (impl_unicode::utf8_sequence_length(padded, padded + expected) != 0) {
+				return { read_status::incomplete, 0, 0 };
+			}
+		}
+
+		return { read_status::invalid, 0, 1 };
+	}
+	else if constexpr (sizeof(CharT) == 2) {
+		char16_t unit = units[0];
+		if ((unit & 0xF800) != 0xD800) {
+			return { read_status::ok, unit, 2 };
+		}
+
+		if ((unit & 0xFC00) == 0xDC00) {
+			// Lone low surrogate
+			return { read_status::invalid, 0, 2 };
+		}
+
+		if (count < 2) {
+			return { read_status::incomplete, 0, 0 };
+		}
+
+		if ((units[1] & 0xFC00) != 0xDC00) {
+			// Lone high surrogate
+			return { read_status::invalid, 0, 2 };
+		}
+
+		char32_t codepoint = 0x10000 + ((static_cast<char32_t>(unit) - 0xD800) << 10) + (units[1] - 0xDC00);
+		return { read_status::ok, codepoint, 4 };
+	}
+	else {
+		char32_t codepoint = units[0];
+		if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+			return { read_status::invalid, 0, 4 };
+		}
+
+		return { read_status::ok, codepoint, 4 };
+	}
+}
+
+read_result read_codepoint_multibyte(const char* in_data, size_t in_size, std::mbstate_t& inout_state) {
+	char32_t codepoint{};
+	size_t bytes_read = std::mbrtoc32(&codepoint, in_data, in_size, &inout_state);
+	if (bytes_read == static_cast<size_t>(-2)) {
+		// Incomplete; the bytes are stored in inout_state, so they're consumed
+		return { read_status::incomplete, 0, in_size };
+	}
+
+	if (bytes_read == static_cast<size_t>(-1)) {
+		inout_state = {};
+		return { read_status::invalid, 0, 1 };
+	}
+
+	if (bytes_read == static_cast<size_t>(-3)) {
+		// Codepoint was stored in inout_state by the previous call; no further input consumed
+		return { read_status::ok, codepoint, 0 };
+	}
+
+	// bytes_read is 0 for null characters
+	return { read_status::ok, codepoint, std::max(size_t{1}, bytes_read) };
+}
+
+// Returns bytes written, 0 if there isn't room
+template<typename CharT>
+size_t write_codepoint(char32_t in_codepoint, char* out_buffer, size_t in_room, bool in_swap) {
+	CharT units[4 / sizeof(CharT)];
+	size_t count = encode_codepoint(units, in_codepoint);
+	if (count * sizeof(CharT) > in_room) {
+		return 0;
+	}
+
+	store_units(units, count, in_swap, out_buffer);
+	return count * sizeof(CharT);
+}
+
+// Returns bytes written, 0 if there isn't room, or unencodable if the current locale can't represent in_codepoint
+size_t write_codepoint_multibyte(char32_t in_codepoint, char* out_buffer, size_t in_room, std::mbstate_t& inout_state) {
+	char buffer[MB_LEN_MAX]; // MB_LEN_MAX is constant, MB_CUR_MAX is not, and C++ doesn't have VLAs
+	std::mbstate_t state = inout_state; // Only committed once the output fits
+	size_t bytes_written = std::c32rtomb(buffer, in_codepoint, &state);
+	if (bytes_written > MB_LEN_MAX) {
+		return unencodable;
+	}
+
+	if (bytes_written > in_room) {
+		return 0;
+	}
+
+	std::memcpy(out_buffer, buffer, bytes_written);
+	inout_state = state;
+	return bytes_written;
+}
+
+} // namespace
+
+text_transcoder::text_transcoder(text_encoding in_read_encoding, text_encoding in_write_encoding, bool in_replace_invalid)
+	: m_read_encoding{ in_read_encoding },
+	m_write_encoding{ in_write_encoding },
+	m_replace_invalid{ in_replace_invalid },
+	m_read_swap{ is_foreign(in_read_encoding) },
+	m_write_swap{ is_foreign(in_write_encoding) } {
+	// Indexed by unit_index; char is the multibyte encoding
+	static constexpr transcode_function functions[4][4]{
+		{ &text_transcoder::transcode_impl<char, char>, &text_transcoder::transcode_impl<char, char8_t>,
+			&text_transcoder::transcode_impl<char, char16_t>, &text_transcoder::transcode_impl<char, char32_t> },
+		{ &text_transcoder::transcode_impl<char8_t, char>, &text_transcoder::transcode_impl<char8_t, char8_t>,
+			&text_transcoder::transcode_impl<char8_t, char16_t>, &text_transcoder::transcode_impl<char8_t, char32_t> },
+		{ &text_transcoder::transcode_impl<char16_t, char>, &text_transcoder::transcode_impl<char16_t, char8_t>,
+			&text_transcoder::transcode_impl<char16_t, char16_t>, &text_transcoder::transcode_impl<char16_t, char32_t> },
+		{ &text_transcoder::transcode_impl<char32_t, char>, &text_transcoder::transcode_impl<char32_t, char8_t>,
+			&text_transcoder::transcode_impl<char32_t, char16_t>, &text_transcoder::transcode_impl<char32_t, char32_t> }
+	};
+
+	m_transcode = functions[unit_index(in_read_encoding)][unit_index(in_write_encoding)];
+}
+
+text_transcoder::result_type text_transcoder::transcode(std::string_view in_data, char* out_buffer, size_t in_buffer_size) {
+	return (this->*m_transcode)(in_data, out_buffer, in_buffer_size, false);
+}
+
+text_transcoder::result_type text_transcoder::finish(char* out_buffer, size_t in_buffer_size) {
+	return (this->*m_transcode)({}, out_buffer, in_buffer_size, true);
+}
+
+void text_transcoder::reset() {
+	m_pending_size = 0;
+	m_read_state = {};
+	m_write_state = {};
+}
+
+size_t text_transcoder::pending() const {
+	return m_pending_size;
+}
+
+text_encoding text_transcoder::read_encoding() const {
+	return m_read_encoding;
+}
+
+text_encoding text_transcoder::write_encoding() const {
+	return m_write_encoding;
+}
+
+template<typename InCharT, typename OutCharT>
+text_transcoder::result_type text_transcoder::transcode_impl(std::string_view in_data, char* out_buffer, size_t in_buffer_size, bool in_finish) {
+	constexpr bool multibyte_read = std::is_same_v<InCharT, char>;
+	constexpr bool multibyte_write = std::is_same_v<OutCharT, char>;
+	size_t produced = 0;
+
+	auto read = [this](const char* in_begin, size_t in_size) {
+		if constexpr (multibyte_read) {
+			return read_codepoint_multibyte(in_begin, in_size, m_read_state);
+		}
+		else {
+			return read_codepoint<InCharT>(in_begin, in_size, m_read_swap);
+		}
+	};
+
+	auto write = [&](char32_t in_codepoint) {
+		if constexpr (multibyte_write) {
+			return write_codepoint_multibyte(in_codepoint, out_buffer + produced, in_buffer_size - produced, m_write_state);
+		}
+		else {
+			return write_codepoint<OutCharT>(in_codepoint, out_buffer + produced, in_buffer_size - produced, m_write_swap);
+		}
+	};
+
+	// Writes a replacement for invalid or unencodable input; returns bytes written, or 0 if there isn't room
+	auto write_replacement = [&]() {
+		size_t bytes_written = write(replacement_codepoint);
+		if (bytes_written == unencodable) {
+			bytes_written = write(U'?');
+		}
+		return bytes_written;
+	};
+
+	// Transcodes a single codepoint, one sequence at a time
+	auto step = [&](std::string_view in_string, size_t& inout_offset) {
+		std::mbstate_t read_state = m_read_state;
+		read_result decoded = read(in_string.data() + inout_offset, in_string.size() - inout_offset);
+		if (decoded.status == read_status::incomplete) {
+			return step_status::incomplete;
+		}
+
+		size_t bytes_written = decoded.status == read_status::ok ? write(decoded.codepoint) : unencodable;
+		if (bytes_written == unencodable) {
+			if (!m_replace_invalid) {
+				inout_offset += decoded.bytes;
+				return step_status::invalid;
+			}
+
+			bytes_written = write_replacement();
+		}
+
+		if (bytes_written == 0) {
+			m_read_state = read_state;
+			return step_status::output_full;
+		}
+
+		produced += bytes_written;
+		inout_offset += decoded.bytes;
+		return step_status::ok;
+	};
+
+	// Transcodes as many complete & valid sequences as fit, in bulk; returns false if it can't make progress
+	auto block = [&](std::string_view in_string, size_t& inout_offset) {
+		if constexpr (multibyte_read || multibyte_write) {
+			return false;
+		}
+		else {
+			constexpr size_t max_growth = transcode_max_length<OutCharT, InCharT>(1);
+			size_t count = std::min((in_string.size() - inout_offset) / sizeof(InCharT), block_units);
+			count = std::min(count, (in_buffer_size - produced) / sizeof(OutCharT) / max_growth);
+			if (count == 0) {
+				return false;
+			}
+
+			InCharT in_units[block_units];
+			load_units(in_string.data() + inout_offset, count, m_read_swap, in_units);
+			count = complete_length(in_units, count);
+			count = std::min(count, find_invalid(std::basic_string_view<InCharT>{ in_units, count }));
+			if (count == 0) {
+				return false;
+			}
+
+			OutCharT out_units[transcode_max_length<OutCharT, InCharT>(block_units)];
+			size_t units_written = jessilib::transcode(out_units, std::basic_string_view<InCharT>{ in_units, count });
+			store_units(out_units, units_written, m_write_swap, out_buffer + produced);
+			produced += units_written * sizeof(OutCharT);
+			inout_offset += count * sizeof(InCharT);
+			return true;
+		}
+	};
+
+	auto result_status = [](step_status in_status) {
+		return in_status == step_status::output_full ? status::output_full : status::invalid;
+	};
+
+	// Finish off any sequence held back from the last chunk, by transcoding it with the start of this one
+	size_t consumed = 0;
+	if (m_pending_size != 0) {
+		char buffer[sizeof(m_pending) * 2];
+		size_t pending_size = m_pending_size;
+		size_t taken = std::min(in_data.size(), sizeof(buffer) - pending_size);
+		std::memcpy(buffer, m_pending, pending_size);
+		std::memcpy(buffer + pending_size, in_data.data(), taken);
+		std::string_view string{ buffer, pending_size + taken };
+
+		// Holds back anything in buffer from in_offset which didn't come from in_data
+		auto hold_back = [&](size_t in_offset, size_t in_end) {
+			m_pending_size = in_offset < in_end ? in_end - in_offset : 0;
+			std::memmove(m_pending, buffer + in_offset, m_pending_size);
+			return in_offset > pending_size ? in_offset - pending_size : 0;
+		};
+
+		size_t offset = 0;
+		while (offset < pending_size) {
+			step_status step_result = step(string, offset);
+			if (step_result == step_status::ok) {
+				continue;
+			}
+
+			if (step_result == step_status::incomplete) {
+				// The sequence still isn't complete, so this chunk was too short to complete it
+				hold_back(offset, string.size());
+				consumed = in_data.size();
+				break;
+			}
+
+			return { result_status(step_result), hold_back(offset, pending_size), produced };
+		}
+
+		if (consumed != in_data.size()) {
+			consumed = hold_back(offset, pending_size);
+		}
+	}
+
+	while (consumed < in_data.size()) {
+		if constexpr (!multibyte_read && !multibyte_write) {
+			if (block(in_data, consumed)) {
+				continue;
+			}
+		}
+
+		step_status step_result = step(in_data, consumed);
+		if (step_result == step_status::ok) {
+			continue;
+		}
+
+		if (step_result == step_status::incomplete) {
+			// Hold back what's left until the next chunk; multibyte sequences are held in m_read_state instead
+			if constexpr (!multibyte_read) {
+				m_pending_size = in_data.size() - consumed;
+				std::memcpy(m_pending, in_data.data() + consumed, m_pending_size);
+			}
+			consumed = in_data.size();
+			break;
+		}
+
+		return { result_status(step_result), consumed, produced };
+	}
+
+	if (in_finish) {
+		// Anything still held back will never be completed
+		bool incomplete = m_pending_size != 0;
+		if constexpr (multibyte_read) {
+			incomplete = !std::mbsinit(&m_read_state);
+		}
+
+		if (incomplete && m_replace_invalid) {
+			size_t bytes_written = write_replacement();
+			if (bytes_written == 0) {
+				return { status::output_full, consumed, produced };
+			}
+			produced += bytes_written;
+			incomplete = false;
+		}
+
+		reset();
+		if (incomplete) {
+			return { status::invalid, consumed, produced };
+		}
+	}
+
+	return { status::complete, consumed, produced };
+}
+
+} // namespace jessilib
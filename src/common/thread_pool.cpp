@@ -56,14 +56,20 @@ thread_pool::thread_pool(size_t in_threads)
 						break;
 					}
 
-					// Push inactive thread
+					// Push inactive thread, unless a task was queued since pop_task(); tasks are only queued while no
+					// thread is inactive, so this check can't race with push()
 					{
 						std::lock_guard<std::mutex> inactive_threads_guard(m_inactive_threads_mutex);
-						m_inactive_threads.push(&worker);
+						worker.m_task = pop_task();
+						if (worker.m_task == nullptr) {
+							m_inactive_threads.push(&worker);
+						}
 					}
 
-					// Wait for notification
-					worker.m_notifier.wait(notifier_guard);
+					// Wait for a task to be handed over
+					worker.m_notifier.wait(notifier_guard, [&worker]() {
+						return worker.m_task != nullptr || worker.m_shutdown;
+					});
 				}
 
 				// Run task
@@ -78,16 +84,15 @@ thread_pool::~thread_pool() {
 }
 
 void thread_pool::push(task_t in_task) {
-	thread* target_thread = inactive_thread();
-
+	thread* target_thread = inactive_thread(in_task);
 	if (target_thread != nullptr) {
-		target_thread->m_task = in_task;
+		// Hand the task over while the thread holds its notifier mutex or waits on it, so that the notification is never missed
+		{
+			std::lock_guard<std::mutex> guard(target_thread->m_notifier_mutex);
+			target_thread->m_task = std::move(in_task);
+		}
 		target_thread->m_notifier.notify_one();
 	}
-	else {
-		std::lock_guard<std::mutex> guard(m_tasks_mutex);
-		m_tasks.push(in_task);
-	}
 }
 
 void thread_pool::join() {
@@ -129,7 +134,7 @@ size_t thread_pool::active() const {
 
 // thread_pool private functions
 
-thread_pool::thread* thread_pool::inactive_thread() {
+thread_pool::thread* thread_pool::inactive_thread(task_t& inout_task) {
 	std::lock_guard<std::mutex> guard(m_inactive_threads_mutex);
 
 	if (!m_inactive_threads.empty()) {
@@ -138,6 +143,9 @@ thread_pool::thread* thread_pool::inactive_thread() {
 		return result;
 	}
 
+	// No thread is inactive; queue the task for whichever thread finishes first
+	std::lock_guard<std::mutex> tasks_guard(m_tasks_mutex);
+	m_tasks.push(std::move(inout_task));
 	return nullptr;
 }
 
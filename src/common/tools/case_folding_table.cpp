@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * Build-time generator for the case folding lookup tables used by jessilib::fold()
+ *
+ * Usage: case_folding_table <CaseFolding.txt> <output header>
+ *
+ * Tables are three-level: the high bits of a codepoint select a (deduplicated) block, the low bits select an entry
+ * index within that block, and the entry holds the simple folding difference & any full folding.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t block_bits = 7;
+constexpr uint32_t block_size = 1 << block_bits;
+
+struct fold_entry {
+	int32_t simple_diff{};
+	std::vector<uint32_t> full; // Empty if full folding is the same as simple folding
+
+	auto operator<=>(const fold_entry&) const = default;
+};
+
+struct case_folding_data {
+	std::map<uint32_t, uint32_t> simple; // C + S
+	std::map<uint32_t, std::vector<uint32_t>> full; // F
+};
+
+bool read_case_folding(const char* in_filename, case_folding_data& out_data) {
+	std::ifstream file{ in_filename };
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		// Format: <code>; <status>; <mapping>; # <name>
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream{ line };
+		std::string code, status, mapping;
+		if (!std::getline(stream, code, ';')
+			|| !std::getline(stream, status, ';')
+			|| !std::getline(stream, mapping, ';')) {
+			continue;
+		}
+
+		uint32_t codepoint = std::stoul(code, nullptr, 16);
+		std::istringstream mapping_stream{ mapping };
+		std::vector<uint32_t> folded;
+		std::string folded_code;
+		while (mapping_stream >> folded_code) {
+			folded.push_back(std::stoul(folded_code, nullptr, 16));
+		}
+
+		if (status.find('C') != std::string::npos
+			|| status.find('S') != std::string::npos) {
+			out_data.simple[codepoint] = folded.at(0);
+		}
+		else if (status.find('F') != std::string::npos) {
+			out_data.full[codepoint] = folded;
+		}
+		// T (Turkic) mappings are excluded, per CaseFolding.txt's recommendation
+	}
+
+	return !out_data.simple.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <CaseFolding.txt> <output header>" << std::endl;
+		return 1;
+	}
+
+	case_folding_data data;
+	if (!read_case_folding(argv[1], data)) {
+		std::cerr << "Failed to read case folding data from " << argv[1] << std::endl;
+		return 1;
+	}
+
+	// Everything past the last folded codepoint's block folds to itself
+	uint32_t table_end = std::max(data.simple.rbegin()->first, data.full.empty() ? 0 : data.full.rbegin()->first);
+	table_end = (table_end | (block_size - 1)) + 1;
+
+	// Build deduplicated entries, full folding data, and blocks
+	std::vector<fold_entry> entries{ fold_entry{} }; // entries[0] is the identity
+	std::map<fold_entry, size_t> entry_indexes{ { fold_entry{}, 0 } };
+	std::vector<std::vector<uint32_t>> blocks;
+	std::map<std::vector<uint32_t>, size_t> block_indexes;
+	std::vector<size_t> block_table;
+	for (uint32_t block_start = 0; block_start != table_end; block_start += block_size) {
+		std::vector<uint32_t> block;
+		for (uint32_t codepoint = block_start; codepoint != block_start + block_size; ++codepoint) {
+			fold_entry entry;
+			if (auto itr = data.simple.find(codepoint); itr != data.simple.end()) {
+				entry.simple_diff = static_cast<int32_t>(itr->second) - static_cast<int32_t>(codepoint);
+			}
+			if (auto itr = data.full.find(codepoint); itr != data.full.end()) {
+				entry.full = itr->second;
+			}
+
+			auto entry_itr = entry_indexes.try_emplace(entry, entries.size()).first;
+			if (entry_itr->second == entries.size()) {
+				entries.push_back(entry);
+			}
+			block.push_back(static_cast<uint32_t>(entry_itr->second));
+		}
+
+		auto block_itr = block_indexes.try_emplace(block, blocks.size()).first;
+		if (block_itr->second == blocks.size()) {
+			blocks.push_back(block);
+		}
+		block_table.push_back(block_itr->second);
+	}
+
+	if (blocks.size() > 0x100 || entries.size() > 0x10000) {
+		std::cerr << "Case folding tables exceed index type limits" << std::endl;
+		return 1;
+	}
+
+	const char* entry_index_type = entries.size() > 0x100 ? "uint16_t" : "uint8_t";
+
+	// Write it all out
+	std::ofstream out{ argv[2] };
+	out << "// Generated from " << argv[1] << " by case_folding_table; do not edit\n\n"
+		<< "#pragma once\n\n"
+		<< "#include <cstdint>\n\n"
+		<< "namespace jessilib {\n"
+		<< "namespace impl_unicode {\n\n"
+		<< "struct case_fold_entry {\n"
+		<< "\tint32_t simple_diff; // Simple case folding (C + S); codepoint + simple_diff\n"
+		<< "\tuint16_t full_offset; // Full case folding (C + F); index into case_fold_full\n"
+		<< "\tuint16_t full_length; // 0 if the same as simple case folding\n"
+		<< "};\n\n"
+		<< "constexpr uint32_t case_fold_block_bits = " << block_bits << ";\n"
+		<< "constexpr char32_t case_fold_table_end = 0x" << std::hex << std::uppercase << table_end << std::dec
+		<< "; // Codepoints past this fold to themselves\n\n";
+
+	out << "constexpr uint8_t case_fold_blocks[]{";
+	for (size_t index = 0; index != block_table.size(); ++index) {
+		out << (index % 32 == 0 ? "\n\t" : " ") << block_table[index] << ',';
+	}
+	out << "\n};\n\n";
+
+	out << "constexpr " << entry_index_type << " case_fold_indexes[]{";
+	for (size_t block = 0; block != blocks.size(); ++block) {
+		out << "\n\t// Block " << block;
+		for (size_t index = 0; index != block_size; ++index) {
+			out << (index % 32 == 0 ? "\n\t" : " ") << blocks[block][index] << ',';
+		}
+	}
+	out << "\n};\n\n";
+
+	std::vector<uint32_t> full_data;
+	out << "constexpr case_fold_entry case_fold_entries[]{\n";
+	for (auto& entry : entries) {
+		out << "\t{ " << entry.simple_diff << ", " << (entry.full.empty() ? 0 : full_data.size()) << ", " << entry.full.size() << " },\n";
+		full_data.insert(full_data.end(), entry.full.begin(), entry.full.end());
+	}
+	out << "};\n\n";
+
+	out << "constexpr char32_t case_fold_full[]{" << std::hex << std::uppercase;
+	for (size_t index = 0; index != full_data.size(); ++index) {
+		out << (index % 16 == 0 ? "\n\t" : " ") << "0x" << full_data[index] << ',';
+	}
+	out << std::dec << "\n};\n\n"
+		<< "} // namespace impl_unicode\n"
+		<< "} // namespace jessilib\n";
+
+	if (!out) {
+		std::cerr << "Failed to write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
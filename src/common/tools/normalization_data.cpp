@@ -0,0 +1,149 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * Extracts the normalization data needed by normalization_table from the Unicode Character Database. This isn't run as
+ * part of the build; run it against a new UCD version to regenerate data/NormalizationData.txt.
+ *
+ * Usage: normalization_data <UnicodeData.txt> <DerivedNormalizationProps.txt> <NormalizationData.txt>
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct unicode_data_line {
+	std::string code;
+	std::string combining_class;
+	std::string mapping;
+};
+
+bool read_unicode_data(const char* in_filename, std::vector<unicode_data_line>& out_lines) {
+	std::ifstream file{ in_filename };
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		// Format: <code>;<name>;<category>;<canonical combining class>;<bidi class>;<decomposition mapping>;...
+		std::vector<std::string> fields;
+		std::istringstream stream{ line };
+		std::string field;
+		while (fields.size() != 6 && std::getline(stream, field, ';')) {
+			fields.push_back(field);
+		}
+
+		if (fields.size() != 6) {
+			continue;
+		}
+
+		// Ranges (i.e: "<CJK Ideograph, First>") are all starters without decomposition mappings
+		if (fields[3] != "0" || !fields[5].empty()) {
+			out_lines.push_back({ fields[0], fields[3], fields[5] });
+		}
+	}
+
+	return !out_lines.empty();
+}
+
+bool read_composition_exclusions(const char* in_filename, std::string& out_version, std::set<uint32_t>& out_excluded) {
+	std::ifstream file{ in_filename };
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		// First line names the file, i.e: "# DerivedNormalizationProps-14.0.0.txt"
+		constexpr std::string_view file_prefix = "# DerivedNormalizationProps-";
+		if (out_version.empty() && line.starts_with(file_prefix)) {
+			out_version = line.substr(file_prefix.size(), line.find(".txt") - file_prefix.size());
+			continue;
+		}
+
+		// Format: <code>[..<code>] ; <property>[; <value>] # <comment>
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream{ line };
+		std::string codes, property;
+		if (!std::getline(stream, codes, ';')
+			|| !(stream >> property)
+			|| property != "Full_Composition_Exclusion") {
+			continue;
+		}
+
+		size_t range_separator = codes.find("..");
+		uint32_t first = std::stoul(codes, nullptr, 16);
+		uint32_t last = range_separator == std::string::npos ? first : std::stoul(codes.substr(range_separator + 2), nullptr, 16);
+		for (uint32_t codepoint = first; codepoint <= last; ++codepoint) {
+			out_excluded.insert(codepoint);
+		}
+	}
+
+	return !out_version.empty() && !out_excluded.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc != 4) {
+		std::cerr << "Usage: " << argv[0] << " <UnicodeData.txt> <DerivedNormalizationProps.txt> <NormalizationData.txt>" << std::endl;
+		return 1;
+	}
+
+	std::vector<unicode_data_line> lines;
+	if (!read_unicode_data(argv[1], lines)) {
+		std::cerr << "Failed to read unicode data from " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::string version;
+	std::set<uint32_t> excluded;
+	if (!read_composition_exclusions(argv[2], version, excluded)) {
+		std::cerr << "Failed to read derived normalization properties from " << argv[2] << std::endl;
+		return 1;
+	}
+
+	std::ofstream out{ argv[3] };
+	out << "# Normalization data for Unicode " << version << "\n"
+		<< "#\n"
+		<< "# Extracted from UnicodeData-" << version << ".txt (fields 0, 3 and 5) and DerivedNormalizationProps-" << version << ".txt\n"
+		<< "# (Full_Composition_Exclusion) by normalization_data (src/common/tools/normalization_data.cpp); do not edit. Only\n"
+		<< "# codepoints with a non-zero canonical combining class or a decomposition mapping are listed. Hangul syllables are\n"
+		<< "# decomposed algorithmically, and are omitted.\n"
+		<< "#\n"
+		<< "# Format: <code>;<canonical combining class>;<decomposition mapping>;<X if Full_Composition_Exclusion>\n";
+	for (auto& line : lines) {
+		out << line.code << ';' << line.combining_class << ';' << line.mapping << ';'
+			<< (excluded.count(std::stoul(line.code, nullptr, 16)) != 0 ? "X" : "") << '\n';
+	}
+
+	if (!out) {
+		std::cerr << "Failed to write " << argv[3] << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,335 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * Build-time generator for the normalization lookup tables used by jessilib::normalize()
+ *
+ * Usage: normalization_table <NormalizationData.txt> <output header>
+ *
+ * Per-codepoint tables are three-level, the same as the case folding tables: the high bits of a codepoint select a
+ * (deduplicated) block, the low bits select an entry index within that block, and the entry holds the combining class,
+ * quick check properties, and full (recursively expanded) decompositions. Canonical compositions are emitted as a
+ * sorted array of pairs.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t block_bits = 7;
+constexpr uint32_t block_size = 1 << block_bits;
+
+// Hangul syllables & jamo, which are decomposed & composed algorithmically
+constexpr uint32_t hangul_s_base = 0xAC00;
+constexpr uint32_t hangul_s_count = 11172;
+constexpr uint32_t hangul_v_base = 0x1161;
+constexpr uint32_t hangul_v_count = 21;
+constexpr uint32_t hangul_t_base = 0x11A7;
+constexpr uint32_t hangul_t_count = 28;
+
+// Quick check values; 2 bits per normalization form, in the order of jessilib::normalization_form (NFC, NFD, NFKC, NFKD)
+constexpr uint8_t quick_check_no = 1;
+constexpr uint8_t quick_check_maybe = 2;
+enum form : uint32_t { nfc, nfd, nfkc, nfkd };
+
+struct codepoint_data {
+	uint32_t combining_class{};
+	std::vector<uint32_t> decomposition; // Single level, as listed
+	bool compatibility{}; // Whether decomposition is a compatibility mapping
+	bool excluded{}; // Full_Composition_Exclusion
+};
+
+struct normalization_entry {
+	uint32_t combining_class{};
+	uint32_t quick_check{};
+	std::vector<uint32_t> canonical; // Full canonical decomposition; empty if none
+	std::vector<uint32_t> compatibility; // Full compatibility decomposition; empty if same as canonical
+
+	auto operator<=>(const normalization_entry&) const = default;
+};
+
+bool read_normalization_data(const char* in_filename, std::map<uint32_t, codepoint_data>& out_data) {
+	std::ifstream file{ in_filename };
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		// Format: <code>;<canonical combining class>;<decomposition mapping>;<X if Full_Composition_Exclusion>
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream{ line };
+		std::string code, combining_class, mapping, exclusion;
+		if (!std::getline(stream, code, ';')
+			|| !std::getline(stream, combining_class, ';')
+			|| !std::getline(stream, mapping, ';')) {
+			continue;
+		}
+		std::getline(stream, exclusion);
+
+		codepoint_data& data = out_data[std::stoul(code, nullptr, 16)];
+		data.combining_class = std::stoul(combining_class);
+		data.excluded = exclusion.find('X') != std::string::npos;
+
+		std::istringstream mapping_stream{ mapping };
+		std::string mapped_code;
+		while (mapping_stream >> mapped_code) {
+			if (mapped_code.front() == '<') {
+				// Compatibility formatting tag, i.e: <compat>
+				data.compatibility = true;
+				continue;
+			}
+
+			data.decomposition.push_back(std::stoul(mapped_code, nullptr, 16));
+		}
+	}
+
+	return !out_data.empty();
+}
+
+void decompose(const std::map<uint32_t, codepoint_data>& in_data, uint32_t in_codepoint, bool in_compatibility, std::vector<uint32_t>& out_decomposition) {
+	auto itr = in_data.find(in_codepoint);
+	if (itr == in_data.end()
+		|| itr->second.decomposition.empty()
+		|| (itr->second.compatibility && !in_compatibility)) {
+		out_decomposition.push_back(in_codepoint);
+		return;
+	}
+
+	for (uint32_t codepoint : itr->second.decomposition) {
+		decompose(in_data, codepoint, in_compatibility, out_decomposition);
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <NormalizationData.txt> <output header>" << std::endl;
+		return 1;
+	}
+
+	std::map<uint32_t, codepoint_data> data;
+	if (!read_normalization_data(argv[1], data)) {
+		std::cerr << "Failed to read normalization data from " << argv[1] << std::endl;
+		return 1;
+	}
+
+	// Primary composites; anything with a 2 codepoint canonical decomposition which isn't excluded
+	std::map<std::pair<uint32_t, uint32_t>, uint32_t> compositions;
+	std::set<uint32_t> composition_seconds;
+	for (auto& [codepoint, codepoint_info] : data) {
+		if (codepoint_info.decomposition.size() == 2
+			&& !codepoint_info.compatibility
+			&& !codepoint_info.excluded) {
+			compositions[{ codepoint_info.decomposition[0], codepoint_info.decomposition[1] }] = codepoint;
+			composition_seconds.insert(codepoint_info.decomposition[1]);
+		}
+	}
+
+	// Build each codepoint's entry
+	auto make_entry = [&](uint32_t in_codepoint) {
+		normalization_entry entry;
+		auto set_quick_check = [&entry](form in_form, uint8_t in_value) {
+			entry.quick_check |= in_value << (in_form * 2);
+		};
+
+		if (in_codepoint >= hangul_s_base && in_codepoint < hangul_s_base + hangul_s_count) {
+			set_quick_check(nfd, quick_check_no);
+			set_quick_check(nfkd, quick_check_no);
+			return entry;
+		}
+
+		if ((in_codepoint >= hangul_v_base && in_codepoint < hangul_v_base + hangul_v_count)
+			|| (in_codepoint > hangul_t_base && in_codepoint < hangul_t_base + hangul_t_count)) {
+			set_quick_check(nfc, quick_check_maybe);
+			set_quick_check(nfkc, quick_check_maybe);
+			return entry;
+		}
+
+		bool second = composition_seconds.count(in_codepoint) != 0;
+		auto itr = data.find(in_codepoint);
+		if (itr == data.end()) {
+			// Starter without decomposition; may still compose with a preceding starter
+			if (second) {
+				set_quick_check(nfc, quick_check_maybe);
+				set_quick_check(nfkc, quick_check_maybe);
+			}
+			return entry;
+		}
+
+		entry.combining_class = itr->second.combining_class;
+		std::vector<uint32_t> canonical, compatibility;
+		decompose(data, in_codepoint, false, canonical);
+		decompose(data, in_codepoint, true, compatibility);
+		if (canonical.size() != 1 || canonical[0] != in_codepoint) {
+			entry.canonical = canonical;
+			set_quick_check(nfd, quick_check_no);
+		}
+		if (compatibility != canonical) {
+			entry.compatibility = compatibility;
+		}
+		if (compatibility.size() != 1 || compatibility[0] != in_codepoint) {
+			set_quick_check(nfkd, quick_check_no);
+		}
+
+		if (itr->second.excluded) {
+			set_quick_check(nfc, quick_check_no);
+			set_quick_check(nfkc, quick_check_no);
+		}
+		else {
+			if (second) {
+				set_quick_check(nfc, quick_check_maybe);
+			}
+
+			if (!entry.compatibility.empty()) {
+				set_quick_check(nfkc, quick_check_no);
+			}
+			else if (second) {
+				set_quick_check(nfkc, quick_check_maybe);
+			}
+		}
+
+		return entry;
+	};
+
+	// Everything past the last listed codepoint's block is a starter with no decomposition
+	uint32_t table_end = std::max(data.rbegin()->first, hangul_s_base + hangul_s_count - 1);
+	table_end = (table_end | (block_size - 1)) + 1;
+
+	// Build deduplicated entries, decomposition data, and blocks
+	std::vector<normalization_entry> entries{ normalization_entry{} }; // entries[0] is a starter without decomposition
+	std::map<normalization_entry, size_t> entry_indexes{ { normalization_entry{}, 0 } };
+	std::vector<std::vector<uint32_t>> blocks;
+	std::map<std::vector<uint32_t>, size_t> block_indexes;
+	std::vector<size_t> block_table;
+	for (uint32_t block_start = 0; block_start != table_end; block_start += block_size) {
+		std::vector<uint32_t> block;
+		for (uint32_t codepoint = block_start; codepoint != block_start + block_size; ++codepoint) {
+			normalization_entry entry = make_entry(codepoint);
+			auto entry_itr = entry_indexes.try_emplace(entry, entries.size()).first;
+			if (entry_itr->second == entries.size()) {
+				entries.push_back(entry);
+			}
+			block.push_back(static_cast<uint32_t>(entry_itr->second));
+		}
+
+		auto block_itr = block_indexes.try_emplace(block, blocks.size()).first;
+		if (block_itr->second == blocks.size()) {
+			blocks.push_back(block);
+		}
+		block_table.push_back(block_itr->second);
+	}
+
+	std::vector<uint32_t> decompositions;
+	std::vector<std::pair<size_t, size_t>> canonical_offsets, compatibility_offsets;
+	size_t max_decomposition_length = 0;
+	for (auto& entry : entries) {
+		canonical_offsets.emplace_back(decompositions.size(), entry.canonical.size());
+		decompositions.insert(decompositions.end(), entry.canonical.begin(), entry.canonical.end());
+		compatibility_offsets.emplace_back(decompositions.size(), entry.compatibility.size());
+		decompositions.insert(decompositions.end(), entry.compatibility.begin(), entry.compatibility.end());
+		max_decomposition_length = std::max({ max_decomposition_length, entry.canonical.size(), entry.compatibility.size() });
+	}
+
+	if (blocks.size() > 0x10000 || entries.size() > 0x10000 || decompositions.size() > 0x10000 || max_decomposition_length > 0xFF) {
+		std::cerr << "Normalization tables exceed index type limits" << std::endl;
+		return 1;
+	}
+
+	const char* block_index_type = blocks.size() > 0x100 ? "uint16_t" : "uint8_t";
+	const char* entry_index_type = entries.size() > 0x100 ? "uint16_t" : "uint8_t";
+
+	// Write it all out
+	std::ofstream out{ argv[2] };
+	out << "// Generated from " << argv[1] << " by normalization_table; do not edit\n\n"
+		<< "#pragma once\n\n"
+		<< "#include <cstdint>\n\n"
+		<< "namespace jessilib {\n"
+		<< "namespace impl_unicode {\n\n"
+		<< "struct normalization_entry {\n"
+		<< "\tuint8_t combining_class; // Canonical combining class\n"
+		<< "\tuint8_t quick_check; // 2 bits per normalization_form; 0 = yes, 1 = no, 2 = maybe\n"
+		<< "\tuint8_t canonical_length; // Full canonical decomposition; 0 if none\n"
+		<< "\tuint8_t compatibility_length; // Full compatibility decomposition; 0 if same as canonical\n"
+		<< "\tuint16_t canonical_offset; // Index into normalization_decompositions\n"
+		<< "\tuint16_t compatibility_offset;\n"
+		<< "};\n\n"
+		<< "struct normalization_composition {\n"
+		<< "\tchar32_t first;\n"
+		<< "\tchar32_t second;\n"
+		<< "\tchar32_t composite;\n"
+		<< "};\n\n"
+		<< "constexpr uint32_t normalization_block_bits = " << block_bits << ";\n"
+		<< "constexpr char32_t normalization_table_end = 0x" << std::hex << std::uppercase << table_end << std::dec
+		<< "; // Codepoints past this are starters without decompositions\n"
+		<< "constexpr size_t normalization_max_decomposition_length = " << max_decomposition_length << ";\n\n";
+
+	out << "constexpr " << block_index_type << " normalization_blocks[]{";
+	for (size_t index = 0; index != block_table.size(); ++index) {
+		out << (index % 32 == 0 ? "\n\t" : " ") << block_table[index] << ',';
+	}
+	out << "\n};\n\n";
+
+	out << "constexpr " << entry_index_type << " normalization_indexes[]{";
+	for (size_t block = 0; block != blocks.size(); ++block) {
+		out << "\n\t// Block " << block;
+		for (size_t index = 0; index != block_size; ++index) {
+			out << (index % 32 == 0 ? "\n\t" : " ") << blocks[block][index] << ',';
+		}
+	}
+	out << "\n};\n\n";
+
+	out << "constexpr normalization_entry normalization_entries[]{\n";
+	for (size_t index = 0; index != entries.size(); ++index) {
+		out << "\t{ " << entries[index].combining_class << ", " << entries[index].quick_check
+			<< ", " << canonical_offsets[index].second << ", " << compatibility_offsets[index].second
+			<< ", " << canonical_offsets[index].first << ", " << compatibility_offsets[index].first << " },\n";
+	}
+	out << "};\n\n";
+
+	out << "constexpr char32_t normalization_decompositions[]{" << std::hex << std::uppercase;
+	for (size_t index = 0; index != decompositions.size(); ++index) {
+		out << (index % 16 == 0 ? "\n\t" : " ") << "0x" << decompositions[index] << ',';
+	}
+	out << std::dec << "\n};\n\n";
+
+	// Sorted by first, then second
+	out << "constexpr normalization_composition normalization_compositions[]{\n" << std::hex << std::uppercase;
+	for (auto& [pair, composite] : compositions) {
+		out << "\t{ 0x" << pair.first << ", 0x" << pair.second << ", 0x" << composite << " },\n";
+	}
+	out << std::dec << "};\n\n"
+		<< "} // namespace impl_unicode\n"
+		<< "} // namespace jessilib\n";
+
+	if (!out) {
+		std::cerr << "Failed to write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -16,7 +16,15 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
-#include "unicode_base.hpp"
+#include "unicode.hpp"
+#include <clocale>
+#include <string>
+#include "unicode_case_folding.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define JESSILIB_IMPL_UTF8_SSSE3
+#include <immintrin.h>
+#endif // x86 & GCC/Clang
 
 namespace jessilib {
 
@@ -47,256 +55,250 @@ std::wstring encode_codepoint_w(char32_t in_codepoint) {
 }
 
 /**
- * Codepoint folding (case-insensitive character comparisons)
+ * Multi-byte strings
  */
 
-// describes a range
-struct folding_set {
-	enum class mode_type {
-		constant,
-		alternating,
-		single
-	} mode = mode_type::single;
-
-	uint32_t range_start; // inclusive
-	uint32_t range_end; // inclusive
-	int64_t diff; // difference between two codepoints
-
-	uint32_t fold(uint32_t in_codepoint) const {
-		if (mode != mode_type::alternating // Constant & single types immediately apply diff and return
-			|| (in_codepoint % 2) == (range_start % 2)) { // Alternating type apply diff only if matches range type
-			return static_cast<uint32_t>(in_codepoint + diff);
+namespace {
+
+impl_unicode::multibyte_encoding probe_multibyte_encoding() {
+	// Every ASCII character must round trip through the locale as itself
+	for (char32_t codepoint = 0; codepoint != 0x80; ++codepoint) {
+		char unit = static_cast<char>(codepoint);
+		char32_t decoded{};
+		std::mbstate_t mbstate{};
+		if (std::mbrtoc32(&decoded, &unit, 1, &mbstate) > 1 || decoded != codepoint) {
+			return impl_unicode::multibyte_encoding::other;
+		}
+
+		char buffer[MB_LEN_MAX];
+		mbstate = {};
+		if (std::c32rtomb(buffer, codepoint, &mbstate) != 1 || buffer[0] != unit) {
+			return impl_unicode::multibyte_encoding::other;
 		}
+	}
+
+	// Any encoding which round trips a 4-byte UTF-8 sequence as such is UTF-8 (GB18030's 4-byte sequences differ)
+	constexpr std::string_view utf8_probe{ "\xF0\x9F\x98\x84" }; // U+1F604
+	constexpr char32_t probe_codepoint = 0x1F604;
+	char32_t decoded{};
+	std::mbstate_t mbstate{};
+	if (std::mbrtoc32(&decoded, utf8_probe.data(), utf8_probe.size(), &mbstate) != utf8_probe.size()
+		|| decoded != probe_codepoint) {
+		return impl_unicode::multibyte_encoding::ascii;
+	}
 
-		return in_codepoint;
+	char buffer[MB_LEN_MAX];
+	mbstate = {};
+	if (std::c32rtomb(buffer, probe_codepoint, &mbstate) != utf8_probe.size()
+		|| std::string_view{ buffer, utf8_probe.size() } != utf8_probe) {
+		return impl_unicode::multibyte_encoding::ascii;
 	}
-};
 
-bool operator<(const folding_set& in_lhs, const uint32_t in_rhs) {
-	return in_rhs > in_lhs.range_end;
+	return impl_unicode::multibyte_encoding::utf_8;
 }
 
-bool operator<(const uint32_t in_lhs, const folding_set& in_rhs) {
-	return in_lhs < in_rhs.range_start;
+} // namespace
+
+namespace impl_unicode {
+
+multibyte_encoding current_multibyte_encoding() {
+	thread_local bool s_probed = false;
+	thread_local std::string s_locale_name;
+	thread_local multibyte_encoding s_encoding = multibyte_encoding::other;
+
+	const char* locale_name = std::setlocale(LC_CTYPE, nullptr);
+	if (locale_name == nullptr) {
+		return multibyte_encoding::other;
+	}
+
+	if (!s_probed || s_locale_name != locale_name) {
+		s_locale_name = locale_name;
+		s_encoding = probe_multibyte_encoding();
+		s_probed = true;
+	}
+
+	return s_encoding;
 }
 
-char32_t fold(char32_t in_codepoint) {
-	// Break this up? The most common case is going to be points < 0x80, but even without breaking this up we'll only
-	// perform at most like 8+1 integer comparisons, which is hardly a major constraint
-	static constexpr folding_set s_folding_sets[]{
-		{ folding_set::mode_type::constant, 0x0041, 0x005A, 32 },
-		{ folding_set::mode_type::single, 0x00B5, 0x00B5, 775 },
-		{ folding_set::mode_type::constant, 0x00C0, 0x00D6, 32 },
-		{ folding_set::mode_type::constant, 0x00D8, 0x00DE, 32 },
-		{ folding_set::mode_type::alternating, 0x0100, 0x012E, 1 },
-		{ folding_set::mode_type::alternating, 0x0132, 0x0136, 1 },
-		{ folding_set::mode_type::alternating, 0x0139, 0x0147, 1 },
-		{ folding_set::mode_type::alternating, 0x014A, 0x0176, 1 },
-		{ folding_set::mode_type::single, 0x0178, 0x0178, -121 },
-		{ folding_set::mode_type::alternating, 0x0179, 0x017D, 1 },
-		{ folding_set::mode_type::single, 0x017F, 0x017F, -268 },
-		{ folding_set::mode_type::single, 0x0181, 0x0181, 210 },
-		{ folding_set::mode_type::alternating, 0x0182, 0x0184, 1 },
-		{ folding_set::mode_type::single, 0x0186, 0x0186, 206 },
-		{ folding_set::mode_type::single, 0x0187, 0x0187, 1 },
-		{ folding_set::mode_type::constant, 0x0189, 0x018A, 205 },
-		{ folding_set::mode_type::single, 0x018B, 0x018B, 1 },
-		{ folding_set::mode_type::single, 0x018E, 0x018E, 79 },
-		{ folding_set::mode_type::single, 0x018F, 0x018F, 202 },
-		{ folding_set::mode_type::single, 0x0190, 0x0190, 203 },
-		{ folding_set::mode_type::single, 0x0191, 0x0191, 1 },
-		{ folding_set::mode_type::single, 0x0193, 0x0193, 205 },
-		{ folding_set::mode_type::single, 0x0194, 0x0194, 207 },
-		{ folding_set::mode_type::single, 0x0196, 0x0196, 211 },
-		{ folding_set::mode_type::single, 0x0197, 0x0197, 209 },
-		{ folding_set::mode_type::single, 0x0198, 0x0198, 1 },
-		{ folding_set::mode_type::single, 0x019C, 0x019C, 211 },
-		{ folding_set::mode_type::single, 0x019D, 0x019D, 213 },
-		{ folding_set::mode_type::single, 0x019F, 0x019F, 214 },
-		{ folding_set::mode_type::alternating, 0x01A0, 0x01A4, 1 },
-		{ folding_set::mode_type::single, 0x01A6, 0x01A6, 218 },
-		{ folding_set::mode_type::single, 0x01A7, 0x01A7, 1 },
-		{ folding_set::mode_type::single, 0x01A9, 0x01A9, 218 },
-		{ folding_set::mode_type::single, 0x01AC, 0x01AC, 1 },
-		{ folding_set::mode_type::single, 0x01AE, 0x01AE, 218 },
-		{ folding_set::mode_type::single, 0x01AF, 0x01AF, 1 },
-		{ folding_set::mode_type::constant, 0x01B1, 0x01B2, 217 },
-		{ folding_set::mode_type::alternating, 0x01B3, 0x01B5, 1 },
-		{ folding_set::mode_type::single, 0x01B7, 0x01B7, 219 },
-		{ folding_set::mode_type::single, 0x01B8, 0x01B8, 1 },
-		{ folding_set::mode_type::single, 0x01BC, 0x01BC, 1 },
-		{ folding_set::mode_type::single, 0x01C4, 0x01C4, 2 },
-		{ folding_set::mode_type::single, 0x01C5, 0x01C5, 1 },
-		{ folding_set::mode_type::single, 0x01C7, 0x01C7, 2 },
-		{ folding_set::mode_type::single, 0x01C8, 0x01C8, 1 },
-		{ folding_set::mode_type::single, 0x01CA, 0x01CA, 2 },
-		{ folding_set::mode_type::alternating, 0x01CB, 0x01DB, 1 },
-		{ folding_set::mode_type::alternating, 0x01DE, 0x01EE, 1 },
-		{ folding_set::mode_type::single, 0x01F1, 0x01F1, 2 },
-		{ folding_set::mode_type::alternating, 0x01F2, 0x01F4, 1 },
-		{ folding_set::mode_type::single, 0x01F6, 0x01F6, -97 },
-		{ folding_set::mode_type::single, 0x01F7, 0x01F7, -56 },
-		{ folding_set::mode_type::alternating, 0x01F8, 0x021E, 1 },
-		{ folding_set::mode_type::single, 0x0220, 0x0220, -130 },
-		{ folding_set::mode_type::alternating, 0x0222, 0x0232, 1 },
-		{ folding_set::mode_type::single, 0x023A, 0x023A, 10795 },
-		{ folding_set::mode_type::single, 0x023B, 0x023B, 1 },
-		{ folding_set::mode_type::single, 0x023D, 0x023D, -163 },
-		{ folding_set::mode_type::single, 0x023E, 0x023E, 10792 },
-		{ folding_set::mode_type::single, 0x0241, 0x0241, 1 },
-		{ folding_set::mode_type::single, 0x0243, 0x0243, -195 },
-		{ folding_set::mode_type::single, 0x0244, 0x0244, 69 },
-		{ folding_set::mode_type::single, 0x0245, 0x0245, 71 },
-		{ folding_set::mode_type::alternating, 0x0246, 0x024E, 1 },
-		{ folding_set::mode_type::single, 0x0345, 0x0345, 116 },
-		{ folding_set::mode_type::alternating, 0x0370, 0x0372, 1 },
-		{ folding_set::mode_type::single, 0x0376, 0x0376, 1 },
-		{ folding_set::mode_type::single, 0x037F, 0x037F, 116 },
-		{ folding_set::mode_type::single, 0x0386, 0x0386, 38 },
-		{ folding_set::mode_type::constant, 0x0388, 0x038A, 37 },
-		{ folding_set::mode_type::single, 0x038C, 0x038C, 64 },
-		{ folding_set::mode_type::constant, 0x038E, 0x038F, 63 },
-		{ folding_set::mode_type::constant, 0x0391, 0x03A1, 32 },
-		{ folding_set::mode_type::constant, 0x03A3, 0x03AB, 32 },
-		{ folding_set::mode_type::single, 0x03C2, 0x03C2, 1 },
-		{ folding_set::mode_type::single, 0x03CF, 0x03CF, 8 },
-		{ folding_set::mode_type::single, 0x03D0, 0x03D0, -30 },
-		{ folding_set::mode_type::single, 0x03D1, 0x03D1, -25 },
-		{ folding_set::mode_type::single, 0x03D5, 0x03D5, -15 },
-		{ folding_set::mode_type::single, 0x03D6, 0x03D6, -22 },
-		{ folding_set::mode_type::alternating, 0x03D8, 0x03EE, 1 },
-		{ folding_set::mode_type::single, 0x03F0, 0x03F0, -54 },
-		{ folding_set::mode_type::single, 0x03F1, 0x03F1, -48 },
-		{ folding_set::mode_type::single, 0x03F4, 0x03F4, -60 },
-		{ folding_set::mode_type::single, 0x03F5, 0x03F5, -64 },
-		{ folding_set::mode_type::single, 0x03F7, 0x03F7, 1 },
-		{ folding_set::mode_type::single, 0x03F9, 0x03F9, -7 },
-		{ folding_set::mode_type::single, 0x03FA, 0x03FA, 1 },
-		{ folding_set::mode_type::constant, 0x03FD, 0x03FF, -130 },
-		{ folding_set::mode_type::constant, 0x0400, 0x040F, 80 },
-		{ folding_set::mode_type::constant, 0x0410, 0x042F, 32 },
-		{ folding_set::mode_type::alternating, 0x0460, 0x0480, 1 },
-		{ folding_set::mode_type::alternating, 0x048A, 0x04BE, 1 },
-		{ folding_set::mode_type::single, 0x04C0, 0x04C0, 15 },
-		{ folding_set::mode_type::alternating, 0x04C1, 0x04CD, 1 },
-		{ folding_set::mode_type::alternating, 0x04D0, 0x052E, 1 },
-		{ folding_set::mode_type::constant, 0x0531, 0x0556, 48 },
-		{ folding_set::mode_type::constant, 0x10A0, 0x10C5, 7264 },
-		{ folding_set::mode_type::single, 0x10C7, 0x10C7, 7264 },
-		{ folding_set::mode_type::single, 0x10CD, 0x10CD, 7264 },
-		{ folding_set::mode_type::constant, 0x13F8, 0x13FD, -8 },
-		{ folding_set::mode_type::single, 0x1C80, 0x1C80, -6222 },
-		{ folding_set::mode_type::single, 0x1C81, 0x1C81, -6221 },
-		{ folding_set::mode_type::single, 0x1C82, 0x1C82, -6212 },
-		{ folding_set::mode_type::constant, 0x1C83, 0x1C84, -6210 },
-		{ folding_set::mode_type::single, 0x1C85, 0x1C85, -6211 },
-		{ folding_set::mode_type::single, 0x1C86, 0x1C86, -6204 },
-		{ folding_set::mode_type::single, 0x1C87, 0x1C87, -6180 },
-		{ folding_set::mode_type::single, 0x1C88, 0x1C88, 35267 },
-		{ folding_set::mode_type::constant, 0x1C90, 0x1CBA, -3008 },
-		{ folding_set::mode_type::constant, 0x1CBD, 0x1CBF, -3008 },
-		{ folding_set::mode_type::alternating, 0x1E00, 0x1E94, 1 },
-		{ folding_set::mode_type::single, 0x1E9B, 0x1E9B, -58 },
-		{ folding_set::mode_type::single, 0x1E9E, 0x1E9E, -7615 },
-		{ folding_set::mode_type::alternating, 0x1EA0, 0x1EFE, 1 },
-		{ folding_set::mode_type::constant, 0x1F08, 0x1F0F, -8 },
-		{ folding_set::mode_type::constant, 0x1F18, 0x1F1D, -8 },
-		{ folding_set::mode_type::constant, 0x1F28, 0x1F2F, -8 },
-		{ folding_set::mode_type::constant, 0x1F38, 0x1F3F, -8 },
-		{ folding_set::mode_type::constant, 0x1F48, 0x1F4D, -8 },
-		{ folding_set::mode_type::alternating, 0x1F59, 0x1F5F, -8 },
-		{ folding_set::mode_type::constant, 0x1F68, 0x1F6F, -8 },
-		{ folding_set::mode_type::constant, 0x1F88, 0x1F8F, -8 },
-		{ folding_set::mode_type::constant, 0x1F98, 0x1F9F, -8 },
-		{ folding_set::mode_type::constant, 0x1FA8, 0x1FAF, -8 },
-		{ folding_set::mode_type::constant, 0x1FB8, 0x1FB9, -8 },
-		{ folding_set::mode_type::constant, 0x1FBA, 0x1FBB, -74 },
-		{ folding_set::mode_type::single, 0x1FBC, 0x1FBC, -9 },
-		{ folding_set::mode_type::single, 0x1FBE, 0x1FBE, -7173 },
-		{ folding_set::mode_type::constant, 0x1FC8, 0x1FCB, -86 },
-		{ folding_set::mode_type::single, 0x1FCC, 0x1FCC, -9 },
-		{ folding_set::mode_type::constant, 0x1FD8, 0x1FD9, -8 },
-		{ folding_set::mode_type::constant, 0x1FDA, 0x1FDB, -100 },
-		{ folding_set::mode_type::constant, 0x1FE8, 0x1FE9, -8 },
-		{ folding_set::mode_type::constant, 0x1FEA, 0x1FEB, -112 },
-		{ folding_set::mode_type::single, 0x1FEC, 0x1FEC, -7 },
-		{ folding_set::mode_type::constant, 0x1FF8, 0x1FF9, -128 },
-		{ folding_set::mode_type::constant, 0x1FFA, 0x1FFB, -126 },
-		{ folding_set::mode_type::single, 0x1FFC, 0x1FFC, -9 },
-		{ folding_set::mode_type::single, 0x2126, 0x2126, -7517 },
-		{ folding_set::mode_type::single, 0x212A, 0x212A, -8383 },
-		{ folding_set::mode_type::single, 0x212B, 0x212B, -8262 },
-		{ folding_set::mode_type::single, 0x2132, 0x2132, 28 },
-		{ folding_set::mode_type::constant, 0x2160, 0x216F, 16 },
-		{ folding_set::mode_type::single, 0x2183, 0x2183, 1 },
-		{ folding_set::mode_type::constant, 0x24B6, 0x24CF, 26 },
-		{ folding_set::mode_type::constant, 0x2C00, 0x2C2F, 48 },
-		{ folding_set::mode_type::single, 0x2C60, 0x2C60, 1 },
-		{ folding_set::mode_type::single, 0x2C62, 0x2C62, -10743 },
-		{ folding_set::mode_type::single, 0x2C63, 0x2C63, -3814 },
-		{ folding_set::mode_type::single, 0x2C64, 0x2C64, -10727 },
-		{ folding_set::mode_type::alternating, 0x2C67, 0x2C6B, 1 },
-		{ folding_set::mode_type::single, 0x2C6D, 0x2C6D, -10780 },
-		{ folding_set::mode_type::single, 0x2C6E, 0x2C6E, -10749 },
-		{ folding_set::mode_type::single, 0x2C6F, 0x2C6F, -10783 },
-		{ folding_set::mode_type::single, 0x2C70, 0x2C70, -10782 },
-		{ folding_set::mode_type::single, 0x2C72, 0x2C72, 1 },
-		{ folding_set::mode_type::single, 0x2C75, 0x2C75, 1 },
-		{ folding_set::mode_type::constant, 0x2C7E, 0x2C7F, -10815 },
-		{ folding_set::mode_type::alternating, 0x2C80, 0x2CE2, 1 },
-		{ folding_set::mode_type::alternating, 0x2CEB, 0x2CED, 1 },
-		{ folding_set::mode_type::single, 0x2CF2, 0x2CF2, 1 },
-		{ folding_set::mode_type::alternating, 0xA640, 0xA66C, 1 },
-		{ folding_set::mode_type::alternating, 0xA680, 0xA69A, 1 },
-		{ folding_set::mode_type::alternating, 0xA722, 0xA72E, 1 },
-		{ folding_set::mode_type::alternating, 0xA732, 0xA76E, 1 },
-		{ folding_set::mode_type::alternating, 0xA779, 0xA77B, 1 },
-		{ folding_set::mode_type::single, 0xA77D, 0xA77D, -35332 },
-		{ folding_set::mode_type::alternating, 0xA77E, 0xA786, 1 },
-		{ folding_set::mode_type::single, 0xA78B, 0xA78B, 1 },
-		{ folding_set::mode_type::single, 0xA78D, 0xA78D, -42280 },
-		{ folding_set::mode_type::alternating, 0xA790, 0xA792, 1 },
-		{ folding_set::mode_type::alternating, 0xA796, 0xA7A8, 1 },
-		{ folding_set::mode_type::single, 0xA7AA, 0xA7AA, -42308 },
-		{ folding_set::mode_type::single, 0xA7AB, 0xA7AB, -42319 },
-		{ folding_set::mode_type::single, 0xA7AC, 0xA7AC, -42315 },
-		{ folding_set::mode_type::single, 0xA7AD, 0xA7AD, -42305 },
-		{ folding_set::mode_type::single, 0xA7AE, 0xA7AE, -42308 },
-		{ folding_set::mode_type::single, 0xA7B0, 0xA7B0, -42258 },
-		{ folding_set::mode_type::single, 0xA7B1, 0xA7B1, -42282 },
-		{ folding_set::mode_type::single, 0xA7B2, 0xA7B2, -42261 },
-		{ folding_set::mode_type::single, 0xA7B3, 0xA7B3, 928 },
-		{ folding_set::mode_type::alternating, 0xA7B4, 0xA7C2, 1 },
-		{ folding_set::mode_type::single, 0xA7C4, 0xA7C4, -48 },
-		{ folding_set::mode_type::single, 0xA7C5, 0xA7C5, -42307 },
-		{ folding_set::mode_type::single, 0xA7C6, 0xA7C6, -35384 },
-		{ folding_set::mode_type::alternating, 0xA7C7, 0xA7C9, 1 },
-		{ folding_set::mode_type::single, 0xA7D0, 0xA7D0, 1 },
-		{ folding_set::mode_type::alternating, 0xA7D6, 0xA7D8, 1 },
-		{ folding_set::mode_type::single, 0xA7F5, 0xA7F5, 1 },
-		{ folding_set::mode_type::constant, 0xAB70, 0xABBF, -38864 },
-		{ folding_set::mode_type::constant, 0xFF21, 0xFF3A, 32 },
-		{ folding_set::mode_type::constant, 0x10400, 0x10427, 40 },
-		{ folding_set::mode_type::constant, 0x104B0, 0x104D3, 40 },
-		{ folding_set::mode_type::constant, 0x10570, 0x1057A, 39 },
-		{ folding_set::mode_type::constant, 0x1057C, 0x1058A, 39 },
-		{ folding_set::mode_type::constant, 0x1058C, 0x10592, 39 },
-		{ folding_set::mode_type::constant, 0x10594, 0x10595, 39 },
-		{ folding_set::mode_type::constant, 0x10C80, 0x10CB2, 64 },
-		{ folding_set::mode_type::constant, 0x118A0, 0x118BF, 32 },
-		{ folding_set::mode_type::constant, 0x16E40, 0x16E5F, 32 },
-		{ folding_set::mode_type::constant, 0x1E900, 0x1E921, 34 },
-	};
-
-	const folding_set* folding_sets_end = std::end(s_folding_sets);
-	auto match = std::lower_bound(s_folding_sets, folding_sets_end, in_codepoint);
-	if (match == folding_sets_end
-		|| in_codepoint < *match) {
-		// in_codepoint doesn't fit into any set;
-		return in_codepoint;
+} // namespace impl_unicode
+
+/**
+ * Codepoint folding (case-insensitive character comparisons); tables are generated from CaseFolding.txt at build time
+ */
+
+namespace {
+
+const impl_unicode::case_fold_entry& find_case_fold_entry(char32_t in_codepoint) {
+	using namespace impl_unicode;
+	if (in_codepoint >= case_fold_table_end) {
+		return case_fold_entries[0]; // Identity
 	}
 
-	return match->fold(in_codepoint);
+	constexpr char32_t block_mask = (char32_t{1} << case_fold_block_bits) - 1;
+	size_t block = case_fold_blocks[in_codepoint >> case_fold_block_bits];
+	return case_fold_entries[case_fold_indexes[(block << case_fold_block_bits) | (in_codepoint & block_mask)]];
+}
+
+} // namespace
+
+namespace impl_unicode {
+
+char32_t fold_table(char32_t in_codepoint) {
+	return static_cast<char32_t>(in_codepoint + find_case_fold_entry(in_codepoint).simple_diff);
 }
 
+} // namespace impl_unicode
+
+size_t fold_full(char32_t in_codepoint, char32_t* out_codepoints) {
+	const impl_unicode::case_fold_entry& entry = find_case_fold_entry(in_codepoint);
+	if (entry.full_length == 0) {
+		*out_codepoints = static_cast<char32_t>(in_codepoint + entry.simple_diff);
+		return 1;
+	}
+
+	std::copy_n(impl_unicode::case_fold_full + entry.full_offset, entry.full_length, out_codepoints);
+	return entry.full_length;
+}
+
+/**
+ * UTF-8 validation
+ */
+
+namespace impl_unicode {
+
+#ifdef JESSILIB_IMPL_UTF8_SSSE3
+
+/**
+ * Validates 16 bytes at a time by classifying each pair of adjacent bytes with 3 nibble lookup tables, as described by
+ * Keiser & Lemire in "Validating UTF-8 In Less Than One Instruction Per Byte". Errors are only detected here; once one
+ * is found, find_invalid_utf8_scalar locates it.
+ */
+__attribute__((target("ssse3")))
+size_t find_invalid_utf8_ssse3(const char8_t* in_data, size_t in_length) {
+	// Error classes; each byte pair is an error iff the classes from all 3 tables share a bit
+	constexpr char too_short = 1 << 0; // 11______ 0_______ / 11______ 11______
+	constexpr char too_long = 1 << 1; // 0_______ 10______
+	constexpr char overlong_3 = 1 << 2; // 11100000 100_____
+	constexpr char too_large = 1 << 3; // 11110100 1001____ / 11110100 101_____ / 11110101+ 1001____+
+	constexpr char surrogate = 1 << 4; // 11101101 101_____
+	constexpr char overlong_2 = 1 << 5; // 1100000_ 10______
+	constexpr char too_large_1000 = 1 << 6; // 11110101+ 1000____
+	constexpr char overlong_4 = 1 << 6; // 11110000 1000____
+	constexpr char two_continuations = static_cast<char>(1 << 7); // 10______ 10______
+	constexpr char carry = too_short | too_long | two_continuations; // Errors which don't depend on byte 1's low nibble
+
+	const __m128i byte_1_high_table = _mm_setr_epi8(
+		// 0_______ (ASCII)
+		too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+		// 10______ (continuation)
+		two_continuations, two_continuations, two_continuations, two_continuations,
+		// 1100____ (2 byte lead)
+		too_short | overlong_2,
+		// 1101____ (2 byte lead)
+		too_short,
+		// 1110____ (3 byte lead)
+		too_short | overlong_3 | surrogate,
+		// 1111____ (4 byte lead)
+		too_short | too_large | too_large_1000 | overlong_4);
+
+	const __m128i byte_1_low_table = _mm_setr_epi8(
+		carry | overlong_3 | overlong_2 | overlong_4, // ____0000
+		carry | overlong_2, // ____0001
+		carry, carry, // ____001_
+		carry | too_large, // ____0100
+		carry | too_large | too_large_1000, // ____0101
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000, // ____011_
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000, // ____1___
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000 | surrogate, // ____1101
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000);
+
+	const __m128i byte_2_high_table = _mm_setr_epi8(
+		// 0_______ (ASCII)
+		too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+		// 1000____
+		too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+		// 1001____
+		too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+		// 101_____
+		too_long | overlong_2 | two_continuations | surrogate | too_large,
+		too_long | overlong_2 | two_continuations | surrogate | too_large,
+		// 11______ (lead)
+		too_short, too_short, too_short, too_short);
+
+	// Any of the last 3 bytes of a block starting a sequence which doesn't fit within it
+	const __m128i incomplete_max = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+	const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i prev_input = zero;
+	__m128i prev_incomplete = zero;
+	size_t offset = 0;
+	for (; in_length - offset >= 16; offset += 16) {
+		__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_data + offset));
+		__m128i error;
+		if (_mm_movemask_epi8(input) == 0) {
+			// All ASCII; the only possible error is a sequence left incomplete by the previous block
+			error = prev_incomplete;
+			prev_incomplete = zero;
+		}
+		else {
+			__m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+			__m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask));
+			__m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble_mask));
+			__m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+			__m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+			// 3rd & 4th bytes of sequences must be continuations; two_continuations is only an error elsewhere
+			__m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+			__m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+			__m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+			__m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+			__m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+
+			error = _mm_xor_si128(must_be_continuation, special_cases);
+			prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+		}
+
+		prev_input = input;
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF) {
+			// Error within this block, or in a sequence spanning into it
+			break;
+		}
+	}
+
+	// Check the remainder (and locate any error) from the start of the last sequence which may span into it
+	size_t start = offset;
+	for (size_t back = 1; back <= 3 && back <= offset; ++back) {
+		if ((in_data[offset - back] & 0xC0) != 0x80) {
+			start = offset - back;
+			break;
+		}
+	}
+
+	size_t result = find_invalid_utf8_scalar(std::u8string_view{ in_data + start, in_length - start });
+	if (result == std::u8string_view::npos) {
+		return result;
+	}
+
+	return start + result;
+}
+
+#endif // JESSILIB_IMPL_UTF8_SSSE3
+
+size_t find_invalid_utf8(const char8_t* in_data, size_t in_length) {
+#ifdef JESSILIB_IMPL_UTF8_SSSE3
+	static const bool s_has_ssse3 = __builtin_cpu_supports("ssse3");
+	if (s_has_ssse3) {
+		return find_invalid_utf8_ssse3(in_data, in_length);
+	}
+#endif // JESSILIB_IMPL_UTF8_SSSE3
+
+	return find_invalid_utf8_scalar(std::u8string_view{ in_data, in_length });
+}
+
+} // namespace impl_unicode
+
 } // namespace jessilib
@@ -0,0 +1,187 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "unicode_normalization.hpp"
+#include <algorithm>
+#include "unicode_normalization_tables.hpp"
+
+namespace jessilib {
+
+static_assert(impl_unicode::normalization_max_decomposition_length <= impl_unicode::max_decomposition_length);
+
+namespace {
+
+// Hangul syllables are decomposed & composed algorithmically, rather than through tables
+constexpr char32_t hangul_s_base = 0xAC00;
+constexpr char32_t hangul_l_base = 0x1100;
+constexpr char32_t hangul_v_base = 0x1161;
+constexpr char32_t hangul_t_base = 0x11A7;
+constexpr char32_t hangul_l_count = 19;
+constexpr char32_t hangul_v_count = 21;
+constexpr char32_t hangul_t_count = 28;
+constexpr char32_t hangul_n_count = hangul_v_count * hangul_t_count;
+constexpr char32_t hangul_s_count = hangul_l_count * hangul_n_count;
+
+constexpr char32_t first_mark = 0x300; // Everything before this is a starter which never composes with its predecessor
+
+const impl_unicode::normalization_entry& find_normalization_entry(char32_t in_codepoint) {
+	using namespace impl_unicode;
+	if (in_codepoint >= normalization_table_end) {
+		return normalization_entries[0]; // Starter without decomposition
+	}
+
+	constexpr char32_t block_mask = (char32_t{1} << normalization_block_bits) - 1;
+	size_t block = normalization_blocks[in_codepoint >> normalization_block_bits];
+	return normalization_entries[normalization_indexes[(block << normalization_block_bits) | (in_codepoint & block_mask)]];
+}
+
+// Returns the primary composite of in_first & in_second, or 0 if there is none
+char32_t compose(char32_t in_first, char32_t in_second) {
+	if (in_first - hangul_l_base < hangul_l_count
+		&& in_second - hangul_v_base < hangul_v_count) {
+		// L + V -> LV
+		return hangul_s_base + ((in_first - hangul_l_base) * hangul_v_count + (in_second - hangul_v_base)) * hangul_t_count;
+	}
+
+	if (in_first - hangul_s_base < hangul_s_count
+		&& (in_first - hangul_s_base) % hangul_t_count == 0
+		&& in_second - hangul_t_base - 1 < hangul_t_count - 1) {
+		// LV + T -> LVT
+		return in_first + (in_second - hangul_t_base);
+	}
+
+	using impl_unicode::normalization_compositions;
+	auto itr = std::lower_bound(std::begin(normalization_compositions), std::end(normalization_compositions), in_first,
+		[](const impl_unicode::normalization_composition& in_composition, char32_t in_first) {
+			return in_composition.first < in_first;
+		});
+
+	for (; itr != std::end(normalization_compositions) && itr->first == in_first; ++itr) {
+		if (itr->second == in_second) {
+			return itr->composite;
+		}
+	}
+
+	return 0;
+}
+
+} // namespace
+
+uint8_t combining_class(char32_t in_codepoint) {
+	return find_normalization_entry(in_codepoint).combining_class;
+}
+
+namespace impl_unicode {
+
+uint32_t normalization_properties(char32_t in_codepoint) {
+	const normalization_entry& entry = find_normalization_entry(in_codepoint);
+	return entry.combining_class | (static_cast<uint32_t>(entry.quick_check) << 8);
+}
+
+size_t decompose(char32_t in_codepoint, bool in_compatibility, char32_t* out_codepoints) {
+	if (in_codepoint - hangul_s_base < hangul_s_count) {
+		char32_t index = in_codepoint - hangul_s_base;
+		out_codepoints[0] = hangul_l_base + index / hangul_n_count;
+		out_codepoints[1] = hangul_v_base + (index % hangul_n_count) / hangul_t_count;
+		if (index % hangul_t_count == 0) {
+			return 2;
+		}
+
+		out_codepoints[2] = hangul_t_base + index % hangul_t_count;
+		return 3;
+	}
+
+	const normalization_entry& entry = find_normalization_entry(in_codepoint);
+	if (in_compatibility && entry.compatibility_length != 0) {
+		std::copy_n(normalization_decompositions + entry.compatibility_offset, entry.compatibility_length, out_codepoints);
+		return entry.compatibility_length;
+	}
+
+	if (entry.canonical_length != 0) {
+		std::copy_n(normalization_decompositions + entry.canonical_offset, entry.canonical_length, out_codepoints);
+		return entry.canonical_length;
+	}
+
+	*out_codepoints = in_codepoint;
+	return 1;
+}
+
+void reorder(std::u32string& inout_codepoints, bool in_compose) {
+	// Canonical ordering; stable insertion sort of each run of non-starters by combining class (runs are short)
+	for (size_t index = 1; index < inout_codepoints.size(); ++index) {
+		char32_t codepoint = inout_codepoints[index];
+		if (codepoint < first_mark) {
+			continue;
+		}
+
+		uint8_t combining = combining_class(codepoint);
+		if (combining == 0) {
+			continue;
+		}
+
+		size_t position = index;
+		while (position != 0) {
+			uint8_t previous = combining_class(inout_codepoints[position - 1]);
+			if (previous <= combining) {
+				break;
+			}
+
+			inout_codepoints[position] = inout_codepoints[position - 1];
+			--position;
+		}
+		inout_codepoints[position] = codepoint;
+	}
+
+	if (!in_compose || inout_codepoints.empty()) {
+		return;
+	}
+
+	// Canonical composition; each codepoint composes with the last starter, unless it's blocked from it
+	size_t starter_index = 0;
+	uint32_t last_combining_class = combining_class(inout_codepoints[0]) == 0 ? 0 : 256; // 256: nothing to compose with
+	size_t write_index = 1;
+	for (size_t read_index = 1; read_index != inout_codepoints.size(); ++read_index) {
+		char32_t codepoint = inout_codepoints[read_index];
+		uint32_t combining = 0;
+		if (codepoint >= first_mark) {
+			// Only codepoints which quick check as maybe are ever the second half of a composition
+			uint32_t properties = normalization_properties(codepoint);
+			combining = properties & 0xFF;
+			bool unblocked = last_combining_class < combining
+				|| (last_combining_class == 0 && write_index == starter_index + 1);
+			if (unblocked && quick_check_value(properties, normalization_form::nfc) == quick_check_result::maybe) {
+				char32_t composite = compose(inout_codepoints[starter_index], codepoint);
+				if (composite != 0) {
+					inout_codepoints[starter_index] = composite;
+					continue;
+				}
+			}
+		}
+
+		if (combining == 0) {
+			starter_index = write_index;
+		}
+		last_combining_class = combining;
+		inout_codepoints[write_index++] = codepoint;
+	}
+
+	inout_codepoints.resize(write_index);
+}
+
+} // namespace impl_unicode
+} // namespace jessilib
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace jessilib {
+
+/**
+ * Incremental multipart/form-data (RFC 7578) parser, for bodies too large to buffer. The body is fed in chunks as it
+ * arrives; each part's headers & data are passed to callbacks as they're parsed. Data slices are views into the chunk
+ * passed to parse(), save for any bytes which were held back at the end of the previous chunk because they could have
+ * been the start of a boundary (at most boundary.size() + 3 bytes).
+ */
+class multipart_parser {
+public:
+	struct callbacks {
+		std::function<void()> on_part_begin;
+		std::function<void(std::string_view in_name, std::string_view in_value)> on_header;
+		std::function<void(std::string_view in_data)> on_data; // Called any number of times per part
+		std::function<void()> on_part_end;
+	};
+
+	static constexpr size_t max_headers_size = 16 * 1024; // Per part
+
+	/**
+	 * @param in_boundary Boundary from the Content-Type header, without the leading "--" (see content_type_boundary)
+	 * @param in_callbacks Callbacks to pass parsed data to; any of them may be empty
+	 * @throws std::invalid_argument if in_boundary is empty or longer than 70 characters
+	 */
+	multipart_parser(std::string_view in_boundary, callbacks in_callbacks);
+
+	/**
+	 * Parses a chunk of the body
+	 *
+	 * @param in_chunk Next chunk of the body
+	 * @return False if the body is malformed (in which case all further input is rejected), true otherwise
+	 */
+	bool parse(std::string_view in_chunk);
+
+	/** Whether the closing boundary has been parsed; anything after it is ignored */
+	bool complete() const;
+
+	/** Whether the body was malformed */
+	bool failed() const;
+
+	/** Discards all state, to begin parsing a new body with the same boundary */
+	void reset();
+
+	/**
+	 * Extracts the boundary parameter from a Content-Type header value
+	 *
+	 * @param in_content_type Content-Type header value (i.e: "multipart/form-data; boundary=abc")
+	 * @return Boundary parameter, without quotes, or an empty view if there is none
+	 */
+	static std::string_view content_type_boundary(std::string_view in_content_type);
+
+private:
+	enum class state {
+		preamble, // Skipping everything up to the first boundary
+		boundary_end, // Just after a boundary; either "--" or transport padding follows
+		boundary_close, // Read one '-' after a boundary
+		boundary_padding, // Skipping transport padding up to the end of the boundary line
+		boundary_line_feed, // Read the '\r' ending the boundary line
+		headers, // Reading header lines
+		data, // Reading part data, up to the next boundary
+		epilogue, // After the closing boundary
+		error
+	};
+
+	// Searches for m_delimiter, passing anything which can't be part of it to in_data_callback; returns true if found
+	template<typename CallbackT>
+	bool find_delimiter(std::string_view& inout_chunk, CallbackT&& in_data_callback);
+
+	bool parse_header_line();
+
+	callbacks m_callbacks;
+	std::string m_delimiter; // "\r\n--" + boundary
+	std::array<size_t, 256> m_skip_table{}; // Boyer-Moore-Horspool shifts for m_delimiter
+	state m_state{};
+	std::string m_lookbehind; // Held back prefix of m_delimiter from the end of the previous chunk
+	std::string m_header_line;
+	size_t m_headers_size{};
+};
+
+} // namespace jessilib
@@ -27,6 +27,8 @@
 
 #include "unicode_syntax.hpp"
 #include "unicode_sequence.hpp"
+#include <array>
+#include <iterator>
 #include "type_traits.hpp"
 
 namespace jessilib {
@@ -178,4 +180,440 @@ constexpr bool deserialize_html_form(ContainerT& out_container, std::basic_strin
 	return false;
 }
 
+/**
+ * Read-only HTML form parser; rather than decoding the whole form in place, fields which contain no escapes are
+ * returned as views into the form itself, and only fields which do are decoded (into a caller-provided arena).
+ * Fields are parsed lazily as they're iterated, so callers can stop once they've found what they need:
+ *
+ *	std::u8string arena;
+ *	for (auto& field : html_form_view{ form, arena }) {
+ *		if (field.key == u8"id") { ... break; }
+ *	}
+ *
+ * Fields are split exactly as deserialize_html_form splits them. Unlike deserialize_html_form, UTF-8 is not validated.
+ */
+
+template<typename CharT>
+struct html_form_field {
+	std::basic_string_view<CharT> key;
+	std::basic_string_view<CharT> value;
+};
+
+/**
+ * Decodes a form key or value ('+' and "%XX" escapes)
+ *
+ * @param in_component Key or value to decode
+ * @param out_buffer Buffer to write to; must have room for in_component.size() units
+ * @return Pointer to the end of the decoded data within out_buffer, or nullptr if an escape is invalid
+ */
+template<typename CharT>
+CharT* decode_html_form_component(std::basic_string_view<CharT> in_component, CharT* out_buffer) {
+	const CharT* itr = in_component.data();
+	const CharT* end = itr + in_component.size();
+	while (true) {
+		const CharT* run_end = impl_unicode::find_any_unit<u8'%', u8'+'>(itr, end);
+		std::char_traits<CharT>::copy(out_buffer, itr, run_end - itr);
+		out_buffer += run_end - itr;
+		if (run_end == end) {
+			return out_buffer;
+		}
+
+		if (*run_end == '+') {
+			*out_buffer = static_cast<CharT>(' ');
+			++out_buffer;
+			itr = run_end + 1;
+			continue;
+		}
+
+		// Percent escapes are exactly 2 hex digits
+		if (end - run_end < 3) {
+			return nullptr;
+		}
+
+		int high = as_base(run_end[1], 16);
+		int low = as_base(run_end[2], 16);
+		if (high < 0 || low < 0) {
+			return nullptr;
+		}
+
+		*out_buffer = static_cast<CharT>((high << 4) | low);
+		++out_buffer;
+		itr = run_end + 3;
+	}
+}
+
+template<typename CharT>
+class html_form_view {
+public:
+	static_assert(sizeof(CharT) == 1, "Forms are parsed as UTF-8");
+
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = html_form_field<CharT>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type*;
+		using reference = const value_type&;
+
+		iterator() = default;
+
+		reference operator*() const { return m_field; }
+		pointer operator->() const { return &m_field; }
+
+		iterator& operator++() {
+			if (!m_view->next(m_field)) {
+				m_view = nullptr;
+			}
+
+			return *this;
+		}
+
+		iterator operator++(int) {
+			iterator result = *this;
+			++*this;
+			return result;
+		}
+
+		bool operator==(std::default_sentinel_t) const { return m_view == nullptr; }
+
+	private:
+		friend class html_form_view;
+		html_form_view* m_view{}; // nullptr once there are no more fields
+		value_type m_field;
+	};
+
+	/**
+	 * @param in_form Form to parse; must outlive the view & any fields returned by it
+	 * @param inout_arena Storage for decoded fields; it's resized to in_form.size() the first time a field needs
+	 *	decoding, and never resized again while iterating
+	 */
+	html_form_view(std::basic_string_view<CharT> in_form, std::basic_string<CharT>& inout_arena)
+		: m_form{ in_form },
+		m_arena{ inout_arena } {
+		// Empty ctor body
+	}
+
+	/** Begins parsing from the start of the form; fields from any previous iteration are invalidated */
+	iterator begin() {
+		m_read_head = m_form.data();
+		m_write_head = nullptr;
+		m_done = m_form.empty();
+		m_failed = false;
+
+		iterator result;
+		result.m_view = this;
+		++result;
+		return result;
+	}
+
+	std::default_sentinel_t end() const {
+		return {};
+	}
+
+	/** Whether iteration stopped early due to an invalid escape sequence */
+	bool failed() const {
+		return m_failed;
+	}
+
+private:
+	bool next(html_form_field<CharT>& out_field) {
+		if (m_done) {
+			return false;
+		}
+
+		// Key is everything up to the first '=' or '&'
+		const CharT* end = m_form.data() + m_form.size();
+		const CharT* key_start = m_read_head;
+		const CharT* itr = impl_unicode::find_any_unit<u8'&', u8'=', u8'%', u8'+'>(key_start, end);
+		bool key_escaped = false;
+		while (itr != end && (*itr == '%' || *itr == '+')) {
+			key_escaped = true;
+			itr = impl_unicode::find_any_unit<u8'&', u8'=', u8'%', u8'+'>(itr + 1, end);
+		}
+		const CharT* key_end = itr;
+
+		// Value is everything after that up to the next '&', if that was an '='
+		const CharT* value_start = itr;
+		bool value_escaped = false;
+		if (itr != end && *itr == '=') {
+			value_start = ++itr;
+			itr = impl_unicode::find_any_unit<u8'&', u8'%', u8'+'>(itr, end);
+			while (itr != end && *itr != '&') {
+				value_escaped = true;
+				itr = impl_unicode::find_any_unit<u8'&', u8'%', u8'+'>(itr + 1, end);
+			}
+		}
+		const CharT* value_end = itr;
+
+		if (itr == end) {
+			m_done = true;
+		}
+		else {
+			m_read_head = itr + 1;
+		}
+
+		if (!decode_field(out_field.key, key_start, key_end, key_escaped)
+			|| !decode_field(out_field.value, value_start, value_end, value_escaped)) {
+			m_done = true;
+			m_failed = true;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool decode_field(std::basic_string_view<CharT>& out_field, const CharT* in_begin, const CharT* in_end, bool in_escaped) {
+		if (!in_escaped) {
+			out_field = { in_begin, static_cast<size_t>(in_end - in_begin) };
+			return true;
+		}
+
+		if (m_write_head == nullptr) {
+			// Decoded data is never longer than the form itself, so this is the only allocation needed
+			if (m_arena.size() < m_form.size()) {
+				m_arena.resize(m_form.size());
+			}
+			m_write_head = m_arena.data();
+		}
+
+		CharT* decode_end = decode_html_form_component<CharT>({ in_begin, static_cast<size_t>(in_end - in_begin) }, m_write_head);
+		if (decode_end == nullptr) {
+			return false;
+		}
+
+		out_field = { m_write_head, static_cast<size_t>(decode_end - m_write_head) };
+		m_write_head = decode_end;
+		return true;
+	}
+
+	std::basic_string_view<CharT> m_form;
+	std::basic_string<CharT>& m_arena;
+	const CharT* m_read_head{};
+	CharT* m_write_head{}; // nullptr until the first decoded field
+	bool m_done{ true };
+	bool m_failed{};
+};
+
+template<typename CharT>
+html_form_view(std::basic_string_view<CharT>, std::basic_string<CharT>&) -> html_form_view<CharT>;
+
+template<typename CharT>
+html_form_view(const std::basic_string<CharT>&, std::basic_string<CharT>&) -> html_form_view<CharT>;
+
+/**
+ * Parses a form without modifying it; see html_form_view
+ *
+ * @param out_container Container to push key/value views to
+ * @param in_form Form to parse
+ * @param inout_arena Storage for decoded fields, which the pushed views may point into
+ * @return True if the form was parsed successfully, false if an escape sequence is invalid
+ */
+template<typename CharT, typename ContainerT,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+bool deserialize_html_form(ContainerT& out_container, std::basic_string_view<CharT> in_form, std::basic_string<CharT>& inout_arena) {
+	html_form_view<CharT> form{ in_form, inout_arena };
+	for (auto& field : form) {
+		jessilib::container::push(out_container, field.key, field.value);
+	}
+
+	return !form.failed();
+}
+
+/**
+ * Percent-encoding; the inverse of deserialize_http_query. Encoding is driven by a table of all 256 byte values, each
+ * of which maps to the unit it's written as, or 0 if it must be percent-encoded.
+ */
+
+using percent_encoding_table = std::array<char8_t, 256>;
+
+/**
+ * @param in_safe Units which are written as-is
+ * @param in_space_as_plus Whether spaces are written as '+', rather than "%20"
+ */
+constexpr percent_encoding_table make_percent_encoding_table(std::u8string_view in_safe, bool in_space_as_plus) {
+	percent_encoding_table result{};
+	for (char8_t unit : in_safe) {
+		result[unit] = unit;
+	}
+
+	if (in_space_as_plus) {
+		result[u8' '] = u8'+';
+	}
+
+	return result;
+}
+
+// Unreserved characters (RFC 3986); safe for any URL component
+inline constexpr percent_encoding_table url_component_encoding_table = make_percent_encoding_table(
+	u8"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~", false);
+
+// application/x-www-form-urlencoded
+inline constexpr percent_encoding_table html_form_encoding_table = make_percent_encoding_table(
+	u8"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789*-._", true);
+
+/**
+ * Calculates the length of a string after percent-encoding
+ *
+ * @param in_string String to encode
+ * @return Number of units in_string will be once encoded according to TableV
+ */
+template<typename CharT, const percent_encoding_table& TableV,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+constexpr size_t percent_encoded_length(std::basic_string_view<CharT> in_string) {
+	// Branchless; every unit is either 1 or 3 units long once encoded
+	size_t result = in_string.size();
+	for (CharT unit : in_string) {
+		result += static_cast<size_t>(TableV[static_cast<uint8_t>(unit)] == 0) * 2;
+	}
+
+	return result;
+}
+
+/**
+ * Percent-encodes a string into a buffer
+ *
+ * @param out_buffer Buffer to write to; must have room for percent_encoded_length(in_string) units
+ * @param in_string String to encode
+ * @return Pointer to the end of the encoded string within out_buffer
+ */
+template<typename CharT, const percent_encoding_table& TableV,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+constexpr CharT* write_percent_encoded(CharT* out_buffer, std::basic_string_view<CharT> in_string) {
+	constexpr char8_t hex_digits[]{ u8"0123456789ABCDEF" };
+	for (CharT unit : in_string) {
+		uint8_t byte = static_cast<uint8_t>(unit);
+		char8_t safe_unit = TableV[byte];
+		if (safe_unit != 0) {
+			*out_buffer = static_cast<CharT>(safe_unit);
+			++out_buffer;
+			continue;
+		}
+
+		out_buffer[0] = static_cast<CharT>('%');
+		out_buffer[1] = static_cast<CharT>(hex_digits[byte >> 4]);
+		out_buffer[2] = static_cast<CharT>(hex_digits[byte & 0xF]);
+		out_buffer += 3;
+	}
+
+	return out_buffer;
+}
+
+// Appends in_string to inout_string, percent-encoded according to TableV
+template<typename CharT, const percent_encoding_table& TableV,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+constexpr void append_percent_encoded(std::basic_string<CharT>& inout_string, std::basic_string_view<CharT> in_string) {
+	size_t offset = inout_string.size();
+	inout_string.resize(offset + percent_encoded_length<CharT, TableV>(in_string));
+	write_percent_encoded<CharT, TableV>(inout_string.data() + offset, in_string);
+}
+
+// Percent-encodes a URL component, such that deserialize_http_query will restore it
+template<typename CharT,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+constexpr std::basic_string<CharT> serialize_http_query(std::basic_string_view<CharT> in_string) {
+	std::basic_string<CharT> result;
+	append_percent_encoded<CharT, url_component_encoding_table>(result, in_string);
+	return result;
+}
+
+/**
+ * URL path escape sequence parser; as http_query_escapes_root_tree, but '+' is left as-is
+ */
+
+template<typename CharT,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+static constexpr shrink_sequence_tree<CharT> http_path_escapes_root_tree{
+	make_hex_sequence_pair<CharT, U'%', 2, true, false>()
+};
+
+template<typename CharT,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+constexpr bool deserialize_http_path(std::basic_string<CharT>& inout_string) {
+	return apply_shrink_sequence_tree<CharT, http_path_escapes_root_tree<CharT>, std::size(http_path_escapes_root_tree<CharT>)>(inout_string);
+}
+
+/**
+ * URL parser; splits a URL (or relative reference) into its components per RFC 3986, without decoding or copying
+ * anything. Components which are absent are null views, as opposed to components which are present but empty (i.e:
+ * "http://host/?" has an empty query, whereas "http://host/" has none). The path is always present.
+ *
+ * Paths are decoded with deserialize_http_path; queries are decoded with deserialize_http_query, or parsed as forms.
+ */
+
+template<typename CharT>
+struct url_view {
+	std::basic_string_view<CharT> scheme;
+	std::basic_string_view<CharT> authority;
+	std::basic_string_view<CharT> path;
+	std::basic_string_view<CharT> query;
+	std::basic_string_view<CharT> fragment;
+
+	bool has_scheme() const { return scheme.data() != nullptr; }
+	bool has_authority() const { return authority.data() != nullptr; }
+	bool has_query() const { return query.data() != nullptr; }
+	bool has_fragment() const { return fragment.data() != nullptr; }
+};
+
+/**
+ * Parses a URL
+ *
+ * @param out_url URL to write components to; components point into in_url
+ * @param in_url URL to parse
+ * @return True if in_url was parsed, false if its scheme is invalid
+ */
+template<typename CharT,
+	std::enable_if_t<sizeof(CharT) == 1>* = nullptr>
+bool parse_url(url_view<CharT>& out_url, std::basic_string_view<CharT> in_url) {
+	using impl_unicode::find_any_unit;
+	auto make_view = [](const CharT* in_begin, const CharT* in_end) {
+		return std::basic_string_view<CharT>{ in_begin, static_cast<size_t>(in_end - in_begin) };
+	};
+
+	out_url = {};
+	const CharT* itr = in_url.data();
+	const CharT* end = itr + in_url.size();
+
+	// Scheme; everything before the first ':', so long as it's before any '/', '?', or '#'
+	const CharT* scheme_end = find_any_unit<u8':', u8'/', u8'?', u8'#'>(itr, end);
+	if (scheme_end != end && scheme_end != itr && *scheme_end == ':') {
+		// ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
+		for (const CharT* scheme_itr = itr; scheme_itr != scheme_end; ++scheme_itr) {
+			CharT unit = *scheme_itr;
+			bool alpha = (unit >= 'A' && unit <= 'Z') || (unit >= 'a' && unit <= 'z');
+			if (!alpha && (scheme_itr == itr || !((unit >= '0' && unit <= '9') || unit == '+' || unit == '-' || unit == '.'))) {
+				return false;
+			}
+		}
+
+		out_url.scheme = make_view(itr, scheme_end);
+		itr = scheme_end + 1;
+	}
+
+	// Authority; everything between a leading "//" and the path
+	if (end - itr >= 2 && itr[0] == '/' && itr[1] == '/') {
+		itr += 2;
+		const CharT* authority_end = find_any_unit<u8'/', u8'?', u8'#'>(itr, end);
+		out_url.authority = make_view(itr, authority_end);
+		itr = authority_end;
+	}
+
+	const CharT* path_end = find_any_unit<u8'?', u8'#'>(itr, end);
+	out_url.path = make_view(itr, path_end);
+	itr = path_end;
+
+	if (itr != end && *itr == '?') {
+		++itr;
+		const CharT* query_end = find_any_unit<u8'#'>(itr, end);
+		out_url.query = make_view(itr, query_end);
+		itr = query_end;
+	}
+
+	if (itr != end) {
+		// '#'
+		out_url.fragment = make_view(itr + 1, end);
+	}
+
+	return true;
+}
+
 } // namespace jessilib
@@ -99,7 +99,7 @@ public:
 	// Standard constructors
 	object() = default;
 	object(const object& in_config);
-	object(object&& in_config);
+	object(object&& in_config) noexcept;
 	~object() = default;
 
 	// Value constructors
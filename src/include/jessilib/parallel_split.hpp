@@ -0,0 +1,246 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * @file parallel_split.hpp
+ * @author Jessica James
+ *
+ * Splitting of very large buffers across a thread_pool
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "split.hpp"
+#include "thread_pool.hpp"
+
+namespace jessilib {
+
+/** Inputs smaller than this per chunk aren't worth handing to another thread, unless a chunk count is specified */
+constexpr size_t parallel_split_min_chunk_size = 256 * 1024;
+
+namespace impl_split {
+
+// Whether a suffix of in_delim is also a prefix of it, in which case occurrences may overlap
+template<typename CharT>
+constexpr bool has_border(std::basic_string_view<CharT> in_delim) {
+	for (size_t length = 1; length < in_delim.size(); ++length) {
+		if (in_delim.substr(0, length) == in_delim.substr(in_delim.size() - length)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Divides in_string into up to in_chunk_count chunks of roughly equal size, each of which (besides the last) ends just
+ * past a delimiter. Occurrences of in_delimiter must not be able to overlap, so that any occurrence found from an
+ * arbitrary position is also one found by splitting from the start.
+ */
+template<typename CharT, typename DelimiterT>
+std::vector<std::basic_string_view<CharT>> make_split_chunks(std::basic_string_view<CharT> in_string,
+	const DelimiterT& in_delimiter, size_t in_delim_length, size_t in_chunk_count) {
+	std::vector<std::basic_string_view<CharT>> result;
+	const CharT* begin = in_string.data();
+	const CharT* end = begin + in_string.size();
+	size_t chunk_begin = 0;
+	for (size_t index = 1; index < in_chunk_count && chunk_begin != in_string.size(); ++index) {
+		// Start just early enough to find a delimiter which straddles the nominal chunk edge
+		size_t nominal_end = in_string.size() / in_chunk_count * index;
+		size_t search_begin = std::max(chunk_begin, nominal_end - std::min(nominal_end, in_delim_length - 1));
+		auto match = in_delimiter.find(begin + search_begin, end);
+		if (match.first == end) {
+			// No more delimiters; everything left is in the last chunk
+			break;
+		}
+
+		size_t chunk_end = static_cast<size_t>(match.second - begin);
+		result.push_back(in_string.substr(chunk_begin, chunk_end - chunk_begin));
+		chunk_begin = chunk_end;
+	}
+
+	result.push_back(in_string.substr(chunk_begin));
+	return result;
+}
+
+// Splits a chunk from make_split_chunks; all but the last chunk end in a delimiter, so their final (empty) token is dropped
+template<typename CharT, typename DelimiterT>
+void split_chunk(std::basic_string_view<CharT> in_chunk, bool in_last, const DelimiterT& in_delimiter,
+	std::vector<std::basic_string_view<CharT>>& out_tokens) {
+	using member_type = std::basic_string_view<CharT>;
+	if (in_chunk.empty()) {
+		// Only the last chunk can be empty, when the input ends with a delimiter
+		out_tokens.emplace_back();
+		return;
+	}
+
+	basic_split_range<member_type, const CharT*, DelimiterT> range{ in_chunk.data(), in_chunk.data() + in_chunk.size(), in_delimiter };
+	for (auto itr = range.begin(); itr != range.end();) {
+		member_type token = *itr;
+		++itr;
+		if (!in_last && itr == range.end()) {
+			break;
+		}
+
+		out_tokens.push_back(token);
+	}
+}
+
+/**
+ * Splits in_string in chunks across in_pool, passing each chunk's tokens to in_chunk_callback in order on the calling
+ * thread. The first chunk is split on the calling thread, while the pool works on the rest.
+ */
+template<typename CharT, typename DelimiterT, typename ChunkCallbackT>
+void parallel_split_chunks(thread_pool& in_pool, std::basic_string_view<CharT> in_string, const DelimiterT& in_delimiter,
+	size_t in_delim_length, size_t in_chunk_count, ChunkCallbackT&& in_chunk_callback) {
+	using tokens_type = std::vector<std::basic_string_view<CharT>>;
+	if (in_string.empty()) {
+		// Nothing to split
+		return;
+	}
+
+	if (in_chunk_count == 0) {
+		in_chunk_count = std::min<size_t>(in_pool.threads() + 1, in_string.size() / parallel_split_min_chunk_size);
+	}
+
+	if (in_pool.threads() == 0 || in_delim_length == 0) {
+		// Nothing to run chunks on, or nothing to align chunks to
+		in_chunk_count = 1;
+	}
+
+	std::vector<std::basic_string_view<CharT>> chunks = make_split_chunks(in_string, in_delimiter, in_delim_length, std::max<size_t>(in_chunk_count, 1));
+	std::vector<tokens_type> chunk_tokens(chunks.size());
+	std::vector<bool> chunk_done(chunks.size());
+	std::mutex done_mutex;
+	std::condition_variable done_notifier;
+
+	for (size_t index = 1; index < chunks.size(); ++index) {
+		in_pool.push([&, index]() {
+			split_chunk(chunks[index], index == chunks.size() - 1, in_delimiter, chunk_tokens[index]);
+
+			// Notify while holding the lock, so that nothing here is destroyed before notify_all() returns
+			std::lock_guard<std::mutex> guard(done_mutex);
+			chunk_done[index] = true;
+			done_notifier.notify_all();
+		});
+	}
+
+	auto wait_for = [&](size_t in_index) {
+		std::unique_lock<std::mutex> guard(done_mutex);
+		done_notifier.wait(guard, [&]() { return chunk_done[in_index]; });
+	};
+
+	size_t index = 0;
+	try {
+		split_chunk(chunks[0], chunks.size() == 1, in_delimiter, chunk_tokens[0]);
+		in_chunk_callback(chunk_tokens[0]);
+		for (index = 1; index < chunks.size(); ++index) {
+			wait_for(index);
+			in_chunk_callback(chunk_tokens[index]);
+			tokens_type{}.swap(chunk_tokens[index]); // Release each chunk's tokens once they're passed on
+		}
+	}
+	catch (...) {
+		// Tasks still reference this frame
+		for (index = std::max<size_t>(index, 1); index < chunks.size(); ++index) {
+			wait_for(index);
+		}
+		throw;
+	}
+}
+
+// Splits with a single element delimiter, or a sequence delimiter if in_delim is convertible to a basic_string_view
+template<typename CharT, typename DelimT, typename ChunkCallbackT>
+void parallel_split(thread_pool& in_pool, std::basic_string_view<CharT> in_string, const DelimT& in_delim, size_t in_chunk_count,
+	ChunkCallbackT&& in_chunk_callback) {
+	if constexpr (std::is_convertible_v<const DelimT&, std::basic_string_view<CharT>>) {
+		std::basic_string_view<CharT> delim = in_delim;
+
+		// Overlapping delimiters can't be found from an arbitrary position, so split them as a single chunk
+		size_t delim_length = has_border(delim) ? 0 : delim.size();
+		parallel_split_chunks(in_pool, in_string, sequence_delimiter<const CharT*>{ delim.data(), delim.data() + delim.size() },
+			delim_length, in_chunk_count, in_chunk_callback);
+	}
+	else {
+		parallel_split_chunks(in_pool, in_string, element_delimiter<CharT>{ static_cast<CharT>(in_delim) }, 1, in_chunk_count,
+			in_chunk_callback);
+	}
+}
+
+} // namespace impl_split
+
+/**
+ * Splits a very large string into views across a thread_pool. The input is divided into chunks, each of which is
+ * extended to end just past a delimiter, and the chunks are split concurrently. Must not be called from a task running
+ * on in_pool, as it waits for tasks it pushes to in_pool.
+ *
+ * Delimiters which can overlap themselves (i.e: "aba") are split as a single chunk, as chunk edges can't be aligned
+ * without splitting everything before them.
+ *
+ * @param in_pool Thread pool to split the chunks on
+ * @param in_string Contiguous string to split; must outlive the result
+ * @param in_delim Delimiter to split upon; a single element, or anything convertible to a basic_string_view
+ * @param in_chunks Number of chunks to divide in_string into; defaults to one per thread (including the calling thread),
+ *	for large enough inputs
+ * @return One container of views per chunk, in order; concatenated, they're equal to split_view(in_string, in_delim)
+ */
+template<typename InputT, typename DelimT>
+auto parallel_split(thread_pool& in_pool, const InputT& in_string, const DelimT& in_delim, size_t in_chunks = 0) {
+	using CharT = typename InputT::value_type;
+	using chunk_type = std::vector<std::basic_string_view<CharT>>;
+
+	std::vector<chunk_type> result;
+	impl_split::parallel_split(in_pool, std::basic_string_view<CharT>{ in_string.data(), in_string.size() }, in_delim, in_chunks,
+		[&result](chunk_type& in_tokens) {
+			result.push_back(std::move(in_tokens));
+		});
+
+	return result;
+}
+
+/**
+ * Splits a very large string across a thread_pool, as with parallel_split, passing each token to a callback in order.
+ * Tokens are passed on as soon as their chunk and every chunk before it are split.
+ *
+ * @param in_pool Thread pool to split the chunks on
+ * @param in_string Contiguous string to split
+ * @param in_delim Delimiter to split upon; a single element, or anything convertible to a basic_string_view
+ * @param in_callback Called on the calling thread with each token (as a basic_string_view), in order
+ * @param in_chunks Number of chunks to divide in_string into; defaults to one per thread (including the calling thread),
+ *	for large enough inputs
+ */
+template<typename InputT, typename DelimT, typename CallbackT>
+void parallel_split_for_each(thread_pool& in_pool, const InputT& in_string, const DelimT& in_delim, CallbackT&& in_callback,
+	size_t in_chunks = 0) {
+	using CharT = typename InputT::value_type;
+
+	impl_split::parallel_split(in_pool, std::basic_string_view<CharT>{ in_string.data(), in_string.size() }, in_delim, in_chunks,
+		[&in_callback](std::vector<std::basic_string_view<CharT>>& in_tokens) {
+			for (auto& token : in_tokens) {
+				in_callback(token);
+			}
+		});
+}
+
+} // namespace jessilib
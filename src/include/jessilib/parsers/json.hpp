@@ -18,15 +18,18 @@
 
 #pragma once
 
+#include <unordered_map>
 #include "fmt/xchar.h" // fmt::format
 #include "jessilib/parser.hpp"
 #include "jessilib/unicode.hpp" // join
 #include "jessilib/unicode_syntax.hpp" // syntax trees
-#include "jessilib/unicode_sequence.hpp" // apply_cpp_escape_sequences
+#include "jessilib/unicode_sequence.hpp" // apply_cpp_escape_sequences, json_escape_table
 #include "jessilib/util.hpp" // from_chars
 
 namespace jessilib {
 
+struct json_parse_result;
+
 class json_parser : public parser {
 public:
 	/** deserialize/serialize overrides */
@@ -38,6 +41,15 @@ public:
 	std::u32string serialize_u32(const object& in_object) override { return serialize_impl<char32_t>(in_object); }
 	std::wstring serialize_w(const object& in_object) override { return serialize_impl<wchar_t>(in_object); }
 
+	/**
+	 * Deserializes an object from a stream of bytes without throwing on malformed input
+	 * NOTE: For text_encoding::multibyte, the error offset is relative to the data once recoded to UTF-8
+	 *
+	 * @param in_data Data to deserialize object from
+	 * @return Parsed value on success, error & its position otherwise
+	 */
+	json_parse_result try_deserialize_bytes(bytes_view_type in_data, text_encoding in_read_encoding);
+
 	template<typename CharT, typename ResultCharT = CharT>
 	std::basic_string<ResultCharT> serialize_impl(const object& in_object) {
 		std::basic_string<ResultCharT> result;
@@ -55,7 +67,7 @@ public:
 
 // TODO: remove this
 template<typename CharT>
-void advance_whitespace(std::basic_string_view<CharT>& in_data) {
+constexpr void advance_whitespace(std::basic_string_view<CharT>& in_data) {
 	while (!in_data.empty()) {
 		switch (in_data.front()) {
 			case ' ':
@@ -133,39 +145,34 @@ constexpr syntax_tree_member<CharT, ContextT> make_noop_pair() {
 	} };
 }
 
-template<typename CharT, typename ContextT>
-size_t string_start_action(ContextT& inout_context, std::basic_string_view<CharT>& inout_read_view) {
-	// Safety check
-	if (inout_read_view.empty()) {
-		if constexpr (ContextT::use_exceptions) {
-			throw std::invalid_argument{ "Invalid JSON data; missing ending quote (\") when parsing string" };
+// Finds the terminating quote of a string (with the opening quote already removed); npos if there isn't one
+template<typename CharT>
+constexpr size_t json_string_end(std::basic_string_view<CharT> in_read_view) {
+	size_t end_pos = 0;
+	while ((end_pos = in_read_view.find('\"', end_pos)) != std::basic_string_view<CharT>::npos) {
+		// Quote found; check if it's escaped (i.e: preceded by an odd number of backslashes)
+		size_t backslashes = 0;
+		while (backslashes < end_pos && in_read_view[end_pos - backslashes - 1] == '\\') {
+			++backslashes;
 		}
 
-		return std::numeric_limits<size_t>::max();
-	}
-
-	// Check if this is just an empty string
-	if (inout_read_view.front() == '\"') {
-		inout_read_view.remove_prefix(1);
-		inout_context.out_object = std::u8string{};
-		return 1;
-	}
-
-	// Not an empty string; search for the ending quote
-	size_t search_start = 1;
-	size_t end_pos;
-	while ((end_pos = inout_read_view.find('\"', search_start)) != std::string_view::npos) {
-		// Quote found; check if it's escaped
-		if (inout_read_view[end_pos - 1] != '\\') {
+		if (backslashes % 2 == 0) {
 			// Unescaped quote; must be end of string
 			break;
 		}
 
-		search_start = end_pos + 1;
+		++end_pos;
 	}
 
+	return end_pos;
+}
+
+template<typename CharT, typename ContextT>
+size_t string_start_action(ContextT& inout_context, std::basic_string_view<CharT>& inout_read_view) {
+	size_t end_pos = json_string_end(inout_read_view);
+
 	// Early out if we didn't find the terminating quote
-	if (end_pos == std::string_view::npos) {
+	if (end_pos == std::basic_string_view<CharT>::npos) {
 		if constexpr (ContextT::use_exceptions) {
 			throw std::invalid_argument{ "Invalid JSON data; missing ending quote (\") when parsing string" };
 		}
@@ -173,11 +180,18 @@ size_t string_start_action(ContextT& inout_context, std::basic_string_view<CharT
 		return std::numeric_limits<size_t>::max();
 	}
 
+	// Check if this is just an empty string
+	if (end_pos == 0) {
+		inout_read_view.remove_prefix(1);
+		inout_context.out_object = std::u8string{};
+		return 1;
+	}
+
 	// jessilib::object only current accepts UTF-8 text; copy the necessary data instead of sequencing in-place
 	// additionally, even when it does accept other encodings, it'll be storing them as UTF-8 as well, though
 	// sequencing in-place and recoding the result would still likely be slightly quicker than recoding the input
 	std::u8string string_data = jessilib::string_cast<char8_t>(inout_read_view.substr(0, end_pos));
-	inout_read_view.remove_prefix(string_data.size() + 1); // Advance the read view to after the terminating quote
+	inout_read_view.remove_prefix(end_pos + 1); // Advance the read view to after the terminating quote
 	if (!jessilib::apply_cpp_escape_sequences(string_data)) {
 		if constexpr (ContextT::use_exceptions) {
 			using namespace std::literals;
@@ -329,15 +343,23 @@ size_t make_map_start_action(ContextT& inout_context, std::basic_string_view<Cha
 
 		// Verify next character is ':'
 		if (inout_read_view.empty()) {
-			throw std::invalid_argument{
-				"Invalid JSON data; unexpected end of data after parsing map key; expected ':' followed by value" };
+			if constexpr (ContextT::use_exceptions) {
+				throw std::invalid_argument{
+					"Invalid JSON data; unexpected end of data after parsing map key; expected ':' followed by value" };
+			}
+
+			return std::numeric_limits<size_t>::max();
 		}
 		front = inout_read_view.front();
 		if (front != ':') {
-			throw std::invalid_argument{
-				jessilib::join_mbstring(u8"Invalid JSON data; unexpected token: '"sv,
-				decode_codepoint(inout_read_view).codepoint,
-				u8"' when parsing map key (expected ':' instead)"sv) };
+			if constexpr (ContextT::use_exceptions) {
+				throw std::invalid_argument{
+					jessilib::join_mbstring(u8"Invalid JSON data; unexpected token: '"sv,
+					decode_codepoint(inout_read_view).codepoint,
+					u8"' when parsing map key (expected ':' instead)"sv) };
+			}
+
+			return std::numeric_limits<size_t>::max();
 		}
 		inout_read_view.remove_prefix(1); // strip ':'
 
@@ -351,8 +373,12 @@ size_t make_map_start_action(ContextT& inout_context, std::basic_string_view<Cha
 		advance_whitespace(inout_read_view);
 
 		if (inout_read_view.empty()) {
-			throw std::invalid_argument{
-				"Invalid JSON data; unexpected end of data after parsing map value; expected '}'" };
+			if constexpr (ContextT::use_exceptions) {
+				throw std::invalid_argument{
+					"Invalid JSON data; unexpected end of data after parsing map value; expected '}'" };
+			}
+
+			return std::numeric_limits<size_t>::max();
 		}
 
 		if (inout_read_view.front() == ',') {
@@ -382,7 +408,7 @@ constexpr syntax_tree_member<CharT, ContextT> make_number_pair() {
 		intmax_t integer_value{};
 		const CharT* from_chars_end = from_chars(number_begin, inout_read_view.data() + inout_read_view.size(), integer_value).ptr;
 		if constexpr (InCodepointV == '-') {
-			if (inout_read_view.data() == from_chars_end) {
+			if (from_chars_end == number_begin) {
 				// Failed to parse integer portion
 				if constexpr (ContextT::use_exceptions) {
 					using namespace std::literals;
@@ -467,9 +493,580 @@ bool deserialize_json(object& out_object, std::basic_string_view<CharT>& inout_r
 		(context, inout_read_view);
 }
 
+/**
+ * Iterative JSON parsing; arrays & maps are tracked on an explicit stack rather than recursing into
+ * array_start_action / make_map_start_action, so nesting depth is bounded by max_depth instead of the call stack
+ */
+
+static constexpr size_t json_default_max_depth = 512;
+
+struct json_parse_frame {
+	object* container; // array or map currently being populated
+	bool is_map;
+};
+
+/**
+ * Pool of decoded map keys, indexed by their raw (encoded & escaped) data. Keys tend to repeat throughout a document
+ * (i.e: arrays of records), so each distinct key is only decoded once. Not thread-safe.
+ * NOTE: object::map_type owns its keys, so keys are still copied into each map
+ */
+class json_key_pool {
+public:
+	static constexpr size_t default_max_keys = 1024;
+
+	explicit json_key_pool(size_t in_max_keys = default_max_keys)
+		: m_max_keys{ in_max_keys } {
+		// Empty ctor body
+	}
+
+	/**
+	 * Looks up a previously interned key
+	 *
+	 * @param in_raw_key Key data between the quotes, prior to decoding
+	 * @return Decoded key if present, nullptr otherwise
+	 */
+	template<typename CharT>
+	const object::string_type* find(std::basic_string_view<CharT> in_raw_key) const {
+		if (m_unit_size != sizeof(CharT)) {
+			return nullptr;
+		}
+
+		auto itr = m_keys.find(raw_bytes(in_raw_key));
+		if (itr == m_keys.end()) {
+			return nullptr;
+		}
+
+		return &itr->second;
+	}
+
+	/**
+	 * Interns a decoded key; once the pool is full, keys are no longer retained
+	 *
+	 * @param in_raw_key Key data between the quotes, prior to decoding
+	 * @param in_key Decoded key
+	 * @return Decoded key; valid until the next call to insert() or clear()
+	 */
+	template<typename CharT>
+	const object::string_type& insert(std::basic_string_view<CharT> in_raw_key, object::string_type&& in_key) {
+		if (m_unit_size != sizeof(CharT)) {
+			// Raw keys from different encodings can't be compared
+			clear();
+			m_unit_size = sizeof(CharT);
+		}
+
+		if (m_keys.size() >= m_max_keys) {
+			m_overflow = std::move(in_key);
+			return m_overflow;
+		}
+
+		return m_keys.emplace(raw_bytes(in_raw_key), std::move(in_key)).first->second;
+	}
+
+	size_t size() const { return m_keys.size(); }
+
+	void clear() {
+		m_keys.clear();
+		m_unit_size = 0;
+	}
+
+private:
+	template<typename CharT>
+	static std::string_view raw_bytes(std::basic_string_view<CharT> in_raw_key) {
+		return { reinterpret_cast<const char*>(in_raw_key.data()), in_raw_key.size() * sizeof(CharT) };
+	}
+
+	struct raw_hash {
+		using is_transparent = void;
+		size_t operator()(std::string_view in_raw_key) const { return std::hash<std::string_view>{}(in_raw_key); }
+	};
+
+	std::unordered_map<std::string, object::string_type, raw_hash, std::equal_to<>> m_keys;
+	object::string_type m_overflow; // Holds the most recent key once m_keys is full
+	size_t m_max_keys;
+	size_t m_unit_size{}; // sizeof(CharT) for the keys in m_keys
+};
+
+// Scratch state for deserialize_json_iterative; keys are interned for as long as the state is reused
+struct json_parse_state {
+	std::vector<json_parse_frame> stack;
+	json_key_pool keys;
+};
+
+enum class json_error {
+	none = 0,
+	unexpected_end, // Data ended before the value was complete
+	unexpected_token, // Data which can't start a value, a missing ',' / ':' / closing bracket, or data after the value
+	invalid_string, // Unterminated string, or string containing an invalid escape sequence
+	invalid_number,
+	invalid_literal, // Anything starting with 't', 'f', or 'n' which isn't true, false, or null
+	max_depth_exceeded,
+	schema_violation // Rejected by validator
+};
+
+/**
+ * Validation hooks for deserialize_json_iterative; validators are notified as values are parsed, and may fail the parse
+ * early by returning false. Disabled validators cost nothing. See json_schema_validator for an implementation.
+ *
+ * void reset(); // Start of parse
+ * bool on_container_start(bool is_map);
+ * bool on_element(); // Array element follows
+ * bool on_key(std::u8string_view key); // Map value for key follows
+ * bool on_value(const object& value); // Scalar value parsed
+ * bool on_container_end(const object& container);
+ */
+struct json_null_validator {
+	static constexpr bool enabled = false;
+};
+
+template<bool UseExceptionsV>
+bool json_validator_failed(json_error& out_error) {
+	if constexpr (UseExceptionsV) {
+		throw std::invalid_argument{ "Invalid JSON data: value rejected by validator" };
+	}
+
+	out_error = json_error::schema_violation;
+	return false;
+}
+
+// Same as json_object_tree, minus whitespace & containers (which are handled by deserialize_json_iterative)
+template<typename CharT, bool UseExceptionsV>
+static constexpr syntax_tree<CharT, json_context<CharT, UseExceptionsV>> json_scalar_tree{
+	make_string_start_pair<CharT, json_context<CharT, UseExceptionsV>, U'\"'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'-'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'0'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'1'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'2'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'3'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'4'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'5'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'6'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'7'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'8'>(),
+	make_number_pair<CharT, json_context<CharT, UseExceptionsV>, U'9'>(),
+	make_keyword_value_pair<CharT, json_context<CharT, UseExceptionsV>, U'f', json_false_remainder, bool, false>(),
+	make_keyword_value_pair<CharT, json_context<CharT, UseExceptionsV>, U'n', json_null_remainder, std::nullptr_t, nullptr>(),
+	make_keyword_value_pair<CharT, json_context<CharT, UseExceptionsV>, U't', json_true_remainder, bool, true>()
+};
+
+// Determines the error to report when a scalar value starting with in_front fails to parse
+template<typename CharT>
+constexpr json_error json_scalar_error(CharT in_front) {
+	if (in_front == '\"') {
+		return json_error::invalid_string;
+	}
+
+	if (in_front == '-' || (in_front >= '0' && in_front <= '9')) {
+		return json_error::invalid_number;
+	}
+
+	if (in_front == 't' || in_front == 'f' || in_front == 'n') {
+		return json_error::invalid_literal;
+	}
+
+	return json_error::unexpected_token;
+}
+
+// Reads a map key (with the opening quote already removed), checking inout_keys before decoding it; nullptr on failure
+template<typename CharT, bool UseExceptionsV>
+const object::string_type* json_read_key(std::basic_string_view<CharT>& inout_read_view, json_key_pool& inout_keys) {
+	size_t end_pos = json_string_end(inout_read_view);
+	if (end_pos == std::basic_string_view<CharT>::npos) {
+		if constexpr (UseExceptionsV) {
+			throw std::invalid_argument{ "Invalid JSON data; missing ending quote (\") when parsing string" };
+		}
+
+		return nullptr;
+	}
+
+	std::basic_string_view<CharT> raw_key = inout_read_view.substr(0, end_pos);
+	inout_read_view.remove_prefix(end_pos + 1);
+	if (const object::string_type* key = inout_keys.find(raw_key)) {
+		return key;
+	}
+
+	std::u8string key = jessilib::string_cast<char8_t>(raw_key);
+	if (!jessilib::apply_cpp_escape_sequences(key)) {
+		if constexpr (UseExceptionsV) {
+			using namespace std::literals;
+			throw std::invalid_argument {
+				jessilib::join_mbstring(u8"Invalid JSON data; invalid token or end of string: "sv,
+					std::u8string_view{ key })
+			};
+		}
+
+		return nullptr;
+	}
+
+	return &inout_keys.insert(raw_key, std::move(key));
+}
+
+// Reads up to the start of the next element in a container, and returns the object to parse it into; nullptr on failure
+template<typename CharT, bool UseExceptionsV, typename ValidatorT>
+object* json_next_element(json_parse_frame& inout_frame, std::basic_string_view<CharT>& inout_read_view, json_key_pool& inout_keys,
+	json_error& out_error, ValidatorT& inout_validator) {
+	using namespace std::literals;
+	if (!inout_frame.is_map) {
+		if constexpr (ValidatorT::enabled) {
+			if (!inout_validator.on_element()) {
+				json_validator_failed<UseExceptionsV>(out_error);
+				return nullptr;
+			}
+		}
+
+		return &(*inout_frame.container)[inout_frame.container->size()];
+	}
+
+	// inout_read_view should now point to the start of a key
+	advance_whitespace(inout_read_view);
+	if (inout_read_view.empty() || inout_read_view.front() != '\"') {
+		if constexpr (UseExceptionsV) {
+			if (inout_read_view.empty()) {
+				throw std::invalid_argument{ "Invalid JSON data: unexpected end of data when parsing object map; expected '\"'" };
+			}
+
+			throw std::invalid_argument{
+				jessilib::join_mbstring(u8"Invalid JSON data; unexpected token: '"sv,
+				decode_codepoint(inout_read_view).codepoint,
+				u8"' when parsing object map (expected '\"' instead)"sv) };
+		}
+
+		out_error = inout_read_view.empty() ? json_error::unexpected_end : json_error::unexpected_token;
+		return nullptr;
+	}
+
+	// Read in key
+	std::basic_string_view<CharT> key_start = inout_read_view;
+	inout_read_view.remove_prefix(1); // front quote
+	const object::string_type* key = json_read_key<CharT, UseExceptionsV>(inout_read_view, inout_keys);
+	if (key == nullptr) {
+		// Any exception would've been thrown in json_read_key
+		inout_read_view = key_start;
+		out_error = json_error::invalid_string;
+		return nullptr;
+	}
+
+	if constexpr (ValidatorT::enabled) {
+		if (!inout_validator.on_key(*key)) {
+			inout_read_view = key_start;
+			json_validator_failed<UseExceptionsV>(out_error);
+			return nullptr;
+		}
+	}
+	advance_whitespace(inout_read_view);
+
+	// Verify next character is ':'
+	if (inout_read_view.empty() || inout_read_view.front() != ':') {
+		if constexpr (UseExceptionsV) {
+			if (inout_read_view.empty()) {
+				throw std::invalid_argument{
+					"Invalid JSON data; unexpected end of data after parsing map key; expected ':' followed by value" };
+			}
+
+			throw std::invalid_argument{
+				jessilib::join_mbstring(u8"Invalid JSON data; unexpected token: '"sv,
+				decode_codepoint(inout_read_view).codepoint,
+				u8"' when parsing map key (expected ':' instead)"sv) };
+		}
+
+		out_error = inout_read_view.empty() ? json_error::unexpected_end : json_error::unexpected_token;
+		return nullptr;
+	}
+	inout_read_view.remove_prefix(1); // strip ':'
+
+	return &(*inout_frame.container)[*key];
+}
+
+/**
+ * Deserializes a single JSON value without recursing
+ *
+ * @param out_object Object to deserialize into; only modified on success
+ * @param inout_read_view Data to parse; advanced past the parsed value on success, or to the offending data on failure
+ * @param inout_state Container stack & key pool; reuse between calls to avoid reallocating, and to share interned keys
+ * @param in_max_depth Maximum number of nested arrays/maps to accept before failing
+ * @param out_error Set to the reason for failure when returning false
+ * @param inout_validator Validator to notify as values are parsed (see json_null_validator)
+ * @return True on success, false otherwise
+ */
+template<typename CharT, bool UseExceptionsV = true, typename ValidatorT = json_null_validator>
+bool deserialize_json_iterative(object& out_object, std::basic_string_view<CharT>& inout_read_view,
+	json_parse_state& inout_state, size_t in_max_depth, json_error& out_error, ValidatorT& inout_validator) {
+	using namespace std::literals;
+	using context_type = json_context<CharT, UseExceptionsV>;
+	constexpr auto& scalar_tree = json_scalar_tree<CharT, UseExceptionsV>;
+	static_assert(is_sorted<CharT, context_type, scalar_tree, std::size(scalar_tree)>(), "Tree must be pre-sorted");
+
+	if (inout_read_view.empty()) {
+		// Empty json; false to indicate out_object not modified with any valid data, but no need to throw
+		out_error = json_error::unexpected_end;
+		return false;
+	}
+
+	advance_whitespace(inout_read_view);
+	if (inout_read_view.empty()) {
+		// Whitespace only; consistent with deserialize_json
+		return true;
+	}
+
+	inout_state.stack.clear();
+	inout_state.stack.reserve(std::min(in_max_depth, json_default_max_depth));
+	if constexpr (ValidatorT::enabled) {
+		inout_validator.reset();
+	}
+
+	object result;
+	object* target = &result; // Object which the next value is parsed into
+	while (true) {
+		advance_whitespace(inout_read_view);
+		if (inout_read_view.empty()) {
+			if constexpr (UseExceptionsV) {
+				throw std::invalid_argument{ "Invalid JSON data: unexpected end of data; expected value" };
+			}
+
+			out_error = json_error::unexpected_end;
+			return false;
+		}
+
+		CharT front = inout_read_view.front();
+		if (front == '[' || front == '{') {
+			// Start of a container; push it to the stack
+			if (inout_state.stack.size() >= in_max_depth) {
+				if constexpr (UseExceptionsV) {
+					throw std::invalid_argument{ "Invalid JSON data: maximum nesting depth exceeded" };
+				}
+
+				out_error = json_error::max_depth_exceeded;
+				return false;
+			}
+
+			bool is_map = front == '{';
+			if constexpr (ValidatorT::enabled) {
+				if (!inout_validator.on_container_start(is_map)) {
+					return json_validator_failed<UseExceptionsV>(out_error);
+				}
+			}
+
+			if (is_map) {
+				*target = object{ object::map_type{} };
+			}
+			else {
+				*target = object::array_type{};
+			}
+			inout_state.stack.push_back({ target, is_map });
+			inout_read_view.remove_prefix(1);
+			advance_whitespace(inout_read_view);
+
+			// Checking here instead of when closing out elements means no trailing comma support
+			if (inout_read_view.empty() || inout_read_view.front() != (is_map ? '}' : ']')) {
+				target = json_next_element<CharT, UseExceptionsV>(inout_state.stack.back(), inout_read_view, inout_state.keys, out_error, inout_validator);
+				if (target == nullptr) {
+					// Any exception would've been thrown already
+					return false;
+				}
+
+				continue;
+			}
+
+			// Empty container; fall through to closing it out
+		}
+		else {
+			std::basic_string_view<CharT> value_start = inout_read_view;
+			context_type context{ *target };
+			if (tree_action<CharT, context_type, scalar_tree, std::size(scalar_tree), fail_action<CharT, context_type, UseExceptionsV>>
+				(context, inout_read_view) != 0) {
+				// Invalid JSON! Any exception would've been thrown already
+				inout_read_view = value_start;
+				out_error = json_scalar_error(front);
+				return false;
+			}
+
+			if constexpr (ValidatorT::enabled) {
+				if (!inout_validator.on_value(*target)) {
+					inout_read_view = value_start;
+					return json_validator_failed<UseExceptionsV>(out_error);
+				}
+			}
+
+			if (inout_state.stack.empty()) {
+				// Top-level scalar value
+				out_object = std::move(result);
+				return true;
+			}
+		}
+
+		// A value has been read; close out any containers which are finished, then move onto the next element
+		while (true) {
+			json_parse_frame& frame = inout_state.stack.back();
+			CharT container_end = frame.is_map ? '}' : ']';
+			advance_whitespace(inout_read_view);
+			if (inout_read_view.empty()) {
+				if constexpr (UseExceptionsV) {
+					throw std::invalid_argument{ frame.is_map
+						? "Invalid JSON data: unexpected end of data when parsing object map; expected '}'"
+						: "Invalid JSON data: unexpected end of data when parsing object array; expected ']'" };
+				}
+
+				out_error = json_error::unexpected_end;
+				return false;
+			}
+
+			front = inout_read_view.front();
+			if (front == ',') {
+				// Strip comma; value follows
+				inout_read_view.remove_prefix(1);
+				target = json_next_element<CharT, UseExceptionsV>(frame, inout_read_view, inout_state.keys, out_error, inout_validator);
+				if (target == nullptr) {
+					// Any exception would've been thrown already
+					return false;
+				}
+
+				break;
+			}
+
+			if (front != container_end) {
+				if constexpr (UseExceptionsV) {
+					throw std::invalid_argument{ jessilib::join_mbstring(frame.is_map
+						? u8"Invalid JSON data: expected ',' or '}', instead encountered: "sv
+						: u8"Invalid JSON data: expected ',' or ']', instead encountered: "sv,
+						inout_read_view) };
+				}
+
+				out_error = json_error::unexpected_token;
+				return false;
+			}
+
+			// End of container
+			if constexpr (ValidatorT::enabled) {
+				if (!inout_validator.on_container_end(*frame.container)) {
+					return json_validator_failed<UseExceptionsV>(out_error);
+				}
+			}
+
+			inout_read_view.remove_prefix(1);
+			inout_state.stack.pop_back();
+			if (inout_state.stack.empty()) {
+				// Top-level container closed; success
+				out_object = std::move(result);
+				return true;
+			}
+		}
+	}
+}
+
+template<typename CharT, bool UseExceptionsV = true>
+bool deserialize_json_iterative(object& out_object, std::basic_string_view<CharT>& inout_read_view,
+	json_parse_state& inout_state, size_t in_max_depth, json_error& out_error) {
+	json_null_validator validator;
+	return deserialize_json_iterative<CharT, UseExceptionsV>(out_object, inout_read_view, inout_state, in_max_depth, out_error, validator);
+}
+
+template<typename CharT, bool UseExceptionsV = true>
+bool deserialize_json_iterative(object& out_object, std::basic_string_view<CharT>& inout_read_view,
+	json_parse_state& inout_state, size_t in_max_depth = json_default_max_depth) {
+	json_error error{};
+	return deserialize_json_iterative<CharT, UseExceptionsV>(out_object, inout_read_view, inout_state, in_max_depth, error);
+}
+
+template<typename CharT, bool UseExceptionsV = true>
+bool deserialize_json_iterative(object& out_object, std::basic_string_view<CharT>& inout_read_view, size_t in_max_depth = json_default_max_depth) {
+	json_parse_state state;
+	return deserialize_json_iterative<CharT, UseExceptionsV>(out_object, inout_read_view, state, in_max_depth);
+}
+
+/**
+ * Exception-free JSON parsing
+ */
+
+struct json_parse_result {
+	object value;
+	json_error error{};
+	size_t offset{}; // Byte offset of the offending data
+	size_t line{}; // Line of the offending data (1-based)
+	size_t column{}; // Column of the offending data, in codepoints (1-based)
+
+	explicit operator bool() const { return error == json_error::none; }
+};
+
+/**
+ * Deserializes a JSON value without throwing on malformed input
+ *
+ * @param in_data Data to parse; empty or whitespace-only data produces a null value, and anything but whitespace after
+ *	the value is an unexpected_token
+ * @param inout_state Container stack & key pool; reuse between calls to avoid reallocating, and to share interned keys
+ * @param in_max_depth Maximum number of nested arrays/maps to accept before failing
+ * @param inout_validator Validator to notify as values are parsed (see json_null_validator)
+ * @return Parsed value on success, error & its position otherwise
+ */
+template<typename CharT, typename ValidatorT>
+json_parse_result try_deserialize_json(std::basic_string_view<CharT> in_data, json_parse_state& inout_state,
+	size_t in_max_depth, ValidatorT& inout_validator) {
+	json_parse_result result;
+	std::basic_string_view<CharT> read_view = in_data;
+	if (in_data.empty()) {
+		return result;
+	}
+
+	if (deserialize_json_iterative<CharT, false>(result.value, read_view, inout_state, in_max_depth, result.error, inout_validator)) {
+		advance_whitespace(read_view);
+		if (read_view.empty()) {
+			return result;
+		}
+
+		// Only whitespace may follow the value
+		result.value = object{};
+		result.error = json_error::unexpected_token;
+	}
+
+	// Failed; figure out where. This is only done on failure, so it's fine to re-walk the data
+	size_t units_read = in_data.size() - read_view.size();
+	result.offset = units_read * sizeof(CharT);
+	result.line = 1;
+	std::basic_string_view<CharT> line_view = in_data.substr(0, units_read);
+	size_t line_start = line_view.rfind('\n');
+	if (line_start != decltype(line_view)::npos) {
+		result.line += std::count(line_view.begin(), line_view.begin() + line_start, '\n') + 1;
+		line_view.remove_prefix(line_start + 1);
+	}
+
+	result.column = 1;
+	while (!line_view.empty()) {
+		size_t units = decode_codepoint(line_view).units;
+		line_view.remove_prefix(std::max(size_t{1}, units)); // Count any undecodable data units individually
+		++result.column;
+	}
+
+	return result;
+}
+
+template<typename CharT>
+json_parse_result try_deserialize_json(std::basic_string_view<CharT> in_data, json_parse_state& inout_state,
+	size_t in_max_depth = json_default_max_depth) {
+	json_null_validator validator;
+	return try_deserialize_json<CharT>(in_data, inout_state, in_max_depth, validator);
+}
+
+template<typename CharT>
+json_parse_result try_deserialize_json(std::basic_string_view<CharT> in_data, size_t in_max_depth = json_default_max_depth) {
+	json_parse_state state;
+	return try_deserialize_json<CharT>(in_data, state, in_max_depth);
+}
+
 template<typename CharT, typename ResultCharT>
 void make_json_string(std::basic_string<ResultCharT>& out_string, std::u8string_view in_string) {
 	using namespace std::literals;
+	if constexpr (sizeof(CharT) == sizeof(char8_t) && sizeof(ResultCharT) == sizeof(char8_t)) {
+		// UTF-8 to UTF-8; size the result up front, then copy everything between escapes all at once. As below, stop at
+		// the first invalid sequence, if any.
+		std::basic_string_view<ResultCharT> string_view{ reinterpret_cast<const ResultCharT*>(in_string.data()),
+			std::min(find_invalid(in_string), in_string.size()) };
+		size_t offset = out_string.size();
+		out_string.resize(offset + escaped_length<ResultCharT, json_escape_table>(string_view) + 2);
+		ResultCharT* write_head = out_string.data() + offset;
+		*write_head = '\"';
+		write_head = write_escape_sequences<ResultCharT, json_escape_table>(write_head + 1, string_view);
+		*write_head = '\"';
+		return;
+	}
+
 	out_string.reserve(out_string.size() + in_string.size() + 2);
 	simple_append<CharT, ResultCharT>(out_string, '\"');
 
@@ -0,0 +1,323 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * @file json_literal.hpp
+ * @author Jessica James
+ *
+ * Compile-time parsing of JSON string literals. Literals are validated & parsed at compile time into a flat array of
+ * nodes, which is turned into an object at runtime without any parsing.
+ *
+ * Usage:
+ *   static constexpr auto s_defaults = json_literal_v<u8R"json({ "port" : 6667, "channels" : [ "#jessilib" ] })json">;
+ *   object config = s_defaults.to_object();
+ *
+ * Invalid JSON fails to compile.
+ */
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include "jessilib/parsers/json.hpp"
+
+namespace jessilib {
+
+// String literal wrapper, usable as a template argument
+template<size_t SizeV>
+struct json_literal_string {
+	consteval json_literal_string(const char8_t (&in_string)[SizeV]) {
+		std::copy_n(in_string, SizeV, data);
+	}
+
+	constexpr std::u8string_view view() const { return { data, SizeV - 1 }; }
+
+	char8_t data[SizeV]{};
+};
+
+struct json_literal_node {
+	enum object::type type{};
+	bool boolean{};
+	intmax_t integer{};
+	long double decimal{};
+	size_t text_offset{}; // Decoded text, for text nodes
+	size_t text_size{};
+	size_t key_offset{}; // Decoded key, for members of a map
+	size_t key_size{};
+	size_t size{}; // Number of children, for arrays & maps
+};
+
+/**
+ * Pre-parsed JSON literal; nodes are stored in document order (containers precede their children)
+ */
+template<size_t NodesV, size_t TextV>
+struct json_literal {
+	std::array<json_literal_node, NodesV> nodes{};
+	std::array<char8_t, TextV> text{}; // Decoded strings & keys
+
+	object to_object() const;
+};
+
+/**
+ * Builds an object from pre-parsed JSON literal nodes
+ *
+ * @param in_nodes Nodes to build object from
+ * @param in_text Text referenced by in_nodes
+ * @return Object described by in_nodes[0]
+ */
+object make_json_literal_object(const json_literal_node* in_nodes, const char8_t* in_text);
+
+template<size_t NodesV, size_t TextV>
+object json_literal<NodesV, TextV>::to_object() const {
+	return make_json_literal_object(nodes.data(), text.data());
+}
+
+namespace impl {
+
+struct json_literal_sizes {
+	size_t nodes;
+	size_t text;
+};
+
+// Parses a JSON literal during constant evaluation; when out_nodes is null, nodes & text are only counted
+class json_literal_parser {
+public:
+	constexpr json_literal_parser(std::u8string_view in_data, json_literal_node* out_nodes = nullptr, char8_t* out_text = nullptr)
+		: m_data{ in_data },
+		m_nodes{ out_nodes },
+		m_text{ out_text } {
+		// Empty ctor body
+	}
+
+	constexpr json_literal_sizes parse() {
+		advance_whitespace(m_data);
+		parse_value(0, 0);
+		advance_whitespace(m_data);
+		if (!m_data.empty()) {
+			throw std::invalid_argument{ "Invalid JSON literal; unexpected data after value" };
+		}
+
+		return { m_nodes_size, m_text_size };
+	}
+
+private:
+	constexpr void parse_value(size_t in_key_offset, size_t in_key_size) {
+		if (m_data.empty()) {
+			throw std::invalid_argument{ "Invalid JSON literal; unexpected end of data; expected value" };
+		}
+
+		size_t index = m_nodes_size++;
+		json_literal_node node{};
+		node.key_offset = in_key_offset;
+		node.key_size = in_key_size;
+
+		char8_t front = m_data.front();
+		m_data.remove_prefix(1);
+		switch (front) {
+			case '[':
+				node.type = object::type::array;
+				parse_elements(node, false);
+				break;
+
+			case '{':
+				node.type = object::type::map;
+				parse_elements(node, true);
+				break;
+
+			case '\"':
+				node.type = object::type::text;
+				parse_string(node.text_offset, node.text_size);
+				break;
+
+			case 't':
+				parse_keyword(json_true_remainder);
+				node.type = object::type::boolean;
+				node.boolean = true;
+				break;
+
+			case 'f':
+				parse_keyword(json_false_remainder);
+				node.type = object::type::boolean;
+				break;
+
+			case 'n':
+				parse_keyword(json_null_remainder);
+				node.type = object::type::null;
+				break;
+
+			default:
+				parse_number(node, front);
+				break;
+		}
+
+		if (m_nodes != nullptr) {
+			m_nodes[index] = node;
+		}
+	}
+
+	constexpr void parse_elements(json_literal_node& inout_node, bool in_is_map) {
+		char8_t container_end = in_is_map ? '}' : ']';
+		advance_whitespace(m_data);
+
+		// Checking here instead of after each element means no trailing comma support
+		if (!m_data.empty() && m_data.front() == container_end) {
+			m_data.remove_prefix(1);
+			return;
+		}
+
+		while (true) {
+			size_t key_offset{};
+			size_t key_size{};
+			if (in_is_map) {
+				if (m_data.empty() || m_data.front() != '\"') {
+					throw std::invalid_argument{ "Invalid JSON literal; expected '\"' when parsing object map" };
+				}
+
+				m_data.remove_prefix(1);
+				parse_string(key_offset, key_size);
+				advance_whitespace(m_data);
+				if (m_data.empty() || m_data.front() != ':') {
+					throw std::invalid_argument{ "Invalid JSON literal; expected ':' after map key" };
+				}
+
+				m_data.remove_prefix(1);
+				advance_whitespace(m_data);
+			}
+
+			parse_value(key_offset, key_size);
+			++inout_node.size;
+
+			advance_whitespace(m_data);
+			if (m_data.empty()) {
+				throw std::invalid_argument{ "Invalid JSON literal; unexpected end of data when parsing array or map" };
+			}
+
+			char8_t front = m_data.front();
+			m_data.remove_prefix(1);
+			if (front == container_end) {
+				return;
+			}
+
+			if (front != ',') {
+				throw std::invalid_argument{ "Invalid JSON literal; expected ',' or end of array or map" };
+			}
+
+			advance_whitespace(m_data);
+		}
+	}
+
+	constexpr void parse_string(size_t& out_offset, size_t& out_size) {
+		size_t end_pos = json_string_end(m_data);
+		if (end_pos == std::u8string_view::npos) {
+			throw std::invalid_argument{ "Invalid JSON literal; missing ending quote (\") when parsing string" };
+		}
+
+		std::u8string string_data{ m_data.substr(0, end_pos) };
+		m_data.remove_prefix(end_pos + 1);
+		if (!apply_cpp_escape_sequences(string_data)) {
+			throw std::invalid_argument{ "Invalid JSON literal; invalid escape sequence in string" };
+		}
+
+		out_offset = m_text_size;
+		out_size = string_data.size();
+		if (m_text != nullptr) {
+			std::copy(string_data.begin(), string_data.end(), m_text + m_text_size);
+		}
+		m_text_size += string_data.size();
+	}
+
+	constexpr void parse_keyword(std::u8string_view in_remainder) {
+		if (!starts_with_fast(m_data, in_remainder)) {
+			throw std::invalid_argument{ "Invalid JSON literal; unexpected token when parsing true, false, or null" };
+		}
+
+		m_data.remove_prefix(in_remainder.size());
+	}
+
+	constexpr void parse_number(json_literal_node& out_node, char8_t in_front) {
+		bool negative = in_front == '-';
+		if (negative) {
+			if (m_data.empty()) {
+				throw std::invalid_argument{ "Invalid JSON literal; unexpected end of data when parsing number" };
+			}
+
+			in_front = m_data.front();
+			m_data.remove_prefix(1);
+		}
+
+		if (in_front < '0' || in_front > '9') {
+			throw std::invalid_argument{ "Invalid JSON literal; unexpected token; expected value" };
+		}
+
+		// Accumulate negatively, so that intmax_t's minimum can be represented
+		intmax_t integer = -static_cast<intmax_t>(in_front - '0');
+		while (!m_data.empty() && m_data.front() >= '0' && m_data.front() <= '9') {
+			intmax_t digit = m_data.front() - '0';
+			if (integer < (std::numeric_limits<intmax_t>::min() + digit) / 10) {
+				throw std::invalid_argument{ "Invalid JSON literal; integer out of range" };
+			}
+
+			integer = integer * 10 - digit;
+			m_data.remove_prefix(1);
+		}
+
+		if (m_data.empty() || m_data.front() != '.') {
+			if (!negative) {
+				if (integer == std::numeric_limits<intmax_t>::min()) {
+					throw std::invalid_argument{ "Invalid JSON literal; integer out of range" };
+				}
+
+				integer = -integer;
+			}
+
+			out_node.type = object::type::integer;
+			out_node.integer = integer;
+			return;
+		}
+
+		// Parse decimal portion as a magnitude, then apply the sign
+		m_data.remove_prefix(1); // strip leading '.'
+		long double decimal = -static_cast<long double>(integer);
+		const char8_t* decimal_end = parse_decimal_part(m_data.data(), m_data.data() + m_data.size(), decimal);
+		m_data.remove_prefix(decimal_end - m_data.data());
+
+		out_node.type = object::type::decimal;
+		out_node.decimal = negative ? -decimal : decimal;
+	}
+
+	std::u8string_view m_data;
+	json_literal_node* m_nodes;
+	char8_t* m_text;
+	size_t m_nodes_size{};
+	size_t m_text_size{};
+};
+
+} // namespace impl
+
+template<json_literal_string JsonV>
+consteval auto make_json_literal() {
+	constexpr impl::json_literal_sizes sizes = impl::json_literal_parser{ JsonV.view() }.parse();
+	json_literal<sizes.nodes, sizes.text> result;
+	impl::json_literal_parser{ JsonV.view(), result.nodes.data(), result.text.data() }.parse();
+	return result;
+}
+
+template<json_literal_string JsonV>
+inline constexpr auto json_literal_v = make_json_literal<JsonV>();
+
+} // namespace jessilib
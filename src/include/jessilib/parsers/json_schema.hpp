@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * @file json_schema.hpp
+ * @author Jessica James
+ *
+ * JSON Schema subset, compiled into a validator which runs during deserialize_json_iterative
+ */
+
+#pragma once
+
+#include <optional>
+#include "jessilib/parsers/json.hpp"
+
+namespace jessilib {
+
+/**
+ * Compiled JSON schema; supports the following keywords:
+ * type, enum, minimum, maximum, items, minItems, maxItems, properties, required, additionalProperties
+ * Unrecognized keywords are ignored.
+ */
+class json_schema {
+public:
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+	static constexpr size_t max_required = 64; // Maximum number of required properties per object
+
+	struct property {
+		size_t node; // npos if unconstrained
+		size_t required_index; // npos if not required
+	};
+
+	struct node {
+		uint32_t types{ ~uint32_t{} }; // Bitmask of (1 << object::type)
+		std::vector<object> enum_values; // Any value if empty
+		std::optional<long double> minimum;
+		std::optional<long double> maximum;
+		size_t min_items{};
+		size_t max_items{ npos };
+		size_t items{ npos }; // Node for array elements; npos if unconstrained
+		std::map<object::string_type, property, std::less<>> properties;
+		size_t required_count{};
+		bool additional_properties{ true };
+	};
+
+	/**
+	 * Compiles a JSON schema
+	 * May throw: invalid_argument
+	 *
+	 * @param in_schema Schema to compile
+	 */
+	explicit json_schema(const object& in_schema);
+
+	const node& get_node(size_t in_index) const { return m_nodes[in_index]; }
+
+	// Checks a single value (non-recursively) against a node's type, enum, and range constraints
+	bool check_value(size_t in_node, const object& in_value) const;
+
+private:
+	size_t compile(const object& in_schema);
+	std::vector<node> m_nodes; // m_nodes[0] is the root
+};
+
+/**
+ * Per-parse validation state for a json_schema; pass to deserialize_json_iterative or try_deserialize_json. Validation
+ * happens as values are parsed, and parsing stops at the first violation.
+ */
+class json_schema_validator {
+public:
+	static constexpr bool enabled = true;
+
+	explicit json_schema_validator(const json_schema& in_schema);
+
+	/** Validation hooks; see json_null_validator */
+	void reset();
+	bool on_container_start(bool in_is_map);
+	bool on_element();
+	bool on_key(object::string_view_type in_key);
+	bool on_value(const object& in_value);
+	bool on_container_end(const object& in_container);
+
+private:
+	struct frame {
+		size_t node;
+		size_t count; // Number of elements seen
+		uint64_t required_seen; // Bitmask of required properties seen
+	};
+
+	const json_schema& m_schema;
+	std::vector<frame> m_stack;
+	size_t m_next_node{}; // Node to validate the next value against
+};
+
+template<typename CharT>
+json_parse_result try_deserialize_json(std::basic_string_view<CharT> in_data, const json_schema& in_schema,
+	size_t in_max_depth = json_default_max_depth) {
+	json_parse_state state;
+	json_schema_validator validator{ in_schema };
+	return try_deserialize_json<CharT>(in_data, state, in_max_depth, validator);
+}
+
+} // namespace jessilib
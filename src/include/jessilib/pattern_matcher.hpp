@@ -0,0 +1,264 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * @file pattern_matcher.hpp
+ * @author Jessica James
+ *
+ * Multi-pattern (Aho-Corasick) text matching, optionally case-insensitive, over text of any encoding
+ *
+ * Usage:
+ *   pattern_matcher matcher;
+ *   size_t hello_id = matcher.add(u8"hello"sv);
+ *   matcher.add(u"jessilib"sv);
+ *   matcher.rebuild();
+ *   matcher.match(u8"HELLO from JessiLib!"sv, [](const pattern_matcher::match_type& in_match) { ... });
+ */
+
+#pragma once
+
+#include <limits>
+#include <vector>
+#include "unicode.hpp"
+
+namespace jessilib {
+
+class pattern_matcher {
+public:
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	struct match_type {
+		size_t pattern; // Pattern id, as returned by add()
+		size_t offset; // Data units into the text where the match starts
+		size_t length; // Length of the match in data units
+	};
+
+	/**
+	 * Constructs an empty matcher
+	 *
+	 * @param in_case_insensitive Whether to match case-insensitively (using simple case folding)
+	 */
+	explicit pattern_matcher(bool in_case_insensitive = true);
+
+	/**
+	 * Adds a pattern to match against; takes effect on the next rebuild()
+	 *
+	 * @param in_pattern Pattern to add
+	 * @return Id of the pattern on success, npos if in_pattern is empty or not valid
+	 */
+	template<typename CharT>
+	size_t add(std::basic_string_view<CharT> in_pattern);
+
+	template<typename CharT>
+	size_t add(const std::basic_string<CharT>& in_pattern) {
+		return add(std::basic_string_view<CharT>{ in_pattern });
+	}
+
+	/**
+	 * Removes a pattern; it stops matching immediately, and its id is never reused
+	 *
+	 * @param in_pattern Id of the pattern to remove
+	 * @return True if the pattern was removed, false if no such pattern exists
+	 */
+	bool remove(size_t in_pattern);
+
+	/**
+	 * Compiles any patterns added since the last rebuild. New patterns are inserted into the existing trie, so the cost
+	 * of a rebuild is mostly in recomputing transitions, rather than re-inserting every pattern. Removed patterns are
+	 * pruned from the trie once they make up most of it.
+	 */
+	void rebuild();
+
+	void clear();
+	bool dirty() const { return m_pending_patterns != m_patterns.size(); } // True if patterns were added since rebuild()
+	size_t size() const { return m_active_patterns; } // Number of patterns which haven't been removed
+
+	/**
+	 * Finds all matches of all patterns within some text, in a single pass. Matches are reported in order of where
+	 * they end, and may overlap. Invalid sequences in in_text never match.
+	 *
+	 * @param in_text Text to search
+	 * @param in_callback Function called with a const match_type& for each match
+	 */
+	template<typename CharT, typename CallbackT>
+	void match(std::basic_string_view<CharT> in_text, CallbackT&& in_callback) const;
+
+	template<typename CharT>
+	std::vector<match_type> match(std::basic_string_view<CharT> in_text) const {
+		std::vector<match_type> result;
+		match(in_text, [&result](const match_type& in_match) {
+			result.push_back(in_match);
+		});
+		return result;
+	}
+
+	// Checks if any pattern matches in_text
+	template<typename CharT>
+	bool contains(std::basic_string_view<CharT> in_text) const;
+
+private:
+	static constexpr uint32_t root = 0;
+	static constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+	static constexpr size_t ascii_size = 0x80;
+	static constexpr size_t max_stack_history = 128; // Longest pattern (in codepoints) match_impl doesn't allocate for, + 1
+
+	struct pattern {
+		std::u32string codepoints; // Folded, if case-insensitive
+		bool active{ true };
+	};
+
+	struct node {
+		std::vector<std::pair<char32_t, uint32_t>> children; // Sorted by codepoint
+		std::vector<uint32_t> patterns; // Patterns which end at this node
+		uint32_t failure{ root }; // Longest proper suffix which is also in the trie
+		uint32_t output{ no_node }; // Nearest node along failure links which ends a pattern
+	};
+
+	char32_t fold_codepoint(char32_t in_codepoint) const {
+		return m_case_insensitive ? fold(in_codepoint) : in_codepoint;
+	}
+
+	uint32_t child(uint32_t in_node, char32_t in_codepoint) const;
+	uint32_t next_state(uint32_t in_state, char32_t in_codepoint) const; // Transition for non-ASCII codepoints
+	void insert(uint32_t in_pattern);
+
+	template<typename CharT, typename CallbackT>
+	bool match_impl(std::basic_string_view<CharT> in_text, CallbackT&& in_callback) const;
+
+	bool m_case_insensitive;
+	std::vector<pattern> m_patterns; // Indexed by id
+	size_t m_pending_patterns{}; // Patterns before this are in m_nodes
+	size_t m_active_patterns{};
+	size_t m_removed_patterns{}; // Removed patterns still in m_nodes
+	size_t m_max_length{}; // Longest pattern, in codepoints
+	size_t m_history_size{ 1 }; // Power of 2 greater than m_max_length; codepoint offsets kept by match_impl
+	std::vector<node> m_nodes{ 1 };
+	std::vector<uint32_t> m_ascii_transitions; // Dense transitions; [node * ascii_size + codepoint]
+}; // class pattern_matcher
+
+template<typename CharT>
+size_t pattern_matcher::add(std::basic_string_view<CharT> in_pattern) {
+	pattern result;
+	while (!in_pattern.empty()) {
+		decode_result pattern_front = decode_codepoint(in_pattern);
+		if (pattern_front.units == 0) {
+			// Failed to decode front codepoint; bad unicode sequence
+			return npos;
+		}
+
+		result.codepoints += fold_codepoint(pattern_front.codepoint);
+		in_pattern.remove_prefix(pattern_front.units);
+	}
+
+	if (result.codepoints.empty()) {
+		return npos;
+	}
+
+	m_patterns.push_back(std::move(result));
+	++m_active_patterns;
+	return m_patterns.size() - 1;
+}
+
+template<typename CharT, typename CallbackT>
+void pattern_matcher::match(std::basic_string_view<CharT> in_text, CallbackT&& in_callback) const {
+	match_impl(in_text, [&in_callback](const match_type& in_match) {
+		in_callback(in_match);
+		return true;
+	});
+}
+
+template<typename CharT>
+bool pattern_matcher::contains(std::basic_string_view<CharT> in_text) const {
+	return !match_impl(in_text, [](const match_type&) {
+		return false;
+	});
+}
+
+// in_callback returns false to stop matching; returns false if stopped
+template<typename CharT, typename CallbackT>
+bool pattern_matcher::match_impl(std::basic_string_view<CharT> in_text, CallbackT&& in_callback) const {
+	if (m_ascii_transitions.empty()) {
+		// Never built
+		return true;
+	}
+
+	// Offsets of recently matched codepoints, so that match offsets can be calculated from pattern lengths; on the stack,
+	// unless there are unusually long patterns
+	size_t stack_history[max_stack_history];
+	std::vector<size_t> heap_history;
+	size_t* history = stack_history;
+	if (m_history_size > max_stack_history) {
+		heap_history.resize(m_history_size);
+		history = heap_history.data();
+	}
+	const size_t history_mask = m_history_size - 1;
+	size_t codepoint_index = 0;
+
+	const CharT* begin = in_text.data();
+	const CharT* end = begin + in_text.size();
+	const CharT* itr = begin;
+	uint32_t state = root;
+	while (itr != end) {
+		uint32_t unit = impl_unicode::unit_value(*itr);
+		size_t units = 1;
+		if (unit < ascii_size) {
+			if (m_case_insensitive) {
+				unit = impl_unicode::fold_ascii(unit);
+			}
+
+			state = m_ascii_transitions[state * ascii_size + unit];
+		}
+		else {
+			decode_result text_front = decode_codepoint(itr, end);
+			if (text_front.units == 0) {
+				// Invalid data never matches
+				state = root;
+				++itr;
+				continue;
+			}
+
+			units = text_front.units;
+			state = next_state(state, fold_codepoint(text_front.codepoint));
+		}
+
+		history[codepoint_index & history_mask] = static_cast<size_t>(itr - begin);
+		++codepoint_index;
+		itr += units;
+
+		// Report every pattern ending here
+		const node& state_node = m_nodes[state];
+		uint32_t output = state_node.patterns.empty() ? state_node.output : state;
+		for (; output != no_node; output = m_nodes[output].output) {
+			for (uint32_t pattern_id : m_nodes[output].patterns) {
+				const pattern& matched = m_patterns[pattern_id];
+				if (!matched.active) {
+					continue;
+				}
+
+				size_t offset = history[(codepoint_index - matched.codepoints.size()) & history_mask];
+				if (!in_callback(match_type{ pattern_id, offset, static_cast<size_t>(itr - begin) - offset })) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace jessilib
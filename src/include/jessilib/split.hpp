@@ -25,6 +25,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <iterator>
+#include <memory>
+#include <ranges>
 #include <string_view>
 #include <vector>
 #include <tuple>
@@ -64,6 +70,421 @@ constexpr MemberT make_split_member(ItrT in_itr, EndT in_end) {
 	return { in_itr, in_end };
 }
 
+/** Default member type for split_range; views for contiguous ranges of characters, subranges otherwise */
+template<typename ItrT, typename ElementT = std::iter_value_t<ItrT>>
+using split_range_member_t = std::conditional_t<std::contiguous_iterator<ItrT> && std::is_trivial_v<ElementT>,
+	std::basic_string_view<ElementT>, std::ranges::subrange<ItrT>>;
+
+namespace impl_split {
+
+// Whether ranges of ItrT can be searched for ElementT through pointers, rather than element-by-element
+template<typename ItrT, typename ElementT>
+constexpr bool is_unit_searchable_v = std::contiguous_iterator<ItrT>
+	&& std::is_integral_v<ElementT> && !std::is_same_v<ElementT, bool>
+	&& std::is_same_v<std::iter_value_t<ItrT>, ElementT>;
+
+/**
+ * Searches for an element; contiguous ranges of 1-byte units (and wchar_t) are searched with memchr (wmemchr) at
+ * runtime, everything else with std::find
+ */
+template<typename ItrT, typename ElementT>
+constexpr ItrT find_element(ItrT in_begin, ItrT in_end, const ElementT& in_element) {
+	if constexpr (is_unit_searchable_v<ItrT, ElementT> && (sizeof(ElementT) == 1 || std::is_same_v<ElementT, wchar_t>)) {
+		if (!std::is_constant_evaluated() && in_begin != in_end) {
+			const ElementT* begin = std::to_address(in_begin);
+			const size_t length = static_cast<size_t>(in_end - in_begin);
+			const ElementT* match;
+			if constexpr (sizeof(ElementT) == 1) {
+				match = static_cast<const ElementT*>(std::memchr(begin, static_cast<unsigned char>(in_element), length));
+			}
+			else {
+				match = std::wmemchr(begin, in_element, length);
+			}
+
+			if (match == nullptr) {
+				return in_end;
+			}
+
+			return in_begin + (match - begin);
+		}
+	}
+
+	return std::find(in_begin, in_end, in_element);
+}
+
+/**
+ * Two-Way string matching (Crochemore & Perrin), as in glibc's memmem: linear time & constant space, with the needle
+ * preprocessed once per delimiter rather than once per token. Each attempt starts with a find_element() for the unit at
+ * the critical position, so sparse delimiters are found at memchr speed.
+ */
+template<typename ElementT>
+class two_way_searcher {
+public:
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	constexpr two_way_searcher() = default;
+
+	constexpr two_way_searcher(const ElementT* in_needle, size_t in_length)
+		: m_needle{ in_needle },
+		m_length{ in_length } {
+		if (in_length == 0) {
+			return;
+		}
+
+		// Critical factorization; the later of the maximal suffixes for either ordering, and the period of its prefix
+		size_t period{};
+		size_t suffix = max_suffix(false, period);
+		size_t reverse_period{};
+		size_t reverse_suffix = max_suffix(true, reverse_period);
+		if (reverse_suffix + 1 >= suffix + 1) {
+			suffix = reverse_suffix;
+			period = reverse_period;
+		}
+		m_suffix = suffix + 1;
+
+		// Whether the needle is periodic; if not, any period longer than either half will do
+		m_periodic = m_suffix + period <= m_length
+			&& std::equal(m_needle, m_needle + m_suffix, m_needle + period);
+		m_period = m_periodic ? period : std::max(m_suffix, m_length - m_suffix) + 1;
+	}
+
+	/** Returns a pointer to the first match in [in_begin, in_end), or in_end if there is none */
+	constexpr const ElementT* find(const ElementT* in_begin, const ElementT* in_end) const {
+		const size_t haystack_length = static_cast<size_t>(in_end - in_begin);
+		if (m_length == 0 || m_length > haystack_length) {
+			return in_end;
+		}
+
+		const ElementT* critical_end = in_begin + (haystack_length - m_length) + m_suffix + 1;
+		size_t position = 0;
+		size_t memory = 0; // Length of the needle's prefix known to match at position (periodic needles only)
+		while (true) {
+			if (memory == 0) {
+				// No match can start before the critical unit next lines up
+				const ElementT* critical = find_element(in_begin + position + m_suffix, critical_end, m_needle[m_suffix]);
+				if (critical == critical_end) {
+					return in_end;
+				}
+				position = static_cast<size_t>(critical - in_begin) - m_suffix;
+			}
+
+			// Match the right half, left to right
+			const ElementT* haystack = in_begin + position;
+			size_t index = std::max(m_suffix, memory);
+			while (index < m_length && m_needle[index] == haystack[index]) {
+				++index;
+			}
+
+			if (index < m_length) {
+				position += index - m_suffix + 1;
+				memory = 0;
+			}
+			else {
+				// Match the left half, right to left
+				index = m_suffix;
+				while (index > memory && m_needle[index - 1] == haystack[index - 1]) {
+					--index;
+				}
+
+				if (index <= memory) {
+					return haystack;
+				}
+
+				position += m_period;
+				if (m_periodic) {
+					memory = m_length - m_period;
+				}
+			}
+
+			if (position > haystack_length - m_length) {
+				return in_end;
+			}
+		}
+	}
+
+	constexpr size_t size() const {
+		return m_length;
+	}
+
+private:
+	// Returns the start of the maximal suffix (npos for the whole needle), and the period of that suffix
+	constexpr size_t max_suffix(bool in_reverse, size_t& out_period) const {
+		size_t suffix = npos;
+		size_t index = 0;
+		size_t offset = 1;
+		out_period = 1;
+		while (index + offset < m_length) {
+			ElementT lhs = m_needle[index + offset];
+			ElementT rhs = m_needle[suffix + offset]; // suffix + offset wraps to offset - 1 when suffix == npos
+			if (in_reverse ? rhs < lhs : lhs < rhs) {
+				index += offset;
+				offset = 1;
+				out_period = index - suffix;
+			}
+			else if (lhs == rhs) {
+				if (offset != out_period) {
+					++offset;
+				}
+				else {
+					index += out_period;
+					offset = 1;
+				}
+			}
+			else {
+				suffix = index++;
+				offset = 1;
+				out_period = 1;
+			}
+		}
+
+		return suffix;
+	}
+
+	const ElementT* m_needle{};
+	size_t m_length{};
+	size_t m_suffix{}; // Critical position
+	size_t m_period{};
+	bool m_periodic{};
+};
+
+/** Delimiter consisting of a single element */
+template<typename ElementT>
+struct element_delimiter {
+	// Returns the range of the first delimiter in [in_begin, in_end), or {in_end, in_end} if there is none
+	template<typename ItrT>
+	constexpr std::pair<ItrT, ItrT> find(ItrT in_begin, ItrT in_end) const {
+		ItrT match = find_element(in_begin, in_end, m_delim);
+		if (match == in_end) {
+			return { in_end, in_end };
+		}
+
+		return { match, std::next(match) };
+	}
+
+	ElementT m_delim;
+};
+
+/**
+ * Delimiter consisting of a sequence of elements; an empty sequence never matches. Contiguous ranges of integral
+ * units are searched with a two_way_searcher, everything else with std::search.
+ */
+template<typename DelimItrT>
+class sequence_delimiter {
+public:
+	using element_type = std::iter_value_t<DelimItrT>;
+	static constexpr bool use_two_way = is_unit_searchable_v<DelimItrT, element_type>;
+
+	constexpr sequence_delimiter() = default;
+
+	constexpr sequence_delimiter(DelimItrT in_begin, DelimItrT in_end)
+		: m_begin{ in_begin },
+		m_end{ in_end } {
+		if constexpr (use_two_way) {
+			m_searcher = { std::to_address(in_begin), static_cast<size_t>(in_end - in_begin) };
+		}
+	}
+
+	// Returns the range of the first delimiter in [in_begin, in_end), or {in_end, in_end} if there is none
+	template<typename ItrT>
+	constexpr std::pair<ItrT, ItrT> find(ItrT in_begin, ItrT in_end) const {
+		if (m_begin == m_end) {
+			return { in_end, in_end };
+		}
+
+		if constexpr (use_two_way && is_unit_searchable_v<ItrT, element_type>) {
+			const element_type* begin = std::to_address(in_begin);
+			const element_type* end = begin + (in_end - in_begin);
+			const element_type* match = m_searcher.find(begin, end);
+			if (match == end) {
+				return { in_end, in_end };
+			}
+
+			ItrT match_itr = in_begin + (match - begin);
+			return { match_itr, match_itr + m_searcher.size() };
+		}
+		else {
+			ItrT match = std::search(in_begin, in_end, m_begin, m_end);
+			if (match == in_end) {
+				return { in_end, in_end };
+			}
+
+			return { match, std::next(match, std::distance(m_begin, m_end)) };
+		}
+	}
+
+private:
+	struct no_searcher {};
+
+	DelimItrT m_begin{};
+	DelimItrT m_end{};
+	std::conditional_t<use_two_way, two_way_searcher<element_type>, no_searcher> m_searcher{};
+};
+
+} // namespace impl_split
+
+/**
+ * Lazily split range of elements; each token is found only as the iterator reaches it, so nothing is allocated unless
+ * MemberT allocates. Yields the same tokens as split(). Iterators refer only to the input (and the delimiter, for
+ * sequence delimiters), so they remain valid after the range is destroyed.
+ *
+ * @tparam MemberT Type of the tokens yielded by the range
+ * @tparam ItrT Iterator type of the range being split; must be a forward iterator
+ * @tparam DelimiterT Searcher for the delimiter (see impl_split)
+ */
+template<typename MemberT, typename ItrT, typename DelimiterT>
+class basic_split_range : public std::ranges::view_interface<basic_split_range<MemberT, ItrT, DelimiterT>> {
+public:
+	class iterator {
+	public:
+		using iterator_concept = std::forward_iterator_tag;
+		using iterator_category = std::input_iterator_tag;
+		using value_type = MemberT;
+		using difference_type = std::ptrdiff_t;
+
+		constexpr iterator() = default;
+
+		constexpr iterator(ItrT in_begin, ItrT in_end, const DelimiterT& in_delimiter)
+			: m_end{ in_end },
+			m_delimiter{ in_delimiter } {
+			if (in_begin == in_end) {
+				// Nothing to split
+				m_token_begin = in_end;
+				m_done = true;
+				return;
+			}
+
+			find_token(in_begin);
+		}
+
+		constexpr MemberT operator*() const {
+			return make_split_member<MemberT>(m_token_begin, m_token_end);
+		}
+
+		constexpr iterator& operator++() {
+			if (m_token_end == m_end) {
+				// That was the final token
+				m_done = true;
+				return *this;
+			}
+
+			find_token(m_next);
+			return *this;
+		}
+
+		constexpr iterator operator++(int) {
+			iterator result = *this;
+			++*this;
+			return result;
+		}
+
+		/** Start of the current token; the unsplit remainder is [base(), end) */
+		constexpr ItrT base() const {
+			return m_token_begin;
+		}
+
+		friend constexpr bool operator==(const iterator& in_lhs, const iterator& in_rhs) {
+			return in_lhs.m_done == in_rhs.m_done
+				&& (in_lhs.m_done || in_lhs.m_token_begin == in_rhs.m_token_begin);
+		}
+
+		friend constexpr bool operator==(const iterator& in_lhs, std::default_sentinel_t) {
+			return in_lhs.m_done;
+		}
+
+	private:
+		constexpr void find_token(ItrT in_token_begin) {
+			auto match = m_delimiter.find(in_token_begin, m_end);
+			m_token_begin = in_token_begin;
+			m_token_end = match.first;
+			m_next = match.second;
+		}
+
+		ItrT m_token_begin{};
+		ItrT m_token_end{};
+		ItrT m_next{}; // Start of the next token, if m_token_end isn't the end
+		ItrT m_end{};
+		DelimiterT m_delimiter{};
+		bool m_done{};
+	};
+
+	constexpr basic_split_range() = default;
+
+	constexpr basic_split_range(ItrT in_begin, ItrT in_end, DelimiterT in_delimiter)
+		: m_begin{ in_begin },
+		m_end{ in_end },
+		m_delimiter{ std::move(in_delimiter) } {
+		// Empty body
+	}
+
+	constexpr iterator begin() const {
+		return { m_begin, m_end, m_delimiter };
+	}
+
+	constexpr std::default_sentinel_t end() const {
+		return std::default_sentinel;
+	}
+
+private:
+	ItrT m_begin{};
+	ItrT m_end{};
+	DelimiterT m_delimiter{};
+};
+
+/**
+ * Lazily splits a range of elements into substrings; see basic_split_range
+ *
+ * @tparam OptionalMemberT Type of the tokens; defaults to a view type (see split_range_member_t)
+ * @param begin Start of range of elements to split
+ * @param end End of range of elements to split
+ * @param in_delim Delimiter to split upon
+ * @return Range of tokens, equal to those returned by split()
+ */
+template<typename... OptionalMemberT, typename ItrT, typename EndT, typename ElementT>
+constexpr auto split_range(ItrT begin, EndT end, ElementT in_delim) {
+	static_assert(sizeof...(OptionalMemberT) <= 1, "Too many member types specified for OptionalMemberT");
+	using RangeItrT = std::common_type_t<ItrT, EndT>; // i.e: const_iterator for an iterator & const_iterator
+	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., split_range_member_t<RangeItrT>>>;
+	return basic_split_range<MemberT, RangeItrT, impl_split::element_delimiter<ElementT>>{ begin, end, { in_delim } };
+}
+
+/**
+ * Lazily splits a range of elements into substrings; see basic_split_range
+ *
+ * @tparam OptionalMemberT Type of the tokens; defaults to a view type (see split_range_member_t)
+ * @param begin Start of range of elements to split
+ * @param end End of range of elements to split
+ * @param in_delim_begin Start of range containing the delimiter
+ * @param in_delim_end End of range containing the delimiter
+ * @return Range of tokens, equal to those returned by split()
+ */
+template<typename... OptionalMemberT, typename ItrT, typename EndT, typename DelimItrT, typename DelimEndT>
+constexpr auto split_range(ItrT begin, EndT end, DelimItrT in_delim_begin, DelimEndT in_delim_end) {
+	static_assert(sizeof...(OptionalMemberT) <= 1, "Too many member types specified for OptionalMemberT");
+	using RangeItrT = std::common_type_t<ItrT, EndT>;
+	using DelimRangeItrT = std::common_type_t<DelimItrT, DelimEndT>;
+	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., split_range_member_t<RangeItrT>>>;
+	return basic_split_range<MemberT, RangeItrT, impl_split::sequence_delimiter<DelimRangeItrT>>{ begin, end, { in_delim_begin, in_delim_end } };
+}
+
+/**
+ * Lazily splits a string into substrings; the string and delimiter must outlive the range
+ *
+ * @tparam OptionalMemberT Type of the tokens; defaults to a view type (see split_range_member_t)
+ * @param in_string String to split
+ * @param in_delim Delimiter to split upon
+ * @return Range of tokens, equal to those returned by split()
+ */
+template<typename... OptionalMemberT, typename InputT>
+constexpr auto split_range(const InputT& in_string, typename InputT::value_type in_delim) {
+	return split_range<OptionalMemberT...>(in_string.begin(), in_string.end(), in_delim);
+}
+
+template<typename... OptionalMemberT, typename InputT, typename DelimT,
+	typename std::enable_if<!std::is_same<DelimT, typename InputT::value_type>::value>::type* = nullptr>
+constexpr auto split_range(const InputT& in_string, const DelimT& in_delim) {
+	return split_range<OptionalMemberT...>(in_string.begin(), in_string.end(), in_delim.begin(), in_delim.end());
+}
+
 /**
  * Splits an input string into substrings
  *
@@ -81,22 +502,10 @@ constexpr auto split(ItrT begin, EndT end, ElementT in_delim) {
 	using container_type = typename split_defaults_type::container_type;
 
 	container_type result;
-	if (begin >= end) {
-		// Nothing to split
-		return result;
+	for (auto&& token : split_range<member_type>(begin, end, in_delim)) {
+		result.push_back(std::move(token));
 	}
 
-	for (auto itr = begin; itr != end; ++itr) {
-		if (*itr == in_delim) {
-			// Push token to result
-			result.push_back(make_split_member<member_type>(begin, itr));
-			begin = itr + 1;
-		}
-	}
-
-	// Push final token to the end; may be empty
-	result.push_back(make_split_member<member_type>(begin, end));
-
 	return result;
 }
 
@@ -118,40 +527,16 @@ constexpr auto split(ItrT begin, EndT end, DelimItrT in_delim_begin, DelimEndT i
 	using member_type = typename split_defaults_type::member_type;
 	using container_type = typename split_defaults_type::container_type;
 
-	auto delim_length = std::distance(in_delim_begin, in_delim_end);
-	if (delim_length == 1) {
+	if (std::ranges::distance(in_delim_begin, in_delim_end) == 1) {
 		return split<ContainerT, ContainerArgsT...>(begin, end, *in_delim_begin);
 	}
 
+	// An absent delimiter never matches, so the input is returned as a single token
 	container_type result{};
-	if (begin >= end) {
-		// Nothing to split
-		return result;
-	}
-
-	if (in_delim_begin >= in_delim_end
-		|| (end - begin) < delim_length) {
-		// Absent or impossible to match delimiter, therefore no match, therefore return input as single token
-		result.push_back(make_split_member<member_type>(begin, end));
-		return result;
-	}
-
-	auto itr_end = end - (delim_length - 1);
-	for (auto itr = begin; itr < itr_end;) {
-		if (std::equal(in_delim_begin, in_delim_end, itr)) {
-			// Push token to result
-			result.push_back(make_split_member<member_type>(begin, itr));
-			itr += delim_length;
-			begin = itr;
-			continue;
-		}
-
-		++itr;
+	for (auto&& token : split_range<member_type>(begin, end, in_delim_begin, in_delim_end)) {
+		result.push_back(std::move(token));
 	}
 
-	// Push final token to the end; may be empty
-	result.push_back(make_split_member<member_type>(begin, end));
-
 	return result;
 }
 
@@ -231,7 +616,7 @@ constexpr auto split_once(ItrT begin, EndT end, DelimItrT in_delim_begin, DelimE
 	using ElementT = std::remove_cvref_t<decltype(*begin)>;
 	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., std::basic_string<ElementT>>>;
 
-	auto delim_length = std::distance(in_delim_begin, in_delim_end);
+	auto delim_length = std::ranges::distance(in_delim_begin, in_delim_end);
 	if (delim_length == 1) {
 		return split_once<OptionalMemberT...>(begin, end, *in_delim_begin);
 	}
@@ -310,23 +695,17 @@ constexpr auto split_n(ItrT begin, EndT end, ElementT in_delim, size_t in_limit)
 	using container_type = typename split_defaults_type::container_type;
 
 	container_type result;
-	if (begin >= end) {
-		// Nothing to split
-		return result;
+	auto range = split_range<member_type>(begin, end, in_delim);
+	auto itr = range.begin();
+	for (; itr != range.end() && in_limit != 0; ++itr, --in_limit) {
+		result.push_back(*itr);
 	}
 
-	for (auto itr = begin; itr != end && in_limit != 0; ++itr) {
-		if (*itr == in_delim) {
-			// Push token to result
-			result.push_back(make_split_member<member_type>(begin, itr));
-			begin = itr + 1;
-			--in_limit;
-		}
+	// Push the unprocessed remainder; may be empty
+	if (itr != range.end()) {
+		result.push_back(make_split_member<member_type>(itr.base(), decltype(itr.base()){ end }));
 	}
 
-	// Push final token to the end; may be empty
-	result.push_back(make_split_member<member_type>(begin, end));
-
 	return result;
 }
 
@@ -348,41 +727,22 @@ constexpr auto split_n(ItrT begin, EndT end, DelimItrT in_delim_begin, DelimEndT
 	using member_type = typename split_defaults_type::member_type;
 	using container_type = typename split_defaults_type::container_type;
 
-	auto delim_length = std::distance(in_delim_begin, in_delim_end);
-	if (delim_length == 1) {
+	if (std::ranges::distance(in_delim_begin, in_delim_end) == 1) {
 		return split_n<ContainerT, ContainerArgsT...>(begin, end, *in_delim_begin, in_limit);
 	}
 
 	container_type result{};
-	if (begin >= end) {
-		// Nothing to split
-		return result;
-	}
-
-	if (in_delim_begin >= in_delim_end
-		|| (end - begin) < delim_length) {
-		// Absent or impossible to match delimiter, therefore no match, therefore return input as single token
-		result.push_back(make_split_member<member_type>(begin, end));
-		return result;
+	auto range = split_range<member_type>(begin, end, in_delim_begin, in_delim_end);
+	auto itr = range.begin();
+	for (; itr != range.end() && in_limit != 0; ++itr, --in_limit) {
+		result.push_back(*itr);
 	}
 
-	auto itr_end = end - (delim_length - 1);
-	for (auto itr = begin; itr < itr_end && in_limit != 0;) {
-		if (std::equal(in_delim_begin, in_delim_end, itr)) {
-			// Push token to result
-			result.push_back(make_split_member<member_type>(begin, itr));
-			itr += delim_length;
-			begin = itr;
-			--in_limit;
-			continue;
-		}
-
-		++itr;
+	// Push the unprocessed remainder; may be empty
+	if (itr != range.end()) {
+		result.push_back(make_split_member<member_type>(itr.base(), decltype(itr.base()){ end }));
 	}
 
-	// Push final token to the end; may be empty
-	result.push_back(make_split_member<member_type>(begin, end));
-
 	return result;
 }
 
@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * Opt-in instrumentation for syntax trees (see unicode_syntax.hpp)
+ *
+ * Profiling is enabled per context type, by specializing syntax_tree_profiling for it, or for every context type with
+ * the JESSILIB_SYNTAX_TREE_PROFILING CMake option. When it's disabled (the default), tree_action is compiled exactly as
+ * if this didn't exist. When it's enabled, tree_action records into the syntax_tree_profile which is active on the
+ * current thread (if any):
+ *
+ *	syntax_tree_profile profile;
+ *	{
+ *		syntax_tree_profile::scope profile_scope{ profile };
+ *		deserialize_json(...);
+ *	}
+ *	serialize_object(std::cout, profile.to_object(), "json");
+ *
+ * Every translation unit which parses with a context type must agree on whether it's profiled, or tree_action
+ * instantiations differ between them (an ODR violation). The CMake option defines JESSILIB_SYNTAX_TREE_PROFILING
+ * publicly on jessilib for this reason; don't define it by hand for only some translation units. Likewise, a
+ * specialization of syntax_tree_profiling must be visible to every translation unit which parses with its context type,
+ * including the library's own (i.e: parsers/json.cpp, for the JSON parser's contexts).
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace jessilib {
+
+class object;
+
+/** Whether or not tree_action records into the active syntax_tree_profile for a given context type */
+template<typename ContextT>
+struct syntax_tree_profiling {
+#ifdef JESSILIB_SYNTAX_TREE_PROFILING
+	static constexpr bool enabled = true;
+#else // JESSILIB_SYNTAX_TREE_PROFILING
+	static constexpr bool enabled = false;
+#endif // JESSILIB_SYNTAX_TREE_PROFILING
+};
+
+template<typename ContextT>
+inline constexpr bool syntax_tree_profiling_v = syntax_tree_profiling<ContextT>::enabled;
+
+class syntax_tree_profile {
+public:
+	struct counters {
+		size_t invocations{};
+		size_t bytes{}; // Bytes consumed by the action, including those of the codepoint which triggered it
+		std::chrono::nanoseconds time{}; // Only tracked for default actions
+	};
+
+	struct tree_counters {
+		std::u8string name;
+		std::map<char32_t, counters> members; // Keyed by the codepoint of each tree member
+		counters default_action;
+	};
+
+	/** Makes a profile active on the current thread for the lifetime of the scope, restoring the previous one after */
+	class scope {
+	public:
+		scope(syntax_tree_profile& in_profile);
+		~scope();
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+
+	private:
+		syntax_tree_profile* m_previous;
+	};
+
+	/** Profile which is active on the current thread, or nullptr if there is none */
+	static syntax_tree_profile* current();
+
+	void record_member(const void* in_tree, char32_t in_codepoint, size_t in_bytes);
+	void record_default_action(const void* in_tree, size_t in_bytes, std::chrono::nanoseconds in_time);
+
+	/** Names a tree, for to_object(); unnamed trees are named after their address */
+	void set_tree_name(const void* in_tree, std::u8string in_name);
+
+	const std::unordered_map<const void*, tree_counters>& trees() const;
+	void clear();
+
+	/**
+	 * Dumps the profile; a map of tree names to maps of each triggered member (keyed by its codepoint, in UTF-8) and
+	 * "default_action", each of which is a map of "invocations", "bytes", and (for "default_action") "nanoseconds"
+	 */
+	object to_object() const;
+
+private:
+	tree_counters& get_tree(const void* in_tree);
+
+	std::unordered_map<const void*, tree_counters> m_trees;
+};
+
+} // namespace jessilib
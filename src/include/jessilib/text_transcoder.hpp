@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cwchar>
+#include <string_view>
+#include "text_encoding.hpp"
+
+namespace jessilib {
+
+/**
+ * Transcodes a stream of text between any two text_encodings, one chunk at a time, so that network & file readers can
+ * transcode data as it arrives rather than reassembling whole messages first. Sequences which are split across chunks
+ * (including partial UTF-16/32 data units) are held back until the chunk which completes them arrives.
+ *
+ * wchar is treated as whichever of UTF-16/UTF-32 wchar_t natively holds. multibyte is transcoded as UTF-8 if the C
+ * locale is UTF-8 at construction; otherwise it's converted with mbrtoc32/c32rtomb, which use whichever C locale is
+ * current at each call. The locale therefore shouldn't change during a stream.
+ * Input is validated strictly; invalid sequences are either reported or replaced with U+FFFD.
+ */
+class text_transcoder {
+public:
+	enum class status {
+		complete, // All input was consumed; an incomplete trailing sequence may be held back for the next call
+		output_full, // The output buffer filled up; call again with the unconsumed input once there's room
+		invalid // An invalid sequence ending at in_data[consumed] was skipped; call again with the rest to continue
+	};
+
+	/**
+	 * Output buffers smaller than a single encoded sequence (4 bytes, or MB_CUR_MAX for multibyte output) can't make
+	 * progress; transcode() and finish() keep returning output_full without consuming or producing anything. A buffer
+	 * of at least this many bytes always fits one, for any write encoding.
+	 */
+	static constexpr size_t min_buffer_size = MB_LEN_MAX > 4 ? MB_LEN_MAX : 4;
+
+	struct result_type {
+		status state;
+		size_t consumed; // Bytes of input consumed, including any which were held back
+		size_t produced; // Bytes written to the output buffer
+	};
+
+	/**
+	 * @param in_read_encoding Encoding of the input chunks
+	 * @param in_write_encoding Encoding to write output in
+	 * @param in_replace_invalid Whether invalid input should be replaced with U+FFFD, rather than reported
+	 * @throws std::invalid_argument if either encoding is text_encoding::unknown
+	 */
+	text_transcoder(text_encoding in_read_encoding, text_encoding in_write_encoding, bool in_replace_invalid = false);
+
+	/**
+	 * Transcodes a chunk of input
+	 *
+	 * @param in_data Chunk of input, in read_encoding()
+	 * @param out_buffer Buffer to write output to, in write_encoding()
+	 * @param in_buffer_size Size of out_buffer, in bytes; see min_buffer_size
+	 * @return Status, along with the number of bytes consumed & produced
+	 */
+	result_type transcode(std::string_view in_data, char* out_buffer, size_t in_buffer_size);
+
+	/**
+	 * Ends the stream, flushing any held back input; a held back sequence at this point is incomplete, and is therefore
+	 * either reported as invalid or replaced. The transcoder is ready for a new stream afterwards, unless the output
+	 * buffer filled up, in which case finish() should be called again once there's room.
+	 *
+	 * @param out_buffer Buffer to write output to, in write_encoding()
+	 * @param in_buffer_size Size of out_buffer, in bytes; see min_buffer_size
+	 * @return Status, along with the number of bytes produced
+	 */
+	result_type finish(char* out_buffer, size_t in_buffer_size);
+
+	/** Discards any held back input & shift state, to begin a new stream */
+	void reset();
+
+	/** Number of bytes of input currently held back, waiting for the rest of a sequence */
+	size_t pending() const;
+
+	text_encoding read_encoding() const;
+	text_encoding write_encoding() const;
+
+private:
+	template<typename InCharT, typename OutCharT>
+	result_type transcode_impl(std::string_view in_data, char* out_buffer, size_t in_buffer_size, bool in_finish);
+
+	using transcode_function = result_type (text_transcoder::*)(std::string_view, char*, size_t, bool);
+
+	text_encoding m_read_encoding;
+	text_encoding m_write_encoding;
+	bool m_replace_invalid;
+	bool m_read_swap; // Input is in the foreign byte order
+	bool m_write_swap; // Output is in the foreign byte order
+	transcode_function m_transcode;
+	char m_pending[4]{}; // Held back UTF-8/16/32 input; at most one partial sequence or data unit
+	size_t m_pending_size{};
+	std::mbstate_t m_read_state{}; // Multibyte shift states
+	std::mbstate_t m_write_state{};
+};
+
+} // namespace jessilib
@@ -60,7 +60,7 @@ private:
 		std::thread m_thread;
 	};
 
-	thread* inactive_thread();
+	thread* inactive_thread(task_t& inout_task); // pops an inactive thread, or queues inout_task if there is none
 	task_t pop_task();
 
 	std::vector<thread> m_threads;
@@ -20,6 +20,8 @@
 
 #include <cuchar>
 #include <climits>
+#include <cstring>
+#include <bit>
 #include "unicode_compare.hpp"
 
 namespace jessilib {
@@ -82,23 +84,235 @@ struct is_string<T[N]> {
 	constexpr bool operator()() const noexcept { return true; }
 };
 
+// Loads 8 bytes of data units; memcpy avoids alignment & aliasing issues, and compiles down to a single load
+template<typename CharT>
+uint64_t load_word(const CharT* in_data) {
+	uint64_t result;
+	std::memcpy(&result, in_data, sizeof(result));
+	return result;
+}
+
+// Index of the first byte within in_mask which has its high bit set; in_mask must be non-zero
+inline size_t first_marked_byte(uint64_t in_mask) {
+	if constexpr (std::endian::native == std::endian::little) {
+		return std::countr_zero(in_mask) / 8;
+	}
+	else {
+		return std::countl_zero(in_mask) / 8;
+	}
+}
+
+// Marks (sets the high bit of) each byte within in_word which is zero
+inline uint64_t mark_zero_bytes(uint64_t in_word) {
+	constexpr uint64_t high_bits = 0x8080808080808080ULL;
+	return ~(((in_word & ~high_bits) + ~high_bits) | in_word) & high_bits;
+}
+
+/**
+ * Finds the first unit which is equal to any of UnitsV; byte-width strings are checked 8 units at a time
+ *
+ * @param in_begin Start of the string to search
+ * @param in_end End of the string to search
+ * @return Pointer to the first matching unit, or in_end if there is none
+ */
+template<char8_t... UnitsV, typename CharT>
+const CharT* find_any_unit(const CharT* in_begin, const CharT* in_end) {
+	static_assert(((UnitsV < 0x80) && ...), "Units must be ASCII");
+	const CharT* itr = in_begin;
+	if constexpr (sizeof(CharT) == 1) {
+		constexpr uint64_t low_bits = 0x0101010101010101ULL;
+		while (in_end - itr >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+			uint64_t word = load_word(itr);
+			uint64_t marks = (mark_zero_bytes(word ^ (low_bits * UnitsV)) | ...);
+			if (marks != 0) {
+				return itr + first_marked_byte(marks);
+			}
+
+			itr += sizeof(uint64_t);
+		}
+	}
+
+	for (; itr != in_end; ++itr) {
+		auto unit = static_cast<std::make_unsigned_t<CharT>>(*itr);
+		if (((unit == UnitsV) || ...)) {
+			return itr;
+		}
+	}
+
+	return in_end;
+}
+
+// Sum of the bytes within in_word; the sum must fit within a byte
+inline size_t sum_bytes(uint64_t in_word) {
+	return static_cast<size_t>((in_word * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * Checks a single UTF-8 sequence, rejecting overlong encodings, surrogates, and codepoints past U+10FFFF
+ *
+ * @param in_begin Start of the sequence; must not be ASCII
+ * @param in_end End of the string
+ * @return Length of the sequence if it's valid, 0 otherwise
+ */
+template<typename CharT>
+constexpr size_t utf8_sequence_length(const CharT* in_begin, const CharT* in_end) {
+	size_t available = static_cast<size_t>(in_end - in_begin);
+	uint8_t lead = static_cast<uint8_t>(in_begin[0]);
+	if (lead < 0xC2 || lead > 0xF4 || available < 2) {
+		// Continuation byte, overlong 2-byte lead (C0, C1), lead byte past U+10FFFF, or truncated sequence
+		return 0;
+	}
+
+	uint8_t second = static_cast<uint8_t>(in_begin[1]);
+	if (lead < 0xE0) {
+		return (second & 0xC0) == 0x80 ? 2 : 0;
+	}
+
+	// The valid range of the second byte excludes overlong encodings (E0, F0), surrogates (ED), and codepoints
+	// past U+10FFFF (F4)
+	uint8_t second_min = lead == 0xE0 ? 0xA0 : (lead == 0xF0 ? 0x90 : 0x80);
+	uint8_t second_max = lead == 0xED ? 0x9F : (lead == 0xF4 ? 0x8F : 0xBF);
+	if (second < second_min || second > second_max) {
+		return 0;
+	}
+
+	if (lead < 0xF0) {
+		return available >= 3 && (static_cast<uint8_t>(in_begin[2]) & 0xC0) == 0x80 ? 3 : 0;
+	}
+
+	return available >= 4
+		&& (static_cast<uint8_t>(in_begin[2]) & 0xC0) == 0x80
+		&& (static_cast<uint8_t>(in_begin[3]) & 0xC0) == 0x80 ? 4 : 0;
+}
+
+template<typename CharT>
+size_t find_invalid_utf8_scalar(std::basic_string_view<CharT> in_string) {
+	constexpr uint64_t high_bits = 0x8080808080808080ULL;
+	const CharT* begin = in_string.data();
+	const CharT* end = begin + in_string.size();
+	const CharT* itr = begin;
+
+	while (itr != end) {
+		if ((static_cast<uint8_t>(*itr) & 0x80) != 0) {
+			// Multi-byte sequence; validate it, then continue along
+			size_t length = utf8_sequence_length(itr, end);
+			if (length == 0) {
+				return static_cast<size_t>(itr - begin);
+			}
+
+			itr += length;
+			continue;
+		}
+
+		// Skip over ASCII 8 bytes at a time
+		while (end - itr >= 8) {
+			uint64_t mask = load_word(itr) & high_bits;
+			if (mask != 0) {
+				itr += first_marked_byte(mask);
+				break;
+			}
+
+			itr += 8;
+		}
+
+		// Tail
+		while (itr != end && (static_cast<uint8_t>(*itr) & 0x80) == 0) {
+			++itr;
+		}
+	}
+
+	return std::basic_string_view<CharT>::npos;
+}
+
+// Vectorized where supported by the CPU, find_invalid_utf8_scalar otherwise; see unicode.cpp
+size_t find_invalid_utf8(const char8_t* in_data, size_t in_length);
+
+template<typename CharT>
+size_t find_invalid_utf16(std::basic_string_view<CharT> in_string) {
+	constexpr uint64_t low_bits = 0x0001000100010001ULL;
+	constexpr uint64_t high_bits = 0x8000800080008000ULL;
+	constexpr uint64_t surrogate_mask = 0xF800F800F800F800ULL;
+	constexpr uint64_t surrogate_bits = 0xD800D800D800D800ULL;
+	const CharT* begin = in_string.data();
+	const CharT* end = begin + in_string.size();
+	const CharT* itr = begin;
+
+	while (itr != end) {
+		// Skip over non-surrogates 4 units at a time; a lane is zero iff that unit is a surrogate
+		while (end - itr >= 4) {
+			uint64_t lanes = (load_word(itr) & surrogate_mask) ^ surrogate_bits;
+			if (((lanes - low_bits) & ~lanes & high_bits) != 0) {
+				break;
+			}
+
+			itr += 4;
+		}
+
+		// Tail, or a surrogate within the next 4 units
+		while (itr != end && (static_cast<char16_t>(*itr) & 0xF800) != 0xD800) {
+			++itr;
+		}
+
+		if (itr == end) {
+			break;
+		}
+
+		// Surrogates must come as a high surrogate followed by a low surrogate
+		if (!is_high_surrogate(static_cast<char16_t>(*itr))
+			|| end - itr < 2
+			|| !is_low_surrogate(static_cast<char16_t>(itr[1]))) {
+			return static_cast<size_t>(itr - begin);
+		}
+
+		itr += 2;
+	}
+
+	return std::basic_string_view<CharT>::npos;
+}
+
+template<typename CharT>
+size_t find_invalid_utf32(std::basic_string_view<CharT> in_string) {
+	for (size_t index = 0; index != in_string.size(); ++index) {
+		char32_t codepoint = static_cast<char32_t>(in_string[index]);
+		if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+			return index;
+		}
+	}
+
+	return std::basic_string_view<CharT>::npos;
+}
+
 } // namespace impl_unicode
 
+/**
+ * Finds the first invalid data unit in a string. Unlike decode_codepoint, this is strict: overlong UTF-8 sequences,
+ * unpaired surrogates, and codepoints past U+10FFFF are all invalid.
+ *
+ * @param in_string String to validate
+ * @return Index of the first data unit of the first invalid sequence, or npos if in_string is entirely valid
+ */
 template<typename InT>
-bool is_valid(const InT& in_string) {
+size_t find_invalid(const InT& in_string) {
 	using InCharT = typename impl_unicode::is_string<InT>::type;
 	using InViewT = std::basic_string_view<InCharT>;
+	using InEquivalentT = typename unicode_traits<std::remove_cv_t<InCharT>>::equivalent_type;
 
 	InViewT in_string_view = static_cast<InViewT>(in_string);
-	while (!in_string_view.empty()) {
-		decode_result string_front = decode_codepoint(in_string_view);
-		if (string_front.units == 0) {
-			return false;
-		}
-		in_string_view.remove_prefix(string_front.units);
+	if constexpr (sizeof(InEquivalentT) == 1) {
+		return impl_unicode::find_invalid_utf8(reinterpret_cast<const char8_t*>(in_string_view.data()), in_string_view.size());
+	}
+	else if constexpr (sizeof(InEquivalentT) == 2) {
+		return impl_unicode::find_invalid_utf16(in_string_view);
 	}
+	else {
+		return impl_unicode::find_invalid_utf32(in_string_view);
+	}
+}
 
-	return true;
+template<typename InT>
+bool is_valid(const InT& in_string) {
+	using InCharT = typename impl_unicode::is_string<InT>::type;
+	return find_invalid(in_string) == std::basic_string_view<InCharT>::npos;
 }
 
 /**
@@ -133,6 +347,189 @@ std::basic_string_view<OutCharT> string_view_cast(const InT& in_string) {
 	}
 }
 
+/**
+ * Upper bound on the number of data units needed to transcode a string; see transcode
+ *
+ * @tparam OutCharT Output character type
+ * @tparam InCharT Input character type
+ * @param in_length Length of the input string, in data units
+ * @return Maximum number of OutCharT units which transcoding in_length InCharT units may produce
+ */
+template<typename OutCharT, typename InCharT>
+constexpr size_t transcode_max_length(size_t in_length) {
+	if constexpr (sizeof(OutCharT) >= sizeof(InCharT)) {
+		// Each input unit produces at most one output unit (i.e: 4 UTF-8 units -> 2 UTF-16 units)
+		return in_length;
+	}
+	else if constexpr (sizeof(OutCharT) == 1 && sizeof(InCharT) == 2) {
+		// U+0800..U+FFFF: 1 UTF-16 unit -> 3 UTF-8 units
+		return in_length * 3;
+	}
+	else {
+		// 1 UTF-32 unit -> 4 UTF-8 units, or 2 UTF-16 units
+		return in_length * (4 / sizeof(OutCharT));
+	}
+}
+
+/**
+ * Counts the number of data units needed to transcode a string; see transcode
+ *
+ * @tparam OutCharT Output character type
+ * @param in_string String to be transcoded
+ * @return Number of OutCharT units needed; exact for valid data, except for UTF-16 surrogate pairs, which are
+ * over-counted when transcoding to UTF-8 or UTF-32
+ */
+template<typename OutCharT, typename InCharT>
+size_t transcode_length(std::basic_string_view<InCharT> in_string) {
+	using in_unit_type = std::make_unsigned_t<InCharT>;
+	size_t result = 0;
+	if constexpr (sizeof(InCharT) == sizeof(OutCharT)) {
+		result = in_string.size();
+	}
+	else if constexpr (sizeof(InCharT) == 1) {
+		// Every codepoint begins with a non-continuation byte; only 4-byte sequences need 2 UTF-16 units
+		constexpr uint64_t high_bits = 0x8080808080808080ULL;
+		const InCharT* itr = in_string.data();
+		const InCharT* end = itr + in_string.size();
+		while (end - itr >= 8) {
+			uint64_t word = impl_unicode::load_word(itr);
+			uint64_t counts = ((~word | (word << 1)) & high_bits) >> 7; // Anything but 10xxxxxx
+			if constexpr (sizeof(OutCharT) == 2) {
+				counts += (word & (word << 1) & (word << 2) & (word << 3) & high_bits) >> 7; // 1111xxxx
+			}
+			result += impl_unicode::sum_bytes(counts);
+			itr += 8;
+		}
+
+		in_string = { itr, static_cast<size_t>(end - itr) };
+		for (InCharT unit : in_string) {
+			in_unit_type value = static_cast<in_unit_type>(unit);
+			result += (value & 0xC0) != 0x80;
+			if constexpr (sizeof(OutCharT) == 2) {
+				result += value >= 0xF0;
+			}
+		}
+	}
+	else if constexpr (sizeof(OutCharT) == 1 || sizeof(InCharT) == 4) {
+		// UTF-16/32 -> UTF-8 or UTF-32 -> UTF-16; lone surrogates need 3 UTF-8 units, so each surrogate counts as 3
+		auto units_needed = [](InCharT in_unit) -> size_t {
+			in_unit_type value = static_cast<in_unit_type>(in_unit);
+			if constexpr (sizeof(OutCharT) == 1) {
+				return 1 + (value >= 0x80) + (value >= 0x800) + (sizeof(InCharT) == 4 && value >= 0x10000);
+			}
+			else {
+				return 1 + (value >= 0x10000);
+			}
+		};
+
+		// Sum fixed-size blocks, so that the compiler can vectorize it
+		constexpr size_t block_size = 8;
+		const InCharT* itr = in_string.data();
+		const InCharT* end = itr + in_string.size();
+		while (static_cast<size_t>(end - itr) >= block_size) {
+			for (size_t index = 0; index != block_size; ++index) {
+				result += units_needed(itr[index]);
+			}
+			itr += block_size;
+		}
+
+		for (; itr != end; ++itr) {
+			result += units_needed(*itr);
+		}
+	}
+	else {
+		// UTF-16 -> UTF-32; never more units than the input
+		result = in_string.size();
+	}
+
+	return result;
+}
+
+/**
+ * Transcodes a string into a preallocated buffer. Runs of codepoints which are encoded the same way in both encodings
+ * (ASCII, or U+0000..U+D7FF between UTF-16 & UTF-32) are copied in blocks, which compilers will vectorize.
+ *
+ * @tparam OutCharT Output character type
+ * @tparam InCharT Input character type
+ * @param out_buffer Buffer to write to; must have room for transcode_length<OutCharT>(in_string) data units (or
+ * transcode_max_length<OutCharT, InCharT>(in_string.size()))
+ * @param in_string String to transcode
+ * @return Number of data units written on success, npos if in_string contains invalid data
+ */
+template<typename OutCharT, typename InCharT>
+size_t transcode(OutCharT* out_buffer, std::basic_string_view<InCharT> in_string) {
+	using in_unit_type = std::make_unsigned_t<InCharT>;
+	constexpr size_t block_size = 8;
+	constexpr in_unit_type direct_limit = (sizeof(InCharT) == 1 || sizeof(OutCharT) == 1) ? 0x80 : 0xD800;
+
+	OutCharT* write_head = out_buffer;
+	const InCharT* itr = in_string.data();
+	const InCharT* end = itr + in_string.size();
+	while (itr != end) {
+		if (static_cast<in_unit_type>(*itr) < direct_limit) {
+			// Copy blocks of directly encodable units
+			while (static_cast<size_t>(end - itr) >= block_size) {
+				if constexpr (sizeof(InCharT) == 1) {
+					if ((impl_unicode::load_word(itr) & 0x8080808080808080ULL) != 0) {
+						break;
+					}
+				}
+				else {
+					in_unit_type block_max = 0;
+					for (size_t index = 0; index != block_size; ++index) {
+						block_max = std::max(block_max, static_cast<in_unit_type>(itr[index]));
+					}
+
+					if (block_max >= direct_limit) {
+						break;
+					}
+				}
+
+				for (size_t index = 0; index != block_size; ++index) {
+					write_head[index] = static_cast<OutCharT>(itr[index]);
+				}
+
+				itr += block_size;
+				write_head += block_size;
+			}
+
+			// Copy anything left over, up to the next codepoint which needs to be re-encoded
+			while (itr != end && static_cast<in_unit_type>(*itr) < direct_limit) {
+				*write_head = static_cast<OutCharT>(*itr);
+				++itr;
+				++write_head;
+			}
+
+			continue;
+		}
+
+		if constexpr (sizeof(InCharT) == 1) {
+			// Re-encode runs of 3-byte sequences (i.e: most CJK text) in place
+			while (end - itr >= 3 && (static_cast<in_unit_type>(*itr) & 0xF0) == 0xE0) {
+				char32_t codepoint = static_cast<char32_t>(itr[0] & 0x0F) << 12;
+				codepoint += static_cast<char32_t>(itr[1] & 0x3F) << 6;
+				codepoint += static_cast<char32_t>(itr[2] & 0x3F);
+				write_head += encode_codepoint(write_head, codepoint);
+				itr += 3;
+			}
+
+			if (itr == end || static_cast<in_unit_type>(*itr) < direct_limit) {
+				continue;
+			}
+		}
+
+		decode_result string_front = decode_codepoint(itr, end);
+		if (string_front.units == 0) {
+			return std::basic_string_view<OutCharT>::npos;
+		}
+
+		itr += string_front.units;
+		write_head += encode_codepoint(write_head, string_front.codepoint);
+	}
+
+	return static_cast<size_t>(write_head - out_buffer);
+}
+
 template<typename OutCharT, typename InT>
 std::basic_string<OutCharT> string_cast(const InT& in_string) {
 	static_assert(impl_unicode::is_string<InT>::value == true);
@@ -160,30 +557,64 @@ std::basic_string<OutCharT> string_cast(const InT& in_string) {
 	}
 	else {
 		// Last resort: reencode the string
-		std::basic_string<OutCharT> result;
 		InViewT in_string_view = static_cast<InViewT>(in_string);
-		if constexpr (sizeof(InCharT) <= sizeof(OutCharT)) {
-			// When copying to a larger type, we will need _at most_ as many elements as the smaller storage type
-			result.reserve(in_string_view.size());
-		}
-		else {
-			result.reserve(in_string_view.size() * (sizeof(OutCharT) / sizeof(InCharT)));
+		std::basic_string<OutCharT> result;
+		result.resize(transcode_length<OutCharT>(in_string_view));
+
+		size_t result_length = transcode(result.data(), in_string_view);
+		if (result_length == std::basic_string<OutCharT>::npos) {
+			return {};
 		}
 
-		while (!in_string_view.empty()) {
-			decode_result string_front = decode_codepoint(in_string_view);
-			if (string_front.units == 0) {
-				return {};
-			}
-			in_string_view.remove_prefix(string_front.units);
+		result.resize(result_length);
+		return result;
+	}
+}
 
-			encode_codepoint(result, string_front.codepoint);
+/** Multi-byte strings */
+
+namespace impl_unicode {
+
+enum class multibyte_encoding {
+	utf_8, // Multi-byte strings are UTF-8
+	ascii, // ASCII characters are encoded as themselves, but nothing else is known to be UTF-8 (i.e: "C" locale)
+	other
+};
+
+/**
+ * Identifies the multi-byte encoding of the current C locale (LC_CTYPE). Probing the locale takes a few hundred libc
+ * calls, so the result is cached until the locale's name changes.
+ *
+ * @return Multi-byte encoding in use by the C multi-byte conversion functions
+ */
+multibyte_encoding current_multibyte_encoding();
+
+template<typename CharT>
+bool is_ascii(std::basic_string_view<CharT> in_string) {
+	using unit_type = std::make_unsigned_t<CharT>;
+	const CharT* itr = in_string.data();
+	const CharT* end = itr + in_string.size();
+	unit_type combined = 0;
+	if constexpr (sizeof(CharT) == 1) {
+		uint64_t combined_words = 0;
+		for (; end - itr >= 8; itr += 8) {
+			combined_words |= load_word(itr);
 		}
 
-		return result;
+		if ((combined_words & 0x8080808080808080ULL) != 0) {
+			return false;
+		}
+	}
+
+	for (; itr != end; ++itr) {
+		combined |= static_cast<unit_type>(*itr);
 	}
+
+	return combined < 0x80;
 }
 
+} // namespace impl_unicode
+
 /**
  * Recodes a multi-byte string into a unicode-encoded string
  *
@@ -195,6 +626,17 @@ template<typename CharT>
 std::pair<bool, std::basic_string<CharT>> mbstring_to_ustring(std::string_view in_mbstring) {
 	std::pair<bool, std::basic_string<CharT>> result;
 
+	// UTF-8 (and ASCII in ASCII-compatible locales) is simply validated & transcoded, without going through libc
+	std::u8string_view u8_mbstring{ reinterpret_cast<const char8_t*>(in_mbstring.data()), in_mbstring.size() };
+	impl_unicode::multibyte_encoding encoding = impl_unicode::current_multibyte_encoding();
+	if ((encoding == impl_unicode::multibyte_encoding::utf_8 && is_valid(u8_mbstring))
+		|| (encoding == impl_unicode::multibyte_encoding::ascii && impl_unicode::is_ascii(u8_mbstring))) {
+		result.first = true;
+		result.second = string_cast<CharT>(u8_mbstring);
+		return result;
+	}
+
+	// Otherwise, recode through the locale one codepoint at a time
 	std::mbstate_t mbstate{};
 	while (!in_mbstring.empty()) {
 		char32_t codepoint{};
@@ -225,6 +667,17 @@ template<typename CharT>
 std::pair<bool, std::string> ustring_to_mbstring(std::basic_string_view<CharT> in_string) {
 	std::pair<bool, std::string> result;
 
+	// UTF-8 (and ASCII in ASCII-compatible locales) is simply validated & transcoded, without going through libc
+	impl_unicode::multibyte_encoding encoding = impl_unicode::current_multibyte_encoding();
+	if ((encoding == impl_unicode::multibyte_encoding::utf_8 && is_valid(in_string))
+		|| (encoding == impl_unicode::multibyte_encoding::ascii && impl_unicode::is_ascii(in_string))) {
+		result.first = true;
+		result.second.resize(transcode_length<char8_t>(in_string));
+		result.second.resize(transcode(reinterpret_cast<char8_t*>(result.second.data()), in_string));
+		return result;
+	}
+
+	// Otherwise, recode through the locale one codepoint at a time
 	std::mbstate_t mbstate{};
 	decode_result decode;
 	while ((decode = decode_codepoint(in_string)).units != 0) {
@@ -250,63 +703,172 @@ std::pair<bool, std::string> ustring_to_mbstring(const std::basic_string<CharT>&
 	return ustring_to_mbstring(std::basic_string_view<CharT>{ in_string });
 }
 
+namespace impl_unicode {
+
 /**
- * Searches a string for a specified substring
+ * Searches for a sequence of data units; since UTF-8 & UTF-16 are self-synchronizing, any match of a validly encoded
+ * substring starts at a codepoint boundary
  *
- * @tparam LhsCharT Character type of the string being searched
- * @tparam RhsCharT Character type of the substring being searched for
  * @param in_string String to search
- * @param in_substring Substring to search for
- * @return Character data index on success, npos otherwise
+ * @param in_substring Units to search for; must not be empty
+ * @return Index of the first match, or npos if there is none
  */
-template<typename LhsCharT, bool CaseSensitive = true>
-size_t find(std::basic_string_view<LhsCharT> in_string, char32_t in_codepoint) {
-	// If we don't have anything to search through, there's nothing to be found
-	if (in_string.empty()) {
-		return decltype(in_string)::npos;
+template<typename CharT>
+size_t find_units(std::basic_string_view<CharT> in_string, std::basic_string_view<CharT> in_substring) {
+	constexpr size_t min_horspool_length = 4; // Shorter patterns are found faster by first-unit filtering alone
+	const size_t pattern_length = in_substring.size();
+	if (pattern_length > in_string.size()) {
+		return std::basic_string_view<CharT>::npos;
 	}
 
-	if constexpr (!CaseSensitive) {
-		in_codepoint = fold(in_codepoint);
+	if (pattern_length < min_horspool_length) {
+		// Filters on the first unit (memchr for 1-byte units), then compares the rest
+		return in_string.find(in_substring);
 	}
 
-	size_t codepoints_removed{};
-	while (!in_string.empty()) {
-		std::basic_string_view<LhsCharT> string = in_string;
-		decode_result string_front = decode_codepoint(string);
+	// Boyer-Moore-Horspool; the skip table is indexed by each unit's low byte, so that it works for any unit size
+	size_t skip_table[256];
+	std::fill(std::begin(skip_table), std::end(skip_table), pattern_length);
+	for (size_t index = 0; index != pattern_length - 1; ++index) {
+		skip_table[unit_value(in_substring[index]) & 0xFF] = pattern_length - 1 - index;
+	}
 
-		if (string_front.units == 0) {
-			// Failed to decode front codepoint; bad unicode sequence
-			return decltype(in_string)::npos;
+	const CharT* data = in_string.data();
+	const CharT* pattern = in_substring.data();
+	const CharT last_unit = pattern[pattern_length - 1];
+	const size_t last_position = in_string.size() - pattern_length;
+	size_t position = 0;
+	while (position <= last_position) {
+		CharT unit = data[position + pattern_length - 1];
+		if (unit == last_unit
+			&& std::char_traits<CharT>::compare(data + position, pattern, pattern_length - 1) == 0) {
+			return position;
 		}
 
-		if constexpr (CaseSensitive) {
-			if (string_front.codepoint == in_codepoint) {
-				// Match found!
-				return codepoints_removed;
+		position += skip_table[unit_value(unit) & 0xFF];
+	}
+
+	return std::basic_string_view<CharT>::npos;
+}
+
+/**
+ * Searches for a sequence of folded codepoints, folding in_string as it's searched
+ *
+ * @param in_string String to search
+ * @param in_pattern Folded codepoints to search for; must not be empty
+ * @return Index of the first match, or npos if there is none
+ */
+template<typename CharT>
+size_t find_folded(std::basic_string_view<CharT> in_string, std::u32string_view in_pattern) {
+	constexpr uint64_t low_bits = 0x0101010101010101ULL;
+	constexpr uint64_t high_bits = 0x8080808080808080ULL;
+	const char32_t first = in_pattern.front();
+	const CharT* begin = in_string.data();
+	const CharT* end = begin + in_string.size();
+	const CharT* itr = begin;
+
+	// ASCII units can only start a match if they fold to first; matching letters ignoring 0x20 accepts either case
+	const bool first_is_letter = first >= U'a' && first <= U'z';
+	const uint64_t case_mask = first_is_letter ? 0x20 * low_bits : 0;
+	const uint64_t first_word = first < 0x80 ? first * low_bits : high_bits; // high_bits never matches an ASCII unit
+	while (itr != end) {
+		// Skip ASCII units which can't start a match; non-ASCII units are checked one codepoint at a time
+		if constexpr (sizeof(CharT) == 1) {
+			while (end - itr >= 8) {
+				uint64_t word = load_word(itr);
+				uint64_t difference = (word | case_mask) ^ first_word;
+				uint64_t candidates = mark_zero_bytes(difference) | (word & high_bits); // Matches, and non-ASCII
+				if (candidates != 0) {
+					itr += first_marked_byte(candidates);
+					break;
+				}
+
+				itr += 8;
 			}
 		}
-		else {
-			if (fold(string_front.codepoint) == in_codepoint) {
-				// Match found!
-				return codepoints_removed;
+
+		while (itr != end) {
+			uint32_t unit = unit_value(*itr);
+			if (unit >= 0x80 || fold_ascii(unit) == first) {
+				break;
+			}
+
+			++itr;
+		}
+
+		if (itr == end) {
+			break;
+		}
+
+		decode_result string_front = decode_codepoint(itr, end);
+		if (string_front.units == 0) {
+			// Invalid data never matches; skip it
+			++itr;
+			continue;
+		}
+
+		if (fold(string_front.codepoint) == first) {
+			// Check the rest of the pattern
+			const CharT* match_itr = itr + string_front.units;
+			std::u32string_view pattern = in_pattern.substr(1);
+			while (!pattern.empty() && match_itr != end) {
+				decode_result match_front = decode_codepoint(match_itr, end);
+				if (match_front.units == 0
+					|| fold(match_front.codepoint) != pattern.front()) {
+					break;
+				}
+
+				match_itr += match_front.units;
+				pattern.remove_prefix(1);
+			}
+
+			if (pattern.empty()) {
+				return static_cast<size_t>(itr - begin);
 			}
 		}
 
-		// Didn't find a match here; remove the front codepoint and try the next position
-		in_string.remove_prefix(string_front.units);
-		codepoints_removed += string_front.units;
+		itr += string_front.units;
 	}
 
-	// We reached the end of in_string before finding the prefix :(
-	return decltype(in_string)::npos;
+	return std::basic_string_view<CharT>::npos;
 }
 
+} // namespace impl_unicode
+
 /**
- * Searches a string for a specified substring
+ * Searches a string for a specified codepoint
+ *
+ * @tparam LhsCharT Character type of the string being searched
+ * @tparam CaseSensitive Whether or not to compare case-insensitively (using simple case folding)
+ * @param in_string String to search
+ * @param in_codepoint Codepoint to search for
+ * @return Character data index on success, npos otherwise
+ */
+template<typename LhsCharT, bool CaseSensitive = true>
+size_t find(std::basic_string_view<LhsCharT> in_string, char32_t in_codepoint) {
+	if constexpr (CaseSensitive) {
+		encode_buffer_type<LhsCharT> buffer{};
+		size_t units = encode_codepoint(buffer, in_codepoint);
+		if (units == 0) {
+			// Not a valid codepoint; can't possibly be found
+			return decltype(in_string)::npos;
+		}
+
+		return impl_unicode::find_units(in_string, std::basic_string_view<LhsCharT>{ buffer, units });
+	}
+	else {
+		char32_t folded = fold(in_codepoint);
+		return impl_unicode::find_folded(in_string, std::u32string_view{ &folded, 1 });
+	}
+}
+
+/**
+ * Searches a string for a specified substring. The substring is only decoded or folded once; case-sensitive searches
+ * then compare data units directly, skipping ahead with Boyer-Moore-Horspool. Invalid sequences in in_string never match.
  *
  * @tparam LhsCharT Character type of the string being searched
  * @tparam RhsCharT Character type of the substring being searched for
+ * @tparam CaseSensitive Whether or not to compare case-insensitively (using simple case folding)
  * @param in_string String to search
  * @param in_substring Substring to search for
  * @return Character data index on success, npos otherwise
@@ -323,67 +885,44 @@ size_t find(std::basic_string_view<LhsCharT> in_string, std::basic_string_view<R
 		return decltype(in_string)::npos;
 	}
 
-	// TODO: expand this to cover any instance where in_substring is a single codepoint, rather than a single data unit
-	if (in_substring.size() == 1) {
-		return find<LhsCharT, CaseSensitive>(in_string, in_substring[0]);
-	}
-
-	// TODO: optimize for when in_substring is small and of different type, by only decoding it once
-
-	size_t codepoints_removed{};
-	while (!in_string.empty()) {
-		// If in_string and in_prefix are the same type, compare their sizes and quickly return if in_string is too small
-		if constexpr (std::is_same_v<LhsCharT, RhsCharT>) {
-			if (in_string.size() < in_substring.size()) {
+	if constexpr (CaseSensitive) {
+		if constexpr (sizeof(LhsCharT) == sizeof(RhsCharT)) {
+			// Same encoding; search for in_substring's data as-is, so long as it's valid
+			if (find_invalid(in_substring) != decltype(in_substring)::npos) {
 				return decltype(in_string)::npos;
 			}
-		}
 
-		std::basic_string_view<LhsCharT> string = in_string;
-		std::basic_string_view<RhsCharT> substring = in_substring;
-		decode_result string_front;
-		do {
-			// TODO: optimize this for when in_string and in_substring are same type, by only decoding in_string, solely
-			// to determine number of data units to compare
-			string_front = decode_codepoint(string);
-			decode_result prefix_front = decode_codepoint(substring);
-
-			if (string_front.units == 0
-				|| prefix_front.units == 0) {
-				// Failed to decode front codepoint; bad unicode sequence
+			return impl_unicode::find_units(in_string,
+				std::basic_string_view<LhsCharT>{ reinterpret_cast<const LhsCharT*>(in_substring.data()), in_substring.size() });
+		}
+		else {
+			// Transcode in_substring once, then search for its data
+			auto substring = string_cast<LhsCharT>(in_substring);
+			if (substring.empty()) {
+				// in_substring isn't valid
 				return decltype(in_string)::npos;
 			}
 
-			if constexpr (CaseSensitive) {
-				if (string_front.codepoint != prefix_front.codepoint) {
-					// Codepoints aren't the same; break & try next position
-					break;
-				}
-			}
-			else {
-				if (!equalsi(string_front.codepoint, prefix_front.codepoint)) {
-					// Codepoints don't fold the same; break & try next position
-					break;
-				}
+			return impl_unicode::find_units(in_string, std::basic_string_view<LhsCharT>{ substring });
+		}
+	}
+	else {
+		// Fold in_substring once, then search for it
+		std::u32string pattern;
+		pattern.reserve(in_substring.size());
+		while (!in_substring.empty()) {
+			decode_result substring_front = decode_codepoint(in_substring);
+			if (substring_front.units == 0) {
+				// Failed to decode front codepoint; bad unicode sequence
+				return decltype(in_string)::npos;
 			}
 
-			// Codepoints are equal; trim off the fronts and continue
-			string.remove_prefix(string_front.units);
-			substring.remove_prefix(prefix_front.units);
-
-			if (substring.empty()) {
-				// We found the substring! We can return our current position
-				return codepoints_removed;
-			}
-		} while (!string.empty());
+			pattern += fold(substring_front.codepoint);
+			in_substring.remove_prefix(substring_front.units);
+		}
 
-		// Didn't find a match here; remove the front codepoint and try the next position
-		in_string.remove_prefix(string_front.units);
-		codepoints_removed += string_front.units;
+		return impl_unicode::find_folded(in_string, std::u32string_view{ pattern });
 	}
-
-	// We reached the end of in_string before finding the prefix :(
-	return decltype(in_string)::npos;
 }
 
 ADAPT_BASIC_STRING(find)
@@ -170,7 +170,9 @@ template<typename CharT>
 using encode_buffer_type = CharT[unicode_traits<CharT>::max_units_per_codepoint];
 
 /** single-unit helper utilities */
-char32_t fold(char32_t in_codepoint); // Folds codepoint for case-insensitive checks (not for human output)
+inline char32_t fold(char32_t in_codepoint); // Folds codepoint for case-insensitive checks (not for human output)
+constexpr size_t max_fold_full_length = 3;
+size_t fold_full(char32_t in_codepoint, char32_t* out_codepoints); // Full case folding (i.e: U+00DF -> "ss"); writes up to max_fold_full_length codepoints
 constexpr int as_base(char32_t in_character, unsigned int base); // The value represented by in_character in terms of base if valid, -1 otherwise
 
 /**
@@ -533,6 +535,25 @@ static constexpr unsigned char base_table[]{
 	127, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 127, 127, 127, 127, 127,
 };
 
+namespace impl_unicode {
+
+// Folds an ASCII letter to lowercase; the result is meaningless for non-ASCII units
+constexpr uint32_t fold_ascii(uint32_t in_unit) {
+	return in_unit | (static_cast<uint32_t>(in_unit - U'A' < 26) << 5);
+}
+
+char32_t fold_table(char32_t in_codepoint); // Table lookup for fold(); tables are generated from CaseFolding.txt
+
+} // namespace impl_unicode
+
+inline char32_t fold(char32_t in_codepoint) {
+	if (in_codepoint < 0x80) {
+		return static_cast<char32_t>(impl_unicode::fold_ascii(in_codepoint));
+	}
+
+	return impl_unicode::fold_table(in_codepoint);
+}
+
 // If we're already making two comparisons, what would the real impact be of a couple more and removing the lookup table?
 constexpr int as_base(char32_t in_character, unsigned int base) {
 	if (in_character >= sizeof(base_table)) {
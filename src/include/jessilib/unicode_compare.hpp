@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include "unicode_base.hpp"
 
 namespace jessilib {
@@ -41,6 +43,165 @@ namespace jessilib {
 	auto method(const std::basic_string<LhsCharT>& lhs, const std::basic_string<RhsCharT>& rhs) { \
 		return method(static_cast<std::basic_string_view<LhsCharT>>(lhs), static_cast<std::basic_string_view<RhsCharT>>(rhs)); }
 
+namespace impl_unicode {
+
+template<typename CharT>
+constexpr uint32_t unit_value(CharT in_unit) {
+	return static_cast<uint32_t>(static_cast<std::make_unsigned_t<CharT>>(in_unit));
+}
+
+/**
+ * Counts the leading units which are ASCII in both strings and equal. ASCII units are whole codepoints in every
+ * encoding, so comparison may resume codepoint-by-codepoint from the returned position.
+ *
+ * @tparam CaseInsensitiveV Whether to ignore the case of ASCII letters
+ * @param in_lhs First string to compare
+ * @param in_rhs Second string to compare against
+ * @param in_length Number of units to compare; must not exceed either string's length
+ * @return Number of leading units which are equal ASCII in both strings
+ */
+template<bool CaseInsensitiveV, typename LhsCharT, typename RhsCharT>
+size_t ascii_prefix_length(const LhsCharT* in_lhs, const RhsCharT* in_rhs, size_t in_length) {
+	// Zero if the units are equal
+	auto units_difference = [](uint32_t in_lhs_unit, uint32_t in_rhs_unit) {
+		if constexpr (CaseInsensitiveV) {
+			return fold_ascii(in_lhs_unit) ^ fold_ascii(in_rhs_unit);
+		}
+		else {
+			return in_lhs_unit ^ in_rhs_unit;
+		}
+	};
+
+	// Compare blocks of 8 units (8, 16, or 32 bytes) at a time, without branching per unit
+	constexpr size_t block_size = 8;
+	size_t index = 0;
+	if constexpr (sizeof(LhsCharT) == 1 && sizeof(RhsCharT) == 1) {
+		// Both UTF-8; compare as 64-bit words, folding all 8 bytes at once
+		constexpr uint64_t high_bits = 0x8080808080808080ULL;
+		auto fold_word = [](uint64_t in_word) {
+			if constexpr (CaseInsensitiveV) {
+				// High bit of each byte is set for 'A' through 'Z'; only valid for ASCII bytes
+				uint64_t upper = ((in_word + 0x3F3F3F3F3F3F3F3FULL) ^ (in_word + 0x2525252525252525ULL)) & high_bits;
+				return in_word | (upper >> 2);
+			}
+			else {
+				return in_word;
+			}
+		};
+
+		for (; in_length - index >= block_size; index += block_size) {
+			uint64_t lhs{};
+			uint64_t rhs{};
+			std::memcpy(&lhs, in_lhs + index, sizeof(lhs));
+			std::memcpy(&rhs, in_rhs + index, sizeof(rhs));
+			if (((lhs | rhs) & high_bits) != 0 || fold_word(lhs) != fold_word(rhs)) {
+				break;
+			}
+		}
+	}
+
+	for (; in_length - index >= block_size; index += block_size) {
+		uint32_t units = 0;
+		uint32_t difference = 0;
+		for (size_t offset = 0; offset != block_size; ++offset) {
+			uint32_t lhs = unit_value(in_lhs[index + offset]);
+			uint32_t rhs = unit_value(in_rhs[index + offset]);
+			units |= lhs | rhs;
+			difference |= units_difference(lhs, rhs);
+		}
+
+		if (units >= 0x80 || difference != 0) {
+			break;
+		}
+	}
+
+	// Finish off the last (partial or mismatched) block
+	for (; index != in_length; ++index) {
+		uint32_t lhs = unit_value(in_lhs[index]);
+		uint32_t rhs = unit_value(in_rhs[index]);
+		if ((lhs | rhs) >= 0x80 || units_difference(lhs, rhs) != 0) {
+			break;
+		}
+	}
+
+	return index;
+}
+
+/**
+ * FNV-1a based hash of a string's codepoints, such that the same text hashes the same regardless of encoding. Codepoints
+ * are 21 bits, so they're packed 3 to a word for each round, to shorten the chain of multiplications.
+ *
+ * @tparam FoldV Whether to fold codepoints before hashing them (for case-insensitive hashes)
+ * @param in_data Start of the string to hash
+ * @param in_end End of the string to hash
+ * @return Hash of all codepoints up to in_end, or up to the first invalid sequence
+ */
+template<bool FoldV, typename CharT>
+uint64_t hash_codepoints(const CharT* in_data, const CharT* in_end) {
+	constexpr uint64_t fnv_offset_basis = 14695981039346656037ULL;
+	constexpr uint64_t fnv_prime = 1099511628211ULL;
+	constexpr size_t codepoint_bits = 21;
+	constexpr size_t codepoints_per_word = 3;
+	constexpr size_t block_size = codepoints_per_word * 2; // Units per ASCII block; 2 words
+
+	auto ascii_codepoint = [](CharT in_unit) -> uint64_t {
+		if constexpr (FoldV) {
+			return fold_ascii(unit_value(in_unit));
+		}
+		else {
+			return unit_value(in_unit);
+		}
+	};
+
+	// Packs 3 ASCII units into a word
+	auto ascii_word = [&ascii_codepoint](const CharT* in_units) {
+		return ascii_codepoint(in_units[0])
+			| (ascii_codepoint(in_units[1]) << codepoint_bits)
+			| (ascii_codepoint(in_units[2]) << (codepoint_bits * 2));
+	};
+
+	uint64_t hash = fnv_offset_basis;
+	uint64_t word = 0;
+	size_t word_size = 0;
+	while (in_data != in_end) {
+		// ASCII fast path; check a block of units at once, then hash them as whole words without decoding
+		if (word_size == 0 && static_cast<size_t>(in_end - in_data) >= block_size) {
+			uint32_t units = unit_value(in_data[0]) | unit_value(in_data[1]) | unit_value(in_data[2])
+				| unit_value(in_data[3]) | unit_value(in_data[4]) | unit_value(in_data[5]);
+			if (units < 0x80) {
+				hash = (hash ^ ascii_word(in_data)) * fnv_prime;
+				hash = (hash ^ ascii_word(in_data + codepoints_per_word)) * fnv_prime;
+				in_data += block_size;
+				continue;
+			}
+		}
+
+		decode_result decode = decode_codepoint(in_data, in_end);
+		if (decode.units == 0) {
+			break;
+		}
+
+		if constexpr (FoldV) {
+			decode.codepoint = fold(decode.codepoint);
+		}
+
+		word |= static_cast<uint64_t>(decode.codepoint) << (codepoint_bits * word_size);
+		if (++word_size == codepoints_per_word) {
+			hash = (hash ^ word) * fnv_prime;
+			word = 0;
+			word_size = 0;
+		}
+
+		in_data += decode.units;
+	}
+
+	// Mix in the remaining partial word & its size, then fold the high bits (which see the most mixing) down
+	hash = (hash ^ word ^ (static_cast<uint64_t>(word_size) << 62)) * fnv_prime;
+	return hash ^ (hash >> 32);
+}
+
+} // namespace impl_unicode
+
 /**
  * Checks if two strings are equal
  *
@@ -57,6 +218,10 @@ bool equals(std::basic_string_view<LhsCharT> lhs, std::basic_string_view<RhsChar
 		return lhs == rhs;
 	}
 
+	size_t ascii_length = impl_unicode::ascii_prefix_length<false>(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+	lhs.remove_prefix(ascii_length);
+	rhs.remove_prefix(ascii_length);
+
 	while (!lhs.empty() && !rhs.empty()) {
 		auto lhs_front = decode_codepoint(lhs);
 		auto rhs_front = decode_codepoint(rhs);
@@ -100,6 +265,10 @@ bool equalsi(std::basic_string_view<LhsCharT> lhs, std::basic_string_view<RhsCha
 		}
 	}
 
+	size_t ascii_length = impl_unicode::ascii_prefix_length<true>(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+	lhs.remove_prefix(ascii_length);
+	rhs.remove_prefix(ascii_length);
+
 	while (!lhs.empty() && !rhs.empty()) {
 		auto lhs_front = decode_codepoint(lhs);
 		auto rhs_front = decode_codepoint(rhs);
@@ -143,7 +312,11 @@ size_t starts_with_length(std::basic_string_view<LhsCharT> in_string, std::basic
 		}
 	}
 
-	size_t codepoints_removed{};
+	size_t codepoints_removed = impl_unicode::ascii_prefix_length<false>(in_string.data(), in_prefix.data(),
+		std::min(in_string.size(), in_prefix.size()));
+	in_string.remove_prefix(codepoints_removed);
+	in_prefix.remove_prefix(codepoints_removed);
+
 	while (!in_string.empty() && !in_prefix.empty()) {
 		decode_result string_front = decode_codepoint(in_string);
 		decode_result prefix_front = decode_codepoint(in_prefix);
@@ -193,7 +366,11 @@ size_t starts_with_lengthi(std::basic_string_view<LhsCharT> in_string, std::basi
 		}
 	}
 
-	size_t codepoints_removed{};
+	size_t codepoints_removed = impl_unicode::ascii_prefix_length<true>(in_string.data(), in_prefix.data(),
+		std::min(in_string.size(), in_prefix.size()));
+	in_string.remove_prefix(codepoints_removed);
+	in_prefix.remove_prefix(codepoints_removed);
+
 	while (!in_string.empty() && !in_prefix.empty()) {
 		decode_result string_front = decode_codepoint(in_string);
 		decode_result prefix_front = decode_codepoint(in_prefix);
@@ -268,21 +445,7 @@ struct text_hash {
 
 	template<typename CharT>
 	static uint64_t hash(const CharT* data, const CharT* end) {
-		uint64_t hash = 14695981039346656037ULL;
-
-		decode_result decode;
-		while (data != end) {
-			decode = decode_codepoint(data, end);
-			if (decode.units == 0) {
-				return hash;
-			}
-
-			hash = hash ^ decode.codepoint;
-			hash = hash * 1099511628211ULL;
-			data += decode.units;
-		}
-
-		return hash;
+		return impl_unicode::hash_codepoints<false>(data, end);
 	}
 
 #ifdef JESSILIB_CHAR_AS_UTF8
@@ -320,15 +483,14 @@ struct text_hash {
 	}
 };
 
+// Transparent equality partner for text_hash; i.e: std::unordered_map<std::u8string, T, text_hash, text_equal>
 struct text_equal {
 	using is_transparent = std::true_type;
 
-#ifdef JESSILIB_CHAR_AS_UTF8
 	template<typename LhsCharT, typename RhsCharT>
 	bool operator()(std::basic_string_view<LhsCharT> in_lhs, std::basic_string_view<RhsCharT> in_rhs) const noexcept {
 		return equals<LhsCharT, RhsCharT>(in_lhs, in_rhs);
 	}
-#endif // JESSILIB_CHAR_AS_UTF8
 
 	template<typename LhsCharT, typename RhsCharT>
 	bool operator()(std::basic_string_view<LhsCharT> in_lhs, const std::basic_string<RhsCharT>& in_rhs) const noexcept {
@@ -357,21 +519,7 @@ struct text_hashi {
 
 	template<typename CharT>
 	static uint64_t hash(const CharT* data, const CharT* end) {
-		uint64_t hash = 14695981039346656037ULL;
-
-		decode_result decode;
-		while (data != end) {
-			decode = decode_codepoint(data, end - data);
-			if (decode.units == 0) {
-				return hash;
-			}
-
-			hash = hash ^ fold(decode.codepoint);
-			hash = hash * 1099511628211ULL;
-			data += decode.units;
-		}
-
-		return hash;
+		return impl_unicode::hash_codepoints<true>(data, end);
 	}
 
 #ifdef JESSILIB_CHAR_AS_UTF8
@@ -409,15 +557,14 @@ struct text_hashi {
 	}
 };
 
+// Transparent equality partner for text_hashi; i.e: std::unordered_map<std::u8string, T, text_hashi, text_equali>
 struct text_equali {
 	using is_transparent = std::true_type;
 
-#ifdef JESSILIB_CHAR_AS_UTF8
 	template<typename LhsCharT, typename RhsCharT>
 	bool operator()(std::basic_string_view<LhsCharT> in_lhs, std::basic_string_view<RhsCharT> in_rhs) const noexcept {
 		return equalsi<LhsCharT, RhsCharT>(in_lhs, in_rhs);
 	}
-#endif // JESSILIB_CHAR_AS_UTF8
 
 	template<typename LhsCharT, typename RhsCharT>
 	bool operator()(std::basic_string_view<LhsCharT> in_lhs, const std::basic_string<RhsCharT>& in_rhs) const noexcept {
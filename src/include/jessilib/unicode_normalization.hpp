@@ -0,0 +1,427 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+/**
+ * @file unicode_normalization.hpp
+ * @author Jessica James
+ *
+ * Unicode normalization (NFC, NFD, NFKC, NFKD), and normalization-aware comparison & hashing. Tables are generated from
+ * Unicode Character Database properties at build time.
+ */
+
+#pragma once
+
+#include "unicode.hpp"
+
+namespace jessilib {
+
+enum class normalization_form {
+	nfc, // Canonical decomposition, followed by canonical composition
+	nfd, // Canonical decomposition
+	nfkc, // Compatibility decomposition, followed by canonical composition
+	nfkd // Compatibility decomposition
+};
+
+enum class quick_check_result {
+	yes, // Definitely normalized
+	no, // Definitely not normalized
+	maybe // Might be normalized; only normalizing will tell
+};
+
+uint8_t combining_class(char32_t in_codepoint); // Canonical combining class; 0 for starters
+
+namespace impl_unicode {
+
+constexpr size_t max_decomposition_length = 18; // Longest full decomposition of a single codepoint (U+FDFA)
+
+// Canonical combining class in the low byte, quick check values (2 bits per normalization_form) in the next byte
+uint32_t normalization_properties(char32_t in_codepoint);
+
+// Writes the full decomposition of in_codepoint to out_codepoints; returns number of codepoints written
+size_t decompose(char32_t in_codepoint, bool in_compatibility, char32_t* out_codepoints);
+
+// Puts decomposed codepoints into canonical order, and then canonically composes them if in_compose is set
+void reorder(std::u32string& inout_codepoints, bool in_compose);
+
+inline quick_check_result quick_check_value(uint32_t in_properties, normalization_form in_form) {
+	return static_cast<quick_check_result>((in_properties >> (8 + static_cast<uint32_t>(in_form) * 2)) & 0x3);
+}
+
+/**
+ * Quick checks a string for normalization, in a single pass and without allocating
+ *
+ * @param in_string String to check
+ * @param in_form Normalization form to check for
+ * @param out_stable_length Length of a prefix of in_string which normalization leaves untouched
+ * @return yes if in_string is normalized, no if not (or if in_string is not valid), maybe if it can't be quickly told
+ */
+template<typename CharT>
+quick_check_result quick_check(std::basic_string_view<CharT> in_string, normalization_form in_form, size_t& out_stable_length) {
+	const CharT* begin = in_string.data();
+	const CharT* end = begin + in_string.size();
+	const CharT* itr = begin;
+	const CharT* stable_end = begin; // Start of the last starter which is normalized on its own
+	quick_check_result result = quick_check_result::yes;
+	uint32_t last_combining_class = 0;
+
+	// The stable length is fixed by whatever is found first; a maybe, or a no
+	auto fail = [&]() {
+		if (result == quick_check_result::yes) {
+			out_stable_length = static_cast<size_t>(stable_end - begin);
+		}
+		return quick_check_result::no;
+	};
+
+	while (itr != end) {
+		// ASCII fast path; ASCII codepoints are starters, without any decomposition
+		if constexpr (sizeof(CharT) == 1) {
+			while (end - itr >= 8 && (load_word(itr) & 0x8080808080808080ULL) == 0) {
+				itr += 8;
+				stable_end = itr - 1;
+				last_combining_class = 0;
+			}
+
+			if (itr == end) {
+				break;
+			}
+		}
+
+		if (unit_value(*itr) < 0x80) {
+			stable_end = itr;
+			last_combining_class = 0;
+			++itr;
+			continue;
+		}
+
+		decode_result decode = decode_codepoint(itr, end);
+		if (decode.units == 0) {
+			return fail();
+		}
+
+		uint32_t properties = normalization_properties(decode.codepoint);
+		uint32_t combining_class = properties & 0xFF;
+		quick_check_result check = quick_check_value(properties, in_form);
+		if (check == quick_check_result::no
+			|| (combining_class != 0 && last_combining_class > combining_class)) {
+			return fail();
+		}
+
+		if (check == quick_check_result::maybe) {
+			if (result == quick_check_result::yes) {
+				out_stable_length = static_cast<size_t>(stable_end - begin);
+			}
+			result = quick_check_result::maybe;
+		}
+		else if (combining_class == 0 && result == quick_check_result::yes) {
+			stable_end = itr;
+		}
+
+		last_combining_class = combining_class;
+		itr += decode.units;
+	}
+
+	if (result == quick_check_result::yes) {
+		out_stable_length = in_string.size();
+	}
+
+	return result;
+}
+
+// Checks if both a string and its simple case folding quick check as NFC; if so, the folded string is also NFC
+template<typename CharT>
+bool quick_check_folded(std::basic_string_view<CharT> in_string) {
+	uint32_t last_combining_class = 0;
+	while (!in_string.empty()) {
+		if (unit_value(in_string.front()) < 0x80) {
+			last_combining_class = 0;
+			in_string.remove_prefix(1);
+			continue;
+		}
+
+		decode_result decode = decode_codepoint(in_string);
+		if (decode.units == 0) {
+			return false;
+		}
+
+		uint32_t properties = normalization_properties(decode.codepoint);
+		char32_t folded = fold(decode.codepoint);
+		uint32_t folded_properties = folded == decode.codepoint ? properties : normalization_properties(folded);
+		uint32_t combining_class = folded_properties & 0xFF;
+		if (quick_check_value(properties, normalization_form::nfc) != quick_check_result::yes
+			|| quick_check_value(folded_properties, normalization_form::nfc) != quick_check_result::yes
+			|| (combining_class != 0 && last_combining_class > combining_class)) {
+			return false;
+		}
+
+		last_combining_class = combining_class;
+		in_string.remove_prefix(decode.units);
+	}
+
+	return true;
+}
+
+// Decomposes a string & appends it to out_codepoints, without reordering; returns false if in_string is not valid
+template<typename CharT>
+bool append_decomposed(std::basic_string_view<CharT> in_string, bool in_compatibility, std::u32string& out_codepoints) {
+	char32_t buffer[max_decomposition_length];
+	out_codepoints.reserve(out_codepoints.size() + in_string.size());
+	while (!in_string.empty()) {
+		decode_result decode = decode_codepoint(in_string);
+		if (decode.units == 0) {
+			return false;
+		}
+
+		if (decode.codepoint < 0x80) {
+			out_codepoints += decode.codepoint;
+		}
+		else {
+			out_codepoints.append(buffer, decompose(decode.codepoint, in_compatibility, buffer));
+		}
+
+		in_string.remove_prefix(decode.units);
+	}
+
+	return true;
+}
+
+/**
+ * Builds the key which normalization-aware comparisons & hashes operate on: NFC, or NFC of the simple case folding of
+ * NFC if FoldV is set
+ *
+ * @param in_string String to build key from
+ * @param out_key Codepoints of the key
+ * @return True on success, false if in_string is not valid
+ */
+template<bool FoldV, typename CharT>
+bool normalized_key(std::basic_string_view<CharT> in_string, std::u32string& out_key) {
+	if (!append_decomposed(in_string, false, out_key)) {
+		return false;
+	}
+	reorder(out_key, true);
+
+	if constexpr (FoldV) {
+		for (char32_t& codepoint : out_key) {
+			codepoint = fold(codepoint);
+		}
+
+		std::u32string folded;
+		append_decomposed(std::u32string_view{ out_key }, false, folded);
+		reorder(folded, true);
+		out_key = std::move(folded);
+	}
+
+	return true;
+}
+
+} // namespace impl_unicode
+
+/**
+ * Quick checks a string for normalization, in a single pass and without allocating; the vast majority of text in the
+ * wild quick checks as yes for NFC
+ *
+ * @param in_string String to check
+ * @param in_form Normalization form to check for
+ * @return yes if in_string is normalized, no if not (or if in_string is not valid), maybe if it can't be quickly told
+ */
+template<typename CharT>
+quick_check_result quick_check(std::basic_string_view<CharT> in_string, normalization_form in_form = normalization_form::nfc) {
+	size_t stable_length;
+	return impl_unicode::quick_check(in_string, in_form, stable_length);
+}
+
+/**
+ * Normalizes a string; only the portion after the first codepoint which fails the quick check is processed
+ *
+ * @param in_string String to normalize
+ * @param in_form Normalization form to normalize to
+ * @return in_string in normalization form in_form, or an empty string if in_string is not valid
+ */
+template<typename CharT>
+std::basic_string<CharT> normalize(std::basic_string_view<CharT> in_string, normalization_form in_form = normalization_form::nfc) {
+	size_t stable_length;
+	if (impl_unicode::quick_check(in_string, in_form, stable_length) == quick_check_result::yes) {
+		return std::basic_string<CharT>{ in_string };
+	}
+
+	std::u32string codepoints;
+	bool compatibility = in_form == normalization_form::nfkc || in_form == normalization_form::nfkd;
+	if (!impl_unicode::append_decomposed(in_string.substr(stable_length), compatibility, codepoints)) {
+		return {};
+	}
+	impl_unicode::reorder(codepoints, in_form == normalization_form::nfc || in_form == normalization_form::nfkc);
+
+	std::basic_string<CharT> result{ in_string.substr(0, stable_length) };
+	std::u32string_view codepoints_view{ codepoints };
+	result.resize(stable_length + transcode_length<CharT>(codepoints_view));
+	result.resize(stable_length + transcode(result.data() + stable_length, codepoints_view));
+	return result;
+}
+
+template<typename CharT>
+std::basic_string<CharT> normalize(const std::basic_string<CharT>& in_string, normalization_form in_form = normalization_form::nfc) {
+	return normalize(std::basic_string_view<CharT>{ in_string }, in_form);
+}
+
+/**
+ * Checks if a string is normalized
+ *
+ * @param in_string String to check
+ * @param in_form Normalization form to check for
+ * @return True if in_string is valid and in normalization form in_form, false otherwise
+ */
+template<typename CharT>
+bool is_normalized(std::basic_string_view<CharT> in_string, normalization_form in_form = normalization_form::nfc) {
+	switch (quick_check(in_string, in_form)) {
+		case quick_check_result::yes:
+			return true;
+
+		case quick_check_result::no:
+			return false;
+
+		default:
+			return normalize(in_string, in_form) == in_string;
+	}
+}
+
+/**
+ * Checks if two strings are canonically equivalent; i.e: precomposed & decomposed forms compare equal
+ *
+ * @param lhs First string to compare
+ * @param rhs Second string to compare against
+ * @return True if the strings are valid and canonically equivalent, false otherwise
+ */
+template<typename LhsCharT, typename RhsCharT>
+bool equals_normalized(std::basic_string_view<LhsCharT> lhs, std::basic_string_view<RhsCharT> rhs) {
+	if (quick_check(lhs) == quick_check_result::yes
+		&& quick_check(rhs) == quick_check_result::yes) {
+		return equals(lhs, rhs);
+	}
+
+	std::u32string lhs_key, rhs_key;
+	return impl_unicode::normalized_key<false>(lhs, lhs_key)
+		&& impl_unicode::normalized_key<false>(rhs, rhs_key)
+		&& lhs_key == rhs_key;
+}
+
+ADAPT_BASIC_STRING(equals_normalized)
+
+/**
+ * Checks if two strings are canonically equivalent, ignoring case (NFC of the simple case folding of NFC)
+ *
+ * @param lhs First string to compare
+ * @param rhs Second string to compare against
+ * @return True if the strings are valid and canonically equivalent when case-folded, false otherwise
+ */
+template<typename LhsCharT, typename RhsCharT>
+bool equalsi_normalized(std::basic_string_view<LhsCharT> lhs, std::basic_string_view<RhsCharT> rhs) {
+	// equalsi rejects same-type strings of differing lengths, which folding may equate (i.e: U+017F & 's')
+	if ((!std::is_same_v<LhsCharT, RhsCharT> || lhs.size() == rhs.size())
+		&& impl_unicode::quick_check_folded(lhs)
+		&& impl_unicode::quick_check_folded(rhs)) {
+		return equalsi(lhs, rhs);
+	}
+
+	std::u32string lhs_key, rhs_key;
+	return impl_unicode::normalized_key<true>(lhs, lhs_key)
+		&& impl_unicode::normalized_key<true>(rhs, rhs_key)
+		&& lhs_key == rhs_key;
+}
+
+ADAPT_BASIC_STRING(equalsi_normalized)
+
+/**
+ * Hashing & equality for normalization-aware unordered containers; keys which are canonically equivalent hash equal.
+ * i.e: std::unordered_map<std::u8string, T, text_hash_normalized, text_equal_normalized>
+ */
+
+template<bool FoldV>
+struct text_hash_normalized_base {
+	using is_transparent = std::true_type;
+
+	template<typename CharT>
+	static uint64_t hash(std::basic_string_view<CharT> in_key) {
+		bool stable;
+		if constexpr (FoldV) {
+			stable = impl_unicode::quick_check_folded(in_key);
+		}
+		else {
+			stable = quick_check(in_key) == quick_check_result::yes;
+		}
+
+		if (stable) {
+			// Key is the string itself (or its folding)
+			return impl_unicode::hash_codepoints<FoldV>(in_key.data(), in_key.data() + in_key.size());
+		}
+
+		std::u32string key;
+		impl_unicode::normalized_key<FoldV>(in_key, key);
+		return impl_unicode::hash_codepoints<false>(key.data(), key.data() + key.size());
+	}
+
+	template<typename CharT>
+	auto operator()(std::basic_string_view<CharT> in_key) const noexcept {
+		return hash(in_key);
+	}
+
+	template<typename CharT>
+	auto operator()(const std::basic_string<CharT>& in_key) const noexcept {
+		return hash(std::basic_string_view<CharT>{ in_key });
+	}
+};
+
+template<bool FoldV>
+struct text_equal_normalized_base {
+	using is_transparent = std::true_type;
+
+	template<typename LhsCharT, typename RhsCharT>
+	static bool equal(std::basic_string_view<LhsCharT> in_lhs, std::basic_string_view<RhsCharT> in_rhs) {
+		if constexpr (FoldV) {
+			return equalsi_normalized(in_lhs, in_rhs);
+		}
+		else {
+			return equals_normalized(in_lhs, in_rhs);
+		}
+	}
+
+	template<typename LhsCharT, typename RhsCharT>
+	bool operator()(std::basic_string_view<LhsCharT> in_lhs, std::basic_string_view<RhsCharT> in_rhs) const noexcept {
+		return equal(in_lhs, in_rhs);
+	}
+
+	template<typename LhsCharT, typename RhsCharT>
+	bool operator()(std::basic_string_view<LhsCharT> in_lhs, const std::basic_string<RhsCharT>& in_rhs) const noexcept {
+		return equal(in_lhs, std::basic_string_view<RhsCharT>{ in_rhs });
+	}
+
+	template<typename LhsCharT, typename RhsCharT>
+	bool operator()(const std::basic_string<LhsCharT>& in_lhs, std::basic_string_view<RhsCharT> in_rhs) const noexcept {
+		return equal(std::basic_string_view<LhsCharT>{ in_lhs }, in_rhs);
+	}
+
+	template<typename LhsCharT, typename RhsCharT>
+	bool operator()(const std::basic_string<LhsCharT>& in_lhs, const std::basic_string<RhsCharT>& in_rhs) const noexcept {
+		return equal(std::basic_string_view<LhsCharT>{ in_lhs }, std::basic_string_view<RhsCharT>{ in_rhs });
+	}
+};
+
+using text_hash_normalized = text_hash_normalized_base<false>;
+using text_hashi_normalized = text_hash_normalized_base<true>;
+using text_equal_normalized = text_equal_normalized_base<false>;
+using text_equali_normalized = text_equal_normalized_base<true>;
+
+} // namespace jessilib
@@ -25,8 +25,9 @@
 
 #pragma once
 
-#include "unicode_base.hpp"
+#include "unicode_syntax.hpp"
 #include <algorithm>
+#include <array>
 
 namespace jessilib {
 
@@ -70,8 +71,8 @@ constexpr bool is_sorted() {
 // Checks whether or not an escape tree consists solely of ASCII / Basic Latin; NOTE: DOES NOT RECURSE
 template<typename CharT, const shrink_sequence_tree<CharT> TreeBegin, size_t TreeSize>
 constexpr bool is_simple() {
-	// This was going to be used to slightly optimized the searching, until it was realized:
-	// 1) How small the trees are, making the searches require at most maybe 4 checks in most cases
+	// Lookups within these trees are cheap regardless (they're tiny); what this enables is skipping over every unit which
+	// can't begin a sequence, without decoding it (see apply_shrink_sequence_tree)
 	static_assert(is_sorted<CharT, TreeBegin, TreeSize>(), "Tree must be pre-sorted");
 	if constexpr (TreeSize == 0) {
 		return true;
@@ -80,22 +81,18 @@ constexpr bool is_simple() {
 	return TreeBegin[TreeSize - 1].first <= 0x7F;
 }
 
-// Only use for ASTs where each character process is guaranteed to write at most 1 character for each character consumed
-template<typename CharT, const shrink_sequence_tree<CharT> SequenceTreeBegin, size_t SequenceTreeSize>
-constexpr bool apply_shrink_sequence_tree(std::basic_string<CharT>& inout_string) {
-	if (inout_string.empty()) {
-		// Nothing to parse
-		return true;
-	}
+namespace impl_unicode {
 
+// Decodes & dispatches one codepoint at a time; works for any tree
+template<typename CharT, const shrink_sequence_tree<CharT> SequenceTreeBegin, size_t SequenceTreeSize>
+constexpr bool apply_shrink_sequence_tree_codepoints(std::basic_string<CharT>& inout_string) {
 	std::basic_string_view<CharT> read_view = inout_string;
 	CharT* write_head = inout_string.data();
 	decode_result decode;
 
-	constexpr auto SubTreeEnd = SequenceTreeBegin + SequenceTreeSize;
 	while ((decode = decode_codepoint(read_view)).units != 0) {
-		auto parser = std::lower_bound(SequenceTreeBegin, SubTreeEnd, decode.codepoint, &shrink_tree_member_compare<CharT>);
-		if (parser == SubTreeEnd || parser->first != decode.codepoint) {
+		auto parser = find_tree_member<shrink_sequence_tree_member<CharT>, SequenceTreeBegin, SequenceTreeSize>(decode.codepoint);
+		if (parser == nullptr) {
 			// Just a normal character; write it over
 			while (decode.units != 0) {
 				*write_head = read_view.front();
@@ -123,6 +120,142 @@ constexpr bool apply_shrink_sequence_tree(std::basic_string<CharT>& inout_string
 	return true;
 }
 
+/**
+ * Finds the next unit which could begin a sequence in a simple tree (see is_simple). Since every trigger is ASCII, only
+ * a unit equal to one can begin a sequence; UTF-8 also stops at anything non-ASCII, which must be decoded to find
+ * where it ends.
+ *
+ * @param in_begin Start of the string to search
+ * @param in_end End of the string to search
+ * @return Pointer to the first trigger (or non-ASCII UTF-8 unit), or in_end if there is none
+ */
+template<typename CharT, const shrink_sequence_tree<CharT> TreeBegin, size_t TreeSize>
+const CharT* find_shrink_trigger(const CharT* in_begin, const CharT* in_end) {
+	using unit_type = std::make_unsigned_t<CharT>;
+	constexpr size_t block_size = 8;
+	const CharT* itr = in_begin;
+	if constexpr (sizeof(CharT) == 1) {
+		// Check 8 units at a time; a byte of (word ^ trigger) is zero wherever it matches the trigger
+		constexpr uint64_t low_bits = 0x0101010101010101ULL;
+		constexpr uint64_t high_bits = low_bits * 0x80;
+		while (in_end - itr >= static_cast<ptrdiff_t>(block_size)) {
+			uint64_t word = load_word(itr);
+			uint64_t stops = word & high_bits;
+			for (size_t index = 0; index != TreeSize; ++index) {
+				stops |= mark_zero_bytes(word ^ (low_bits * TreeBegin[index].first));
+			}
+
+			if (stops != 0) {
+				return itr + first_marked_byte(stops);
+			}
+
+			itr += block_size;
+		}
+	}
+	else {
+		// Check blocks without exiting early, so that compilers can vectorize it
+		while (in_end - itr >= static_cast<ptrdiff_t>(block_size)) {
+			bool found = false;
+			for (size_t unit_index = 0; unit_index != block_size; ++unit_index) {
+				for (size_t index = 0; index != TreeSize; ++index) {
+					found |= static_cast<unit_type>(itr[unit_index]) == TreeBegin[index].first;
+				}
+			}
+
+			if (found) {
+				break;
+			}
+
+			itr += block_size;
+		}
+	}
+
+	for (; itr != in_end; ++itr) {
+		unit_type unit = static_cast<unit_type>(*itr);
+		if (sizeof(CharT) == 1 && unit >= 0x80) {
+			return itr;
+		}
+
+		for (size_t index = 0; index != TreeSize; ++index) {
+			if (unit == TreeBegin[index].first) {
+				return itr;
+			}
+		}
+	}
+
+	return in_end;
+}
+
+// Jumps between triggers, moving the untouched runs in between all at once; only for simple trees (see is_simple)
+template<typename CharT, const shrink_sequence_tree<CharT> SequenceTreeBegin, size_t SequenceTreeSize>
+bool apply_shrink_sequence_tree_runs(std::basic_string<CharT>& inout_string) {
+	static_assert(is_simple<CharT, SequenceTreeBegin, SequenceTreeSize>(), "Tree must be simple");
+	CharT* write_head = inout_string.data();
+	const CharT* itr = inout_string.data();
+	const CharT* end = itr + inout_string.size();
+
+	while (itr != end) {
+		const CharT* run_end = find_shrink_trigger<CharT, SequenceTreeBegin, SequenceTreeSize>(itr, end);
+		size_t run_length = run_end - itr;
+		if (write_head != itr) {
+			std::char_traits<CharT>::move(write_head, itr, run_length);
+		}
+		write_head += run_length;
+		itr = run_end;
+		if (itr == end) {
+			break;
+		}
+
+		decode_result decode = decode_codepoint(itr, static_cast<size_t>(end - itr));
+		if (decode.units == 0) {
+			// Invalid data; strip it off along with the rest of the string, same as apply_shrink_sequence_tree_codepoints
+			break;
+		}
+
+		auto parser = find_tree_member<shrink_sequence_tree_member<CharT>, SequenceTreeBegin, SequenceTreeSize>(decode.codepoint);
+		if (parser == nullptr) {
+			// Just a non-ASCII UTF-8 character; write it over
+			std::char_traits<CharT>::move(write_head, itr, decode.units);
+			write_head += decode.units;
+			itr += decode.units;
+			continue;
+		}
+
+		// This is a parsed sequence; pass it to the parser instead
+		std::basic_string_view<CharT> read_view{ itr + decode.units, static_cast<size_t>(end - itr) - decode.units };
+		if (!(parser->second)(write_head, read_view)) {
+			// Bad input received; strip off whatever we haven't parsed
+			inout_string.erase(write_head - inout_string.data());
+			return false;
+		}
+		itr = read_view.data();
+	}
+
+	// We've finished parsing successfully; strip off the extraneous codepoints
+	inout_string.erase(write_head - inout_string.data());
+	return true;
+}
+
+} // namespace impl_unicode
+
+// Only use for ASTs where each character process is guaranteed to write at most 1 character for each character consumed
+template<typename CharT, const shrink_sequence_tree<CharT> SequenceTreeBegin, size_t SequenceTreeSize>
+constexpr bool apply_shrink_sequence_tree(std::basic_string<CharT>& inout_string) {
+	if (inout_string.empty()) {
+		// Nothing to parse
+		return true;
+	}
+
+	// Trees whose sequences all begin with ASCII (i.e: '\\', '%', '+') can skip straight to the next one
+	if constexpr (is_simple<CharT, SequenceTreeBegin, SequenceTreeSize>()) {
+		if (!std::is_constant_evaluated()) {
+			return impl_unicode::apply_shrink_sequence_tree_runs<CharT, SequenceTreeBegin, SequenceTreeSize>(inout_string);
+		}
+	}
+
+	return impl_unicode::apply_shrink_sequence_tree_codepoints<CharT, SequenceTreeBegin, SequenceTreeSize>(inout_string);
+}
+
 // Only for codepoints representable w/ char8_t (i.e: \n)
 template<typename CharT, char32_t InCodepointV, char8_t OutCodepointV>
 constexpr shrink_sequence_tree_member<CharT> make_simple_sequence_pair() {
@@ -312,9 +445,8 @@ constexpr shrink_sequence_tree_member<CharT> make_tree_sequence_pair() {
 	return { InCodepointV, [](CharT*& in_write_head, std::basic_string_view<CharT>& read_view) constexpr {
 		auto decode = decode_codepoint(read_view);
 
-		constexpr shrink_sequence_tree_member<CharT>* SubTreeEnd = SubTreeBegin + SubTreeSize;
-		auto parser = std::lower_bound(SubTreeBegin, SubTreeEnd, decode.codepoint, &shrink_tree_member_compare<CharT>);
-		if (parser == SubTreeEnd || parser->first != decode.codepoint) {
+		auto parser = find_tree_member<shrink_sequence_tree_member<CharT>, SubTreeBegin, SubTreeSize>(decode.codepoint);
+		if (parser == nullptr) {
 			if constexpr (FailNotFound) {
 				// Code not found; fail
 				return false;
@@ -398,4 +530,269 @@ constexpr bool apply_cpp_escape_sequences(std::basic_string<CharT>& inout_string
 	return apply_shrink_sequence_tree<CharT, cpp_escapes_root_tree<CharT>, std::size(cpp_escapes_root_tree<CharT>)>(inout_string);
 }
 
+/**
+ * Escape sequence encoders; the inverse of the above. Encoding is table-driven: each ASCII unit maps to the escape
+ * sequence it's written as (if any), while non-ASCII units are always written as-is.
+ */
+
+struct escape_sequence {
+	uint8_t length{}; // 0 if the unit is written as-is
+	char8_t units[7]{};
+};
+
+using escape_table = std::array<escape_sequence, 128>;
+
+namespace impl_unicode {
+
+constexpr escape_sequence make_escape_sequence(std::u8string_view in_sequence) {
+	escape_sequence result{ static_cast<uint8_t>(in_sequence.size()) };
+	for (size_t index = 0; index != in_sequence.size(); ++index) {
+		result.units[index] = in_sequence[index];
+	}
+
+	return result;
+}
+
+constexpr escape_sequence make_numeric_escape_sequence(std::u8string_view in_prefix, char32_t in_value, size_t in_base, size_t in_digits) {
+	constexpr char8_t digits[]{ u8"0123456789abcdef" };
+	escape_sequence result = make_escape_sequence(in_prefix);
+	for (size_t index = in_digits; index != 0; --index) {
+		result.units[result.length + index - 1] = digits[in_value % in_base];
+		in_value /= in_base;
+	}
+
+	result.length += static_cast<uint8_t>(in_digits);
+	return result;
+}
+
+// Every unit below this is escaped, letting control characters be checked for with a single comparison
+template<const escape_table& TableV>
+constexpr char32_t escape_threshold() {
+	char32_t result = 0;
+	while (result != TableV.size() && TableV[result].length != 0) {
+		++result;
+	}
+
+	return result;
+}
+
+// Escaped units at or above escape_threshold()
+template<const escape_table& TableV>
+constexpr size_t escape_specials_count() {
+	size_t result = 0;
+	for (size_t unit = escape_threshold<TableV>(); unit != TableV.size(); ++unit) {
+		if (TableV[unit].length != 0) {
+			++result;
+		}
+	}
+
+	return result;
+}
+
+template<const escape_table& TableV>
+constexpr std::array<char8_t, escape_specials_count<TableV>()> escape_specials() {
+	std::array<char8_t, escape_specials_count<TableV>()> result{};
+	size_t index = 0;
+	for (size_t unit = escape_threshold<TableV>(); unit != TableV.size(); ++unit) {
+		if (TableV[unit].length != 0) {
+			result[index++] = static_cast<char8_t>(unit);
+		}
+	}
+
+	return result;
+}
+
+// Length of each unit's escape sequence (or 0), followed by a final 0 which every non-ASCII unit is clamped to
+template<const escape_table& TableV>
+constexpr std::array<uint8_t, 129> make_escape_lengths(bool in_extra) {
+	std::array<uint8_t, 129> result{};
+	for (size_t unit = 0; unit != TableV.size(); ++unit) {
+		uint8_t length = TableV[unit].length;
+		result[unit] = in_extra && length != 0 ? length - 1 : length;
+	}
+
+	return result;
+}
+
+template<const escape_table& TableV>
+inline constexpr std::array<uint8_t, 129> escape_lengths = make_escape_lengths<TableV>(false);
+
+// Number of units each unit's escape sequence adds
+template<const escape_table& TableV>
+inline constexpr std::array<uint8_t, 129> escape_extra_lengths = make_escape_lengths<TableV>(true);
+
+template<typename CharT>
+constexpr size_t escape_index(CharT in_unit) {
+	auto unit = static_cast<std::make_unsigned_t<CharT>>(in_unit);
+	return unit < 0x80 ? unit : 0x80;
+}
+
+/**
+ * Finds the next unit which must be escaped according to TableV
+ *
+ * @param in_begin Start of the string to search
+ * @param in_end End of the string to search
+ * @return Pointer to the first unit to escape, or in_end if there is none
+ */
+template<typename CharT, const escape_table& TableV>
+constexpr const CharT* find_escape(const CharT* in_begin, const CharT* in_end) {
+	const CharT* itr = in_begin;
+	if constexpr (sizeof(CharT) == 1) {
+		if (!std::is_constant_evaluated()) {
+			// Check 8 units at a time; a byte is marked if it's below threshold, or if it's zero after xor with a special
+			constexpr char32_t threshold = escape_threshold<TableV>();
+			constexpr auto specials = escape_specials<TableV>();
+			constexpr uint64_t low_bits = 0x0101010101010101ULL;
+			constexpr uint64_t high_bits = low_bits * 0x80;
+			static_assert(threshold <= 0x80);
+			while (in_end - itr >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+				uint64_t word = load_word(itr);
+				uint64_t marks = ~(((word & ~high_bits) + low_bits * (0x80 - threshold)) | word) & high_bits;
+				for (char8_t special : specials) {
+					marks |= mark_zero_bytes(word ^ (low_bits * special));
+				}
+
+				if (marks != 0) {
+					return itr + first_marked_byte(marks);
+				}
+
+				itr += sizeof(uint64_t);
+			}
+		}
+	}
+
+	// A branchless table lookup per unit beats testing blocks for anything wider than bytes
+	for (; itr != in_end; ++itr) {
+		if (escape_lengths<TableV>[escape_index(*itr)] != 0) {
+			return itr;
+		}
+	}
+
+	return in_end;
+}
+
+} // namespace impl_unicode
+
+/**
+ * Calculates the length of a string after escaping
+ *
+ * @param in_string String to escape
+ * @return Number of units in_string will be once escaped according to TableV
+ */
+template<typename CharT, const escape_table& TableV>
+constexpr size_t escaped_length(std::basic_string_view<CharT> in_string) {
+	size_t result = in_string.size();
+	if constexpr (sizeof(CharT) == 1) {
+		// Skip over runs without any escapes
+		const CharT* itr = in_string.data();
+		const CharT* end = itr + in_string.size();
+		while ((itr = impl_unicode::find_escape<CharT, TableV>(itr, end)) != end) {
+			result += impl_unicode::escape_extra_lengths<TableV>[impl_unicode::escape_index(*itr)];
+			++itr;
+		}
+	}
+	else {
+		for (CharT unit : in_string) {
+			result += impl_unicode::escape_extra_lengths<TableV>[impl_unicode::escape_index(unit)];
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Escapes a string into a buffer; runs of units which don't need escaping are copied over all at once
+ *
+ * @param out_buffer Buffer to write to; must have room for escaped_length(in_string) units
+ * @param in_string String to escape
+ * @return Pointer to the end of the escaped string within out_buffer
+ */
+template<typename CharT, const escape_table& TableV>
+constexpr CharT* write_escape_sequences(CharT* out_buffer, std::basic_string_view<CharT> in_string) {
+	const CharT* itr = in_string.data();
+	const CharT* end = itr + in_string.size();
+	while (true) {
+		const CharT* run_end = impl_unicode::find_escape<CharT, TableV>(itr, end);
+		std::char_traits<CharT>::copy(out_buffer, itr, run_end - itr);
+		out_buffer += run_end - itr;
+		if (run_end == end) {
+			return out_buffer;
+		}
+
+		const escape_sequence& sequence = TableV[impl_unicode::escape_index(*run_end)];
+		for (size_t index = 0; index != sequence.length; ++index) {
+			out_buffer[index] = static_cast<CharT>(sequence.units[index]);
+		}
+
+		out_buffer += sequence.length;
+		itr = run_end + 1;
+	}
+}
+
+// Appends in_string to inout_string, escaped according to TableV
+template<typename CharT, const escape_table& TableV>
+constexpr void append_escape_sequences(std::basic_string<CharT>& inout_string, std::basic_string_view<CharT> in_string) {
+	size_t offset = inout_string.size();
+	inout_string.resize(offset + escaped_length<CharT, TableV>(in_string));
+	write_escape_sequences<CharT, TableV>(inout_string.data() + offset, in_string);
+}
+
+/**
+ * C++ escape sequence encoder; suitable for string literals
+ */
+
+constexpr escape_table make_cpp_escape_table() {
+	escape_table result{};
+	for (char32_t unit = 0; unit != 0x20; ++unit) {
+		// Octal, rather than hex, since hex escapes would consume any hex digits which follow
+		result[unit] = impl_unicode::make_numeric_escape_sequence(u8"\\", unit, 8, 3);
+	}
+
+	result[U'\a'] = impl_unicode::make_escape_sequence(u8"\\a");
+	result[U'\b'] = impl_unicode::make_escape_sequence(u8"\\b");
+	result[U'\t'] = impl_unicode::make_escape_sequence(u8"\\t");
+	result[U'\n'] = impl_unicode::make_escape_sequence(u8"\\n");
+	result[U'\v'] = impl_unicode::make_escape_sequence(u8"\\v");
+	result[U'\f'] = impl_unicode::make_escape_sequence(u8"\\f");
+	result[U'\r'] = impl_unicode::make_escape_sequence(u8"\\r");
+	result[U'\"'] = impl_unicode::make_escape_sequence(u8"\\\"");
+	result[U'\\'] = impl_unicode::make_escape_sequence(u8"\\\\");
+	result[0x7F] = impl_unicode::make_numeric_escape_sequence(u8"\\", 0x7F, 8, 3);
+	return result;
+}
+
+inline constexpr escape_table cpp_escape_table = make_cpp_escape_table();
+
+// Escapes a string such that apply_cpp_escape_sequences will restore it
+template<typename CharT>
+constexpr std::basic_string<CharT> make_cpp_escape_sequences(std::basic_string_view<CharT> in_string) {
+	std::basic_string<CharT> result;
+	append_escape_sequences<CharT, cpp_escape_table>(result, in_string);
+	return result;
+}
+
+/**
+ * JSON escape sequence encoder; matches the escaping used when serializing JSON strings
+ */
+
+constexpr escape_table make_json_escape_table() {
+	escape_table result{};
+	for (char32_t unit = 0; unit != 0x20; ++unit) {
+		result[unit] = impl_unicode::make_numeric_escape_sequence(u8"\\u", unit, 16, 4);
+	}
+
+	result[U'\"'] = impl_unicode::make_escape_sequence(u8"\\\"");
+	result[U'\\'] = impl_unicode::make_escape_sequence(u8"\\\\");
+	return result;
+}
+
+inline constexpr escape_table json_escape_table = make_json_escape_table();
+
+template<typename CharT>
+constexpr std::basic_string<CharT> make_json_escape_sequences(std::basic_string_view<CharT> in_string) {
+	std::basic_string<CharT> result;
+	append_escape_sequences<CharT, json_escape_table>(result, in_string);
+	return result;
+}
+
 } // namespace jessilib
@@ -27,7 +27,9 @@
 
 #include <limits>
 #include <algorithm>
+#include <array>
 #include "unicode.hpp"
+#include "syntax_tree_profile.hpp"
 
 namespace jessilib {
 
@@ -74,6 +76,72 @@ constexpr bool is_sorted() {
 	return true;
 }
 
+/**
+ * Dense dispatch table for the ASCII range of a sorted tree (syntax_tree or shrink_sequence_tree), generated at compile
+ * time. Nearly every lookup is for an ASCII codepoint, so this turns a binary search into a single table load.
+ *
+ * @return Table mapping each ASCII codepoint to the index of its member within the tree, or TreeSize if there is none
+ */
+template<typename MemberT, MemberT* TreeBegin, size_t TreeSize>
+constexpr std::array<uint8_t, 128> make_ascii_dispatch_table() {
+	static_assert(TreeSize < 0xFF, "Tree is too large to index with a byte");
+	std::array<uint8_t, 128> result{};
+	result.fill(static_cast<uint8_t>(TreeSize));
+
+	// Walk backwards, so that duplicates resolve to the first member, same as std::lower_bound
+	for (size_t index = TreeSize; index != 0; --index) {
+		char32_t codepoint = TreeBegin[index - 1].first;
+		if (codepoint < result.size()) {
+			result[codepoint] = static_cast<uint8_t>(index - 1);
+		}
+	}
+
+	return result;
+}
+
+template<typename MemberT, MemberT* TreeBegin, size_t TreeSize>
+constexpr size_t count_ascii_members() {
+	size_t result = 0;
+	while (result != TreeSize && TreeBegin[result].first < 0x80) {
+		++result;
+	}
+
+	return result;
+}
+
+template<typename MemberT, MemberT* TreeBegin, size_t TreeSize>
+inline constexpr std::array<uint8_t, 128> ascii_dispatch_table = make_ascii_dispatch_table<MemberT, TreeBegin, TreeSize>();
+
+/**
+ * Looks up the member of a sorted tree for a codepoint; binary search remains only for non-ASCII members
+ *
+ * @param in_codepoint Codepoint to look up
+ * @return Pointer to the member for in_codepoint, or nullptr if there is none
+ */
+template<typename MemberT, MemberT* TreeBegin, size_t TreeSize>
+constexpr MemberT* find_tree_member(char32_t in_codepoint) {
+	if (in_codepoint < 0x80) {
+		size_t index = ascii_dispatch_table<MemberT, TreeBegin, TreeSize>[in_codepoint];
+		return index == TreeSize ? nullptr : TreeBegin + index;
+	}
+
+	constexpr MemberT* NonASCIIBegin = TreeBegin + count_ascii_members<MemberT, TreeBegin, TreeSize>();
+	constexpr MemberT* TreeEnd = TreeBegin + TreeSize;
+	if constexpr (NonASCIIBegin == TreeEnd) {
+		return nullptr;
+	}
+	else {
+		MemberT* member = std::lower_bound(NonASCIIBegin, TreeEnd, in_codepoint, [](MemberT& in_lhs, char32_t in_rhs) {
+			return in_lhs.first < in_rhs;
+		});
+		if (member == TreeEnd || member->first != in_codepoint) {
+			return nullptr;
+		}
+
+		return member;
+	}
+}
+
 template<typename CharT, typename ContextT, bool UseExceptionsV = false>
 size_t fail_action(decode_result, ContextT&, std::basic_string_view<CharT>& in_read_view) {
 	using namespace std::literals;
@@ -91,15 +159,63 @@ size_t noop_action(decode_result decode, ContextT&, std::basic_string_view<CharT
 	return 0;
 }
 
+namespace impl_syntax {
+
+// Calls a tree member's action, recording it into in_profile if profiling is enabled for ContextT
+template<typename CharT, typename ContextT>
+constexpr size_t call_member_action(syntax_tree_profile* in_profile, const void* in_tree, syntax_tree_member<CharT, ContextT>& in_member,
+	decode_result in_decode, ContextT& inout_context, std::basic_string_view<CharT>& inout_read_view) {
+	if constexpr (syntax_tree_profiling_v<ContextT>) {
+		if (in_profile != nullptr) {
+			size_t read_size = inout_read_view.size();
+			inout_read_view.remove_prefix(in_decode.units);
+			size_t result = (in_member.second)(inout_context, inout_read_view);
+			in_profile->record_member(in_tree, in_decode.codepoint, (read_size - inout_read_view.size()) * sizeof(CharT));
+			return result;
+		}
+	}
+
+	inout_read_view.remove_prefix(in_decode.units);
+	return (in_member.second)(inout_context, inout_read_view);
+}
+
+// Calls a tree's default action, recording it into in_profile if profiling is enabled for ContextT
+template<typename CharT, typename ContextT, default_syntax_tree_action<CharT, ContextT> DefaultActionF>
+constexpr size_t call_default_action(syntax_tree_profile* in_profile, const void* in_tree,
+	decode_result in_decode, ContextT& inout_context, std::basic_string_view<CharT>& inout_read_view) {
+	if constexpr (syntax_tree_profiling_v<ContextT>) {
+		if (in_profile != nullptr) {
+			size_t read_size = inout_read_view.size();
+			auto start = std::chrono::steady_clock::now();
+			size_t result = DefaultActionF(in_decode, inout_context, inout_read_view);
+			auto time = std::chrono::steady_clock::now() - start;
+			in_profile->record_default_action(in_tree, (read_size - inout_read_view.size()) * sizeof(CharT),
+				std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+			return result;
+		}
+	}
+
+	return DefaultActionF(in_decode, inout_context, inout_read_view);
+}
+
+} // namespace impl_syntax
+
 template<typename CharT, typename ContextT, const syntax_tree<CharT, ContextT> SubTreeBegin, size_t SubTreeSize, default_syntax_tree_action<CharT, ContextT> DefaultActionF>
 constexpr size_t tree_action(ContextT& inout_context, std::basic_string_view<CharT>& inout_read_view) {
 	decode_result decode;
 	size_t break_stack_depth;
-	constexpr syntax_tree_member<CharT, ContextT>* SubTreeEnd = SubTreeBegin + SubTreeSize;
+	syntax_tree_profile* profile{};
+	if constexpr (syntax_tree_profiling_v<ContextT>) {
+		if (!std::is_constant_evaluated()) {
+			profile = syntax_tree_profile::current();
+		}
+	}
+
 	while ((decode = decode_codepoint(inout_read_view)).units != 0) {
-		auto parser = std::lower_bound(SubTreeBegin, SubTreeEnd, decode.codepoint, &syntax_tree_member_compare<CharT, ContextT>);
-		if (parser == SubTreeEnd || parser->first != decode.codepoint) {
-			break_stack_depth = DefaultActionF(decode, inout_context, inout_read_view);
+		auto parser = find_tree_member<syntax_tree_member<CharT, ContextT>, SubTreeBegin, SubTreeSize>(decode.codepoint);
+		if (parser == nullptr) {
+			break_stack_depth = impl_syntax::call_default_action<CharT, ContextT, DefaultActionF>(profile, SubTreeBegin,
+				decode, inout_context, inout_read_view);
 			if (break_stack_depth == 0) {
 				// Don't jump the stack; continue
 				continue;
@@ -109,8 +225,8 @@ constexpr size_t tree_action(ContextT& inout_context, std::basic_string_view<Cha
 		}
 
 		// This is a parsed sequence; pass it to the parser
-		inout_read_view.remove_prefix(decode.units);
-		break_stack_depth = (parser->second)(inout_context, inout_read_view);
+		break_stack_depth = impl_syntax::call_member_action<CharT, ContextT>(profile, SubTreeBegin, *parser,
+			decode, inout_context, inout_read_view);
 		if (break_stack_depth != 0) {
 			return break_stack_depth - 1;
 		}
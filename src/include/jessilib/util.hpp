@@ -42,8 +42,8 @@ std::basic_string_view<CharT> make_string_view(const CharT* in_ntstring) {
 }
 
 template<typename CharT, typename NumberT>
-const CharT* parse_decimal_part(const CharT* in_str, const CharT* in_str_end, NumberT& out_value) {
-	int denominator = 10;
+constexpr const CharT* parse_decimal_part(const CharT* in_str, const CharT* in_str_end, NumberT& out_value) {
+	NumberT denominator = 10;
 	while (in_str != in_str_end) {
 		switch (*in_str) {
 			case '0':
@@ -124,10 +124,9 @@ from_chars_result<CharT> from_chars(CharT* in_str, CharT* in_str_end, NumberT& o
 
 	// Copy the view into the buffer
 	char* itr = buffer;
-	while (in_str != in_str_end) {
-		*itr = static_cast<char>(*in_str);
+	for (CharT* str_itr = in_str; str_itr != in_str_end; ++str_itr) {
+		*itr = static_cast<char>(*str_itr);
 		++itr;
-		++in_str;
 	}
 
 	// leverage from_chars
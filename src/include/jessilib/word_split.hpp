@@ -25,10 +25,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
 #include <string_view>
 #include <vector>
 #include <tuple>
-#include <algorithm>
+#include "split.hpp"
 
 namespace jessilib {
 
@@ -65,6 +70,271 @@ constexpr MemberT make_word_split_member(ItrT in_itr, EndT in_end) {
 	return { in_itr, in_end };
 }
 
+/** Default member type for word_split_range; views for contiguous ranges of characters, subranges otherwise */
+template<typename ItrT, typename ElementT = std::iter_value_t<ItrT>>
+using word_split_range_member_t = std::conditional_t<std::contiguous_iterator<ItrT> && std::is_trivial_v<ElementT>,
+	std::basic_string_view<ElementT>, std::ranges::subrange<ItrT>>;
+
+namespace impl_word_split {
+
+/** Whitespace consisting of a single element */
+template<typename ElementT>
+struct element_whitespace {
+	constexpr bool is_whitespace(const ElementT& in_element) const {
+		return in_element == m_whitespace;
+	}
+
+	template<typename ItrT>
+	constexpr ItrT find(ItrT in_begin, ItrT in_end) const {
+		return impl_split::find_element(in_begin, in_end, m_whitespace);
+	}
+
+	ElementT m_whitespace;
+};
+
+/**
+ * Whitespace consisting of any element in a set; an empty set never matches. Sets of integral units keep a bitmap of
+ * the units below 256, so that membership is a single lookup rather than a search of the set.
+ */
+template<typename SpaceItrT>
+class set_whitespace {
+public:
+	using element_type = std::iter_value_t<SpaceItrT>;
+	static constexpr bool use_bitmap = std::is_integral_v<element_type> && !std::is_same_v<element_type, bool>;
+
+	constexpr set_whitespace() = default;
+
+	constexpr set_whitespace(SpaceItrT in_begin, SpaceItrT in_end)
+		: m_begin{ in_begin },
+		m_end{ in_end } {
+		if constexpr (use_bitmap) {
+			for (auto itr = in_begin; itr != in_end; ++itr) {
+				auto value = static_cast<std::make_unsigned_t<element_type>>(*itr);
+				if (value < 256) {
+					m_bitmap[value / 64] |= uint64_t{ 1 } << (value % 64);
+				}
+				else {
+					m_has_wide = true;
+				}
+			}
+		}
+	}
+
+	template<typename ElementT>
+	constexpr bool is_whitespace(const ElementT& in_element) const {
+		if constexpr (use_bitmap && std::is_same_v<ElementT, element_type>) {
+			auto value = static_cast<std::make_unsigned_t<element_type>>(in_element);
+			if (value < 256) {
+				return (m_bitmap[value / 64] >> (value % 64)) & 1;
+			}
+
+			if (!m_has_wide) {
+				return false;
+			}
+		}
+
+		return std::find(m_begin, m_end, in_element) != m_end;
+	}
+
+	template<typename ItrT>
+	constexpr ItrT find(ItrT in_begin, ItrT in_end) const {
+		return std::find_if(in_begin, in_end, [this](const auto& in_element) {
+			return is_whitespace(in_element);
+		});
+	}
+
+private:
+	SpaceItrT m_begin{};
+	SpaceItrT m_end{};
+	std::array<uint64_t, 4> m_bitmap{};
+	bool m_has_wide{}; // Whether any whitespace is outside of m_bitmap
+};
+
+// Returns the first run of whitespace in [in_begin, in_end), or {in_end, in_end} if there is none
+template<typename WhitespaceT, typename ItrT>
+constexpr std::pair<ItrT, ItrT> find_whitespace(const WhitespaceT& in_whitespace, ItrT in_begin, ItrT in_end) {
+	ItrT run_begin = in_whitespace.find(in_begin, in_end);
+	ItrT run_end = run_begin;
+	while (run_end != in_end
+		&& in_whitespace.is_whitespace(*run_end)) {
+		++run_end;
+	}
+
+	return { run_begin, run_end };
+}
+
+} // namespace impl_word_split
+
+/**
+ * Lazily word split range of elements; each word is found only as the iterator reaches it, so nothing is allocated
+ * unless MemberT allocates. Yields the same words as word_split(). Iterators refer only to the input (and the whitespace,
+ * for whitespace sets), so they remain valid after the range is destroyed.
+ *
+ * @tparam MemberT Type of the words yielded by the range
+ * @tparam ItrT Iterator type of the range being split; must be a forward iterator
+ * @tparam WhitespaceT Whitespace matcher (see impl_word_split)
+ */
+template<typename MemberT, typename ItrT, typename WhitespaceT>
+class basic_word_split_range : public std::ranges::view_interface<basic_word_split_range<MemberT, ItrT, WhitespaceT>> {
+public:
+	class iterator {
+	public:
+		using iterator_concept = std::forward_iterator_tag;
+		using iterator_category = std::input_iterator_tag;
+		using value_type = MemberT;
+		using difference_type = std::ptrdiff_t;
+
+		constexpr iterator() = default;
+
+		constexpr iterator(ItrT in_begin, ItrT in_end, const WhitespaceT& in_whitespace)
+			: m_end{ in_end },
+			m_whitespace{ in_whitespace } {
+			// Skip over any preceeding whitespace
+			auto run = find_run(in_begin);
+			if (run.first == in_begin) {
+				find_word(run.second);
+				return;
+			}
+
+			m_word_begin = in_begin;
+			m_word_end = run.first;
+			m_next = run.second;
+		}
+
+		constexpr MemberT operator*() const {
+			return make_word_split_member<MemberT>(m_word_begin, m_word_end);
+		}
+
+		constexpr iterator& operator++() {
+			find_word(m_next);
+			return *this;
+		}
+
+		constexpr iterator operator++(int) {
+			iterator result = *this;
+			++*this;
+			return result;
+		}
+
+		/** Start of the current word; the unsplit remainder is [base(), end) */
+		constexpr ItrT base() const {
+			return m_word_begin;
+		}
+
+		friend constexpr bool operator==(const iterator& in_lhs, const iterator& in_rhs) {
+			return in_lhs.m_word_begin == in_rhs.m_word_begin;
+		}
+
+		friend constexpr bool operator==(const iterator& in_lhs, std::default_sentinel_t) {
+			return in_lhs.done();
+		}
+
+	private:
+		constexpr bool done() const {
+			return m_word_begin == m_end;
+		}
+
+		constexpr std::pair<ItrT, ItrT> find_run(ItrT in_begin) const {
+			return impl_word_split::find_whitespace(m_whitespace, in_begin, m_end);
+		}
+
+		// in_word_begin is the start of a word, or the end of input
+		constexpr void find_word(ItrT in_word_begin) {
+			m_word_begin = in_word_begin;
+			if (done()) {
+				return;
+			}
+
+			auto run = find_run(in_word_begin);
+			m_word_end = run.first;
+			m_next = run.second;
+		}
+
+		ItrT m_word_begin{};
+		ItrT m_word_end{};
+		ItrT m_next{}; // Start of the next word, or the end of input
+		ItrT m_end{};
+		WhitespaceT m_whitespace{};
+	};
+
+	constexpr basic_word_split_range() = default;
+
+	constexpr basic_word_split_range(ItrT in_begin, ItrT in_end, WhitespaceT in_whitespace)
+		: m_begin{ in_begin },
+		m_end{ in_end },
+		m_whitespace{ std::move(in_whitespace) } {
+		// Empty body
+	}
+
+	constexpr iterator begin() const {
+		return { m_begin, m_end, m_whitespace };
+	}
+
+	constexpr std::default_sentinel_t end() const {
+		return std::default_sentinel;
+	}
+
+private:
+	ItrT m_begin{};
+	ItrT m_end{};
+	WhitespaceT m_whitespace{};
+};
+
+/**
+ * Lazily splits a range of elements into words; see basic_word_split_range
+ *
+ * @tparam OptionalMemberT Type of the words; defaults to a view type (see word_split_range_member_t)
+ * @param begin Start of range of elements to split
+ * @param end End of range of elements to split
+ * @param in_whitespace Whitespace to split upon
+ * @return Range of words, equal to those returned by word_split()
+ */
+template<typename... OptionalMemberT, typename ItrT, typename EndT, typename ElementT>
+constexpr auto word_split_range(ItrT begin, EndT end, ElementT in_whitespace) {
+	static_assert(sizeof...(OptionalMemberT) <= 1, "Too many member types specified for OptionalMemberT");
+	using RangeItrT = std::common_type_t<ItrT, EndT>; // i.e: const_iterator for an iterator & const_iterator
+	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., word_split_range_member_t<RangeItrT>>>;
+	return basic_word_split_range<MemberT, RangeItrT, impl_word_split::element_whitespace<ElementT>>{ begin, end, { in_whitespace } };
+}
+
+/**
+ * Lazily splits a range of elements into words; see basic_word_split_range
+ *
+ * @tparam OptionalMemberT Type of the words; defaults to a view type (see word_split_range_member_t)
+ * @param begin Start of range of elements to split
+ * @param end End of range of elements to split
+ * @param in_whitespace_begin Start of range containing the whitespace values
+ * @param in_whitespace_end End of range containing the whitespace values
+ * @return Range of words, equal to those returned by word_split()
+ */
+template<typename... OptionalMemberT, typename ItrT, typename EndT, typename SpaceItrT, typename SpaceEndT>
+constexpr auto word_split_range(ItrT begin, EndT end, SpaceItrT in_whitespace_begin, SpaceEndT in_whitespace_end) {
+	static_assert(sizeof...(OptionalMemberT) <= 1, "Too many member types specified for OptionalMemberT");
+	using RangeItrT = std::common_type_t<ItrT, EndT>;
+	using SpaceRangeItrT = std::common_type_t<SpaceItrT, SpaceEndT>;
+	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., word_split_range_member_t<RangeItrT>>>;
+	return basic_word_split_range<MemberT, RangeItrT, impl_word_split::set_whitespace<SpaceRangeItrT>>{ begin, end, { in_whitespace_begin, in_whitespace_end } };
+}
+
+/**
+ * Lazily splits a string into words; the string and whitespace must outlive the range
+ *
+ * @tparam OptionalMemberT Type of the words; defaults to a view type (see word_split_range_member_t)
+ * @param in_string String to split
+ * @param in_whitespace Whitespace to split upon
+ * @return Range of words, equal to those returned by word_split()
+ */
+template<typename... OptionalMemberT, typename InputT>
+constexpr auto word_split_range(const InputT& in_string, typename InputT::value_type in_whitespace) {
+	return word_split_range<OptionalMemberT...>(in_string.begin(), in_string.end(), in_whitespace);
+}
+
+template<typename... OptionalMemberT, typename InputT, typename SpaceT,
+	typename std::enable_if<!std::is_same<SpaceT, typename InputT::value_type>::value>::type* = nullptr>
+constexpr auto word_split_range(const InputT& in_string, const SpaceT& in_whitespace) {
+	return word_split_range<OptionalMemberT...>(in_string.begin(), in_string.end(), in_whitespace.begin(), in_whitespace.end());
+}
+
 /**
  * Splits an input string into substrings based on words
  *
@@ -82,38 +352,8 @@ constexpr auto word_split(ItrT begin, EndT end, ElementT in_whitespace) {
 	using container_type = typename word_split_defaults_type::container_type;
 
 	container_type result;
-	if (begin >= end) {
-		// Nothing to word_split
-		return result;
-	}
-
-	// Skip over any preceeding whitespace
-	while (begin != end
-		&& *begin == in_whitespace) {
-		++begin;
-	}
-
-	for (auto itr = begin; itr != end;) {
-		if (*itr == in_whitespace) {
-			// End of word reached; push token to result and skip over any whitespace
-			result.push_back(make_word_split_member<member_type>(begin, itr));
-
-			++itr;
-			while (itr != end
-				&& *itr == in_whitespace) {
-				++itr;
-			}
-
-			begin = itr;
-			continue;
-		}
-
-		++itr;
-	}
-
-	// Push final token to the end if not empty
-	if (begin != end) {
-		result.push_back(make_word_split_member<member_type>(begin, end));
+	for (auto&& word : word_split_range<member_type>(begin, end, in_whitespace)) {
+		result.push_back(std::move(word));
 	}
 
 	return result;
@@ -137,52 +377,14 @@ constexpr auto word_split(ItrT begin, EndT end, SpaceItrT in_whitespace_begin, S
 	using member_type = typename word_split_defaults_type::member_type;
 	using container_type = typename word_split_defaults_type::container_type;
 
-	if (std::distance(in_whitespace_begin, in_whitespace_end) == 1) {
+	if (std::ranges::distance(in_whitespace_begin, in_whitespace_end) == 1) {
 		return word_split<ContainerT, ContainerArgsT...>(begin, end, *in_whitespace_begin);
 	}
 
+	// Absent whitespace never matches, so the input is returned as a single token
 	container_type result{};
-	if (begin >= end) {
-		// Nothing to word_split
-		return result;
-	}
-
-	if (in_whitespace_begin >= in_whitespace_end) {
-		// Absent whitespace, therefore no match, therefore return input as single token
-		result.push_back(make_word_split_member<member_type>(begin, end));
-		return result;
-	}
-
-	auto is_whitespace = [in_whitespace_begin, in_whitespace_end](ElementT in_element) {
-		return std::find(in_whitespace_begin, in_whitespace_end, in_element) != in_whitespace_end;
-	};
-
-	while (begin != end
-		&& is_whitespace(*begin)) {
-		++begin;
-	}
-
-	for (auto itr = begin; itr < end;) {
-		if (is_whitespace(*itr)) {
-			// Push token to result
-			result.push_back(make_word_split_member<member_type>(begin, itr));
-
-			++itr;
-			while (itr != end
-				&& is_whitespace(*itr)) {
-				++itr;
-			}
-
-			begin = itr;
-			continue;
-		}
-
-		++itr;
-	}
-
-	// Push final token to the end if not empty
-	if (begin != end) {
-		result.push_back(make_word_split_member<member_type>(begin, end));
+	for (auto&& word : word_split_range<member_type>(begin, end, in_whitespace_begin, in_whitespace_end)) {
+		result.push_back(std::move(word));
 	}
 
 	return result;
@@ -276,7 +478,7 @@ constexpr auto word_split_once(ItrT begin, EndT end, SpaceItrT in_whitespace_beg
 	using ElementT = std::remove_cvref_t<decltype(*begin)>;
 	using MemberT = std::tuple_element_t<0, std::tuple<OptionalMemberT..., std::basic_string<ElementT>>>;
 
-	if (std::distance(in_whitespace_begin, in_whitespace_end) == 1) {
+	if (std::ranges::distance(in_whitespace_begin, in_whitespace_end) == 1) {
 		return word_split_once<OptionalMemberT...>(begin, end, *in_whitespace_begin);
 	}
 
@@ -369,35 +571,15 @@ constexpr auto word_split_n(ItrT begin, EndT end, ElementT in_whitespace, size_t
 	using container_type = typename word_split_defaults_type::container_type;
 
 	container_type result;
-	if (begin >= end) {
-		// Nothing to word_split
-		return result;
+	auto range = word_split_range<member_type>(begin, end, in_whitespace);
+	auto itr = range.begin();
+	for (; itr != range.end() && in_limit != 0; ++itr, --in_limit) {
+		result.push_back(*itr);
 	}
 
-	while (begin != end
-		&& *begin == in_whitespace) {
-		++begin;
-	}
-
-	for (auto itr = begin; itr != end && in_limit != 0; ++itr) {
-		if (*itr == in_whitespace) {
-			// Push token to result
-			result.push_back(make_word_split_member<member_type>(begin, itr));
-
-			++itr;
-			while (itr != end
-				&& *itr == in_whitespace) {
-				++itr;
-			}
-
-			begin = itr;
-			--in_limit;
-		}
-	}
-
-	// Push final token to the end if not empty
-	if (begin != end) {
-		result.push_back(make_word_split_member<member_type>(begin, end));
+	// Push the unprocessed remainder, if any
+	if (itr != range.end()) {
+		result.push_back(make_word_split_member<member_type>(itr.base(), decltype(itr.base()){ end }));
 	}
 
 	return result;
@@ -421,53 +603,22 @@ constexpr auto word_split_n(ItrT begin, EndT end, SpaceItrT in_whitespace_begin,
 	using member_type = typename word_split_defaults_type::member_type;
 	using container_type = typename word_split_defaults_type::container_type;
 
-	if (std::distance(in_whitespace_begin, in_whitespace_end) == 1) {
+	if (std::ranges::distance(in_whitespace_begin, in_whitespace_end) == 1) {
 		return word_split_n<ContainerT, ContainerArgsT...>(begin, end, *in_whitespace_begin, in_limit);
 	}
 
 	container_type result{};
-	if (begin >= end) {
-		// Nothing to word_split
-		return result;
+	auto range = word_split_range<member_type>(begin, end, in_whitespace_begin, in_whitespace_end);
+	auto itr = range.begin();
+	for (; itr != range.end() && in_limit != 0; ++itr, --in_limit) {
+		result.push_back(*itr);
 	}
 
-	if (in_whitespace_begin >= in_whitespace_end) {
-		// Absent whitespace, therefore no match, therefore return input as single token
-		result.push_back(make_word_split_member<member_type>(begin, end));
-		return result;
-	}
-
-	auto is_whitespace = [in_whitespace_begin, in_whitespace_end](ElementT in_element) {
-		return std::find(in_whitespace_begin, in_whitespace_end, in_element) != in_whitespace_end;
-	};
-
-	while (begin != end
-		&& is_whitespace(*begin)) {
-		++begin;
+	// Push the unprocessed remainder, if any
+	if (itr != range.end()) {
+		result.push_back(make_word_split_member<member_type>(itr.base(), decltype(itr.base()){ end }));
 	}
 
-	for (auto itr = begin; itr != end && in_limit != 0;) {
-		if (std::equal(in_whitespace_begin, in_whitespace_end, itr)) {
-			// Push token to result
-			result.push_back(make_word_split_member<member_type>(begin, itr));
-
-			++itr;
-			while (itr != end
-				&& is_whitespace(*itr)) {
-				++itr;
-			}
-
-			begin = itr;
-			--in_limit;
-			continue;
-		}
-
-		++itr;
-	}
-
-	// Push final token to the end; may be empty
-	result.push_back(make_word_split_member<member_type>(begin, end));
-
 	return result;
 }
 
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/http_multipart.hpp"
+#include <vector>
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+struct part {
+	std::vector<std::pair<std::string, std::string>> headers;
+	std::string data;
+	bool ended{};
+
+	bool operator==(const part&) const = default;
+};
+
+multipart_parser make_parser(std::string_view in_boundary, std::vector<part>& out_parts) {
+	return multipart_parser{ in_boundary, {
+		[&out_parts]() { out_parts.emplace_back(); },
+		[&out_parts](std::string_view in_name, std::string_view in_value) { out_parts.back().headers.emplace_back(in_name, in_value); },
+		[&out_parts](std::string_view in_data) { out_parts.back().data += in_data; },
+		[&out_parts]() { out_parts.back().ended = true; }
+	} };
+}
+
+// Near-misses of the boundary, including a complete boundary missing its leading line break
+const std::string file_data = "binary\r\n-\r\n--\r\n--boundar\r\n--boundarx\0\xFF--boundary\r\r\n--bound"s;
+
+const std::string body =
+	"This is the preamble\r\n"
+	"--boundary\r\n"
+	"Content-Disposition: form-data; name=\"field\"\r\n"
+	"\r\n"
+	"value\r\n"
+	"--boundary  \r\n"
+	"Content-Disposition: form-data; name=\"file\"; filename=\"file.bin\"\r\n"
+	"Content-Type:application/octet-stream\r\n"
+	"\r\n"
+	+ file_data + "\r\n"
+	"--boundary--\r\n"
+	"This is the epilogue\r\n";
+
+const std::vector<part> expected_parts{
+	{ { { "Content-Disposition", "form-data; name=\"field\"" } }, "value", true },
+	{ { { "Content-Disposition", "form-data; name=\"file\"; filename=\"file.bin\"" }, { "Content-Type", "application/octet-stream" } }, file_data, true }
+};
+
+} // namespace
+
+TEST(MultipartParserTest, chunks) {
+	for (size_t chunk_size = 1; chunk_size <= body.size(); ++chunk_size) {
+		std::vector<part> parts;
+		multipart_parser parser = make_parser("boundary"sv, parts);
+		std::string_view remaining = body;
+		while (!remaining.empty()) {
+			EXPECT_TRUE(parser.parse(remaining.substr(0, chunk_size)));
+			remaining.remove_prefix(std::min(chunk_size, remaining.size()));
+		}
+
+		EXPECT_TRUE(parser.complete());
+		EXPECT_EQ(parts, expected_parts) << "chunk_size: " << chunk_size;
+	}
+}
+
+TEST(MultipartParserTest, zero_copy) {
+	// Data which can't be the start of a boundary is passed straight through from the chunk
+	std::vector<std::string_view> slices;
+	multipart_parser parser{ "boundary"sv, { {}, {}, [&slices](std::string_view in_data) { slices.push_back(in_data); }, {} } };
+	std::string chunk = "--boundary\r\n\r\npayload data\r\n--boundary--"s;
+	EXPECT_TRUE(parser.parse(chunk));
+	EXPECT_TRUE(parser.complete());
+	ASSERT_EQ(slices.size(), 1U);
+	EXPECT_EQ(slices[0], "payload data"sv);
+	EXPECT_EQ(slices[0].data(), chunk.data() + chunk.find("payload"));
+}
+
+TEST(MultipartParserTest, reset) {
+	std::vector<part> parts;
+	multipart_parser parser = make_parser("boundary"sv, parts);
+	EXPECT_TRUE(parser.parse(body));
+	EXPECT_TRUE(parser.complete());
+
+	parts.clear();
+	parser.reset();
+	EXPECT_FALSE(parser.complete());
+	EXPECT_TRUE(parser.parse(body.substr(body.find("--boundary"))));
+	EXPECT_EQ(parts, expected_parts);
+}
+
+TEST(MultipartParserTest, malformed) {
+	std::vector<part> parts;
+	multipart_parser parser = make_parser("boundary"sv, parts);
+	EXPECT_FALSE(parser.parse("--boundary\r\nNot a header\r\n\r\n"sv));
+	EXPECT_TRUE(parser.failed());
+	EXPECT_FALSE(parser.parse("--boundary--"sv));
+
+	parser.reset();
+	EXPECT_FALSE(parser.parse("--boundaryx\r\n"sv));
+	EXPECT_TRUE(parser.failed());
+
+	// Headers are limited in size, since they're buffered
+	parser.reset();
+	EXPECT_TRUE(parser.parse("--boundary\r\nX-Header: "sv));
+	EXPECT_FALSE(parser.parse(std::string(multipart_parser::max_headers_size, 'a')));
+
+	EXPECT_THROW(make_parser(""sv, parts), std::invalid_argument);
+	EXPECT_THROW(make_parser(std::string(71, 'a'), parts), std::invalid_argument);
+}
+
+TEST(MultipartParserTest, content_type_boundary) {
+	EXPECT_EQ(multipart_parser::content_type_boundary("multipart/form-data; boundary=abc123"sv), "abc123"sv);
+	EXPECT_EQ(multipart_parser::content_type_boundary("multipart/form-data;charset=utf-8; BOUNDARY = \"a b:c\" "sv), "a b:c"sv);
+	EXPECT_TRUE(multipart_parser::content_type_boundary("multipart/form-data"sv).empty());
+}
@@ -18,7 +18,8 @@
 
 #include "jessilib/http_query.hpp"
 #include <charconv>
-#include "test.hpp"
+#include <random>
+#include "test_sequence.hpp"
 
 using namespace std::literals;
 
@@ -161,6 +162,14 @@ TYPED_TEST(QuerySequenceTest, invalids_2len_trailing) {
 	EXPECT_TRUE(long_query_string.empty());
 }
 
+TYPED_TEST(QuerySequenceTest, runs) {
+	// Skipping between triggers must match decoding every codepoint, including around block boundaries
+	constexpr std::u8string_view pieces[]{ u8"text", u8"Jessilib", u8"+", u8"%20", u8"%4a", u8"%", u8"%G0", u8"é", u8"\U0001F604" };
+	constexpr size_t tree_size = std::size(jessilib::http_query_escapes_root_tree<TypeParam>);
+
+	expect_shrink_sequence_runs_match<TypeParam, jessilib::http_query_escapes_root_tree<TypeParam>, tree_size>(pieces);
+}
+
 TEST(HtmlFormParser, empty) {
 	std::vector<std::pair<std::u8string_view, std::u8string_view>> parsed_result;
 	std::u8string query_text;
@@ -236,3 +245,160 @@ TEST(HtmlFormParser, some_sequences) {
 	EXPECT_EQ(parsed_result[1].first, u8"second_key");
 	EXPECT_EQ(parsed_result[1].second, u8"second_value");
 }
+
+TEST(HtmlFormView, views) {
+	std::u8string arena;
+	std::u8string_view form = u8"key=value&k+y=va+u%20&second_key=second=value&valueless"sv;
+	std::vector<jessilib::html_form_field<char8_t>> fields;
+	jessilib::html_form_view view{ form, arena };
+	for (auto& field : view) {
+		fields.push_back(field);
+	}
+	EXPECT_FALSE(view.failed());
+
+	ASSERT_EQ(fields.size(), 4U);
+	EXPECT_EQ(fields[0].key, u8"key");
+	EXPECT_EQ(fields[0].value, u8"value");
+	EXPECT_EQ(fields[1].key, u8"k y");
+	EXPECT_EQ(fields[1].value, u8"va u ");
+	EXPECT_EQ(fields[2].key, u8"second_key");
+	EXPECT_EQ(fields[2].value, u8"second=value");
+	EXPECT_EQ(fields[3].key, u8"valueless");
+	EXPECT_TRUE(fields[3].value.empty());
+
+	// Only fields which needed decoding are in the arena
+	EXPECT_EQ(fields[0].key.data(), form.data());
+	EXPECT_EQ(fields[2].value.data(), form.data() + form.find(u8"second=value"));
+	EXPECT_EQ(fields[1].key.data(), arena.data());
+	EXPECT_EQ(fields[1].value.data(), arena.data() + 3);
+}
+
+TEST(HtmlFormView, lazy) {
+	std::u8string arena;
+	std::u8string_view form = u8"id=1234&invalid=%G0"sv;
+	jessilib::html_form_view view{ form, arena };
+	auto itr = view.begin();
+	ASSERT_NE(itr, view.end());
+	EXPECT_EQ(itr->key, u8"id");
+	EXPECT_EQ(itr->value, u8"1234");
+	EXPECT_FALSE(view.failed());
+	EXPECT_TRUE(arena.empty()); // Nothing's been decoded yet
+
+	++itr;
+	EXPECT_EQ(itr, view.end());
+	EXPECT_TRUE(view.failed());
+}
+
+TEST(HtmlFormView, empty) {
+	std::u8string arena;
+	jessilib::html_form_view view{ u8""sv, arena };
+	EXPECT_EQ(view.begin(), view.end());
+	EXPECT_FALSE(view.failed());
+}
+
+TEST(HtmlFormView, matches_deserialize_html_form) {
+	constexpr std::u8string_view pieces[]{ u8"text", u8"=", u8"&", u8"+", u8"%20", u8"%3D", u8"%26", u8"%", u8"%G0", u8"é", u8"\U0001F604" };
+
+	std::mt19937 generator{ 1234 };
+	for (size_t iteration = 0; iteration != 2000; ++iteration) {
+		std::u8string form;
+		size_t piece_count = generator() % 24;
+		for (size_t index = 0; index != piece_count; ++index) {
+			form += pieces[generator() % std::size(pieces)];
+		}
+
+		std::vector<std::pair<std::u8string_view, std::u8string_view>> expected;
+		std::u8string in_place_form = form;
+		bool expected_result = jessilib::deserialize_html_form(expected, in_place_form);
+
+		std::vector<std::pair<std::u8string_view, std::u8string_view>> result;
+		std::u8string arena;
+		EXPECT_EQ(jessilib::deserialize_html_form(result, std::u8string_view{ form }, arena), expected_result);
+		EXPECT_EQ(result, expected);
+	}
+}
+
+TEST(PercentEncoding, serialize_http_query) {
+	EXPECT_EQ(jessilib::serialize_http_query(u8""sv), u8"");
+	EXPECT_EQ(jessilib::serialize_http_query(u8"Jessilib-1.0_~"sv), u8"Jessilib-1.0_~");
+	EXPECT_EQ(jessilib::serialize_http_query(u8"a b&c=d/é"sv), u8"a%20b%26c%3Dd%2F%C3%A9");
+
+	// Every byte value round trips
+	std::u8string all_bytes;
+	for (size_t byte = 0; byte != 256; ++byte) {
+		all_bytes += static_cast<char8_t>(byte);
+	}
+
+	std::u8string encoded = jessilib::serialize_http_query(std::u8string_view{ all_bytes });
+	EXPECT_EQ(encoded.size(), (jessilib::percent_encoded_length<char8_t, jessilib::url_component_encoding_table>(all_bytes)));
+	EXPECT_TRUE(jessilib::deserialize_http_query(encoded));
+	EXPECT_EQ(encoded, all_bytes);
+}
+
+TEST(PercentEncoding, html_form) {
+	std::u8string form;
+	jessilib::append_percent_encoded<char8_t, jessilib::html_form_encoding_table>(form, u8"some key"sv);
+	form += u8'=';
+	jessilib::append_percent_encoded<char8_t, jessilib::html_form_encoding_table>(form, u8"a+b=c~"sv);
+	EXPECT_EQ(form, u8"some+key=a%2Bb%3Dc%7E");
+
+	std::vector<std::pair<std::u8string_view, std::u8string_view>> fields;
+	EXPECT_TRUE(jessilib::deserialize_html_form(fields, form));
+	ASSERT_EQ(fields.size(), 1U);
+	EXPECT_EQ(fields[0].first, u8"some key");
+	EXPECT_EQ(fields[0].second, u8"a+b=c~");
+}
+
+TEST(UrlParser, components) {
+	jessilib::url_view<char8_t> url;
+	ASSERT_TRUE(jessilib::parse_url(url, u8"https://user@example.com:8080/a%20path/x+y?key=value&k2#frag"sv));
+	EXPECT_EQ(url.scheme, u8"https");
+	EXPECT_EQ(url.authority, u8"user@example.com:8080");
+	EXPECT_EQ(url.path, u8"/a%20path/x+y");
+	EXPECT_EQ(url.query, u8"key=value&k2");
+	EXPECT_EQ(url.fragment, u8"frag");
+
+	std::u8string path{ url.path };
+	EXPECT_TRUE(jessilib::deserialize_http_path(path));
+	EXPECT_EQ(path, u8"/a path/x+y");
+}
+
+TEST(UrlParser, absent_components) {
+	jessilib::url_view<char8_t> url;
+	ASSERT_TRUE(jessilib::parse_url(url, u8"http://example.com"sv));
+	EXPECT_EQ(url.authority, u8"example.com");
+	EXPECT_TRUE(url.path.empty());
+	EXPECT_FALSE(url.has_query());
+	EXPECT_FALSE(url.has_fragment());
+
+	ASSERT_TRUE(jessilib::parse_url(url, u8"http://example.com/?#"sv));
+	EXPECT_EQ(url.path, u8"/");
+	EXPECT_TRUE(url.has_query());
+	EXPECT_TRUE(url.query.empty());
+	EXPECT_TRUE(url.has_fragment());
+	EXPECT_TRUE(url.fragment.empty());
+
+	// Relative references
+	ASSERT_TRUE(jessilib::parse_url(url, u8"/path/to:file?q"sv));
+	EXPECT_FALSE(url.has_scheme());
+	EXPECT_FALSE(url.has_authority());
+	EXPECT_EQ(url.path, u8"/path/to:file");
+	EXPECT_EQ(url.query, u8"q");
+
+	ASSERT_TRUE(jessilib::parse_url(url, u8"mailto:jessica@example.com"sv));
+	EXPECT_EQ(url.scheme, u8"mailto");
+	EXPECT_FALSE(url.has_authority());
+	EXPECT_EQ(url.path, u8"jessica@example.com");
+
+	ASSERT_TRUE(jessilib::parse_url(url, u8"//example.com#top"sv));
+	EXPECT_FALSE(url.has_scheme());
+	EXPECT_EQ(url.authority, u8"example.com");
+	EXPECT_EQ(url.fragment, u8"top");
+}
+
+TEST(UrlParser, invalid_scheme) {
+	jessilib::url_view<char8_t> url;
+	EXPECT_FALSE(jessilib::parse_url(url, u8"1http://example.com"sv));
+	EXPECT_FALSE(jessilib::parse_url(url, u8"ht tp://example.com"sv));
+	EXPECT_TRUE(jessilib::parse_url(url, u8"svn+ssh://example.com"sv));
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/parallel_split.hpp"
+#include <random>
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+std::string make_lines(size_t in_count, std::string_view in_delim) {
+	std::mt19937 randgen(static_cast<unsigned int>(in_count));
+	std::string result;
+	for (size_t index = 0; index != in_count; ++index) {
+		result.append(randgen() % 24, static_cast<char>('a' + index % 26));
+		result += in_delim;
+	}
+
+	return result;
+}
+
+template<typename ChunksT>
+std::vector<std::string_view> flatten(const ChunksT& in_chunks) {
+	std::vector<std::string_view> result;
+	for (auto& chunk : in_chunks) {
+		result.insert(result.end(), chunk.begin(), chunk.end());
+	}
+
+	return result;
+}
+
+} // namespace
+
+TEST(ParallelSplitTest, chunks) {
+	thread_pool pool{ 3 };
+	std::string lines = make_lines(500, "\n"sv);
+	for (std::string_view input : { std::string_view{ lines }, std::string_view{ lines }.substr(0, lines.size() - 1), "\n\nab\n\n"sv, "abc"sv, "\n"sv }) {
+		for (size_t chunk_count = 1; chunk_count <= 8; ++chunk_count) {
+			auto chunks = parallel_split(pool, input, '\n', chunk_count);
+			EXPECT_LE(chunks.size(), chunk_count);
+			EXPECT_EQ(flatten(chunks), split_view(input, '\n')) << "chunk_count: " << chunk_count;
+		}
+	}
+
+	EXPECT_TRUE(parallel_split(pool, ""sv, '\n', 4).empty());
+}
+
+TEST(ParallelSplitTest, sequence_delimiter) {
+	thread_pool pool{ 2 };
+	std::string lines = make_lines(500, "\r\n"sv);
+	for (size_t chunk_count = 1; chunk_count <= 8; ++chunk_count) {
+		EXPECT_EQ(flatten(parallel_split(pool, lines, "\r\n"sv, chunk_count)), split_view(lines, "\r\n"sv));
+	}
+
+	// Delimiters which can overlap themselves are split as a single chunk
+	std::string overlapping = "aabaaabaabaabaa"s;
+	auto chunks = parallel_split(pool, overlapping, "aba"sv, 4);
+	EXPECT_EQ(chunks.size(), 1U);
+	EXPECT_EQ(flatten(chunks), split_view(overlapping, "aba"sv));
+}
+
+TEST(ParallelSplitTest, for_each) {
+	thread_pool pool{ 4 };
+	std::string lines = make_lines(10000, "\n"sv);
+	std::vector<std::string_view> tokens;
+	std::thread::id caller_id = std::this_thread::get_id();
+	parallel_split_for_each(pool, lines, '\n', [&tokens, caller_id](std::string_view in_token) {
+		EXPECT_EQ(std::this_thread::get_id(), caller_id);
+		tokens.push_back(in_token);
+	}, 16);
+
+	EXPECT_EQ(tokens, split_view(lines, '\n'));
+}
+
+TEST(ParallelSplitTest, for_each_throws) {
+	thread_pool pool{ 2 };
+	std::string lines = make_lines(1000, "\n"sv);
+	size_t calls{};
+	EXPECT_THROW(parallel_split_for_each(pool, lines, '\n', [&calls](std::string_view) {
+		if (++calls == 10) {
+			throw std::runtime_error{ "stop" };
+		}
+	}, 8), std::runtime_error);
+	EXPECT_EQ(calls, 10U);
+}
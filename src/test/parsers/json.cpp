@@ -67,6 +67,16 @@ TEST(JsonParser, serialize_string) {
 	EXPECT_EQ(parser.serialize<wchar_t>(u8"text"), LR"json("text")json");
 }
 
+TEST(JsonParser, serialize_string_invalid) {
+	json_parser parser;
+
+	// Serialization stops at the first invalid sequence
+	EXPECT_EQ(parser.serialize<char8_t>(u8"ab\xFF" u8"cd"), u8R"json("ab")json");
+	EXPECT_EQ(parser.serialize<char8_t>(u8"a\"b\xC3"), u8R"json("a\"b")json");
+	EXPECT_EQ(parser.serialize<char16_t>(u8"ab\xFF" u8"cd"), uR"json("ab")json");
+	EXPECT_EQ(parser.serialize<char8_t>(u8"\xFF"), u8R"json("")json");
+}
+
 TEST(JsonParser, serialize_array) {
 	json_parser parser;
 	std::vector<object> array {
@@ -320,3 +330,217 @@ TEST(JsonParser, serialize_fu32_string) {
 	std::string serialized_bytes = parser.serialize_bytes(u8R"json("text")json"sv, text_encoding::utf_32_foreign);
 	EXPECT_EQ(serialized_bytes, fu32text);
 }
+
+/** deserialize_json_iterative */
+
+TEST(JsonParser, deserialize_iterative_nested) {
+	constexpr std::u8string_view json_data = u8R"json({
+		"some_array" : [ 1, [ 2, [ ] ], { "some_key" : "text" } ],
+		"some_object" : { "some_null" : null, "some_bool" : true, "some_double" : 12.34 },
+		"some_empty_object" : {}
+	})json"sv;
+
+	object expected;
+	std::u8string_view recursive_view = json_data;
+	ASSERT_TRUE(deserialize_json(expected, recursive_view));
+
+	object obj;
+	std::u8string_view iterative_view = json_data;
+	ASSERT_TRUE(deserialize_json_iterative(obj, iterative_view));
+	EXPECT_TRUE(iterative_view.empty());
+	EXPECT_EQ(obj, expected);
+	EXPECT_EQ(obj[u8"some_array"][1][0], 2);
+	EXPECT_EQ(obj[u8"some_array"][2][u8"some_key"], u8"text");
+	EXPECT_EQ(obj[u8"some_object"].size(), 3U);
+	EXPECT_EQ(obj[u8"some_empty_object"].type(), object::type::map);
+}
+
+TEST(JsonParser, deserialize_iterative_scalar) {
+	object obj;
+	std::u16string_view u16text = uR"json(  "text" , "more")json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, u16text));
+	EXPECT_EQ(obj, u8"text"sv);
+	EXPECT_EQ(u16text, uR"json( , "more")json"sv);
+
+	std::u32string_view u32text = UR"json(-1234)json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, u32text));
+	EXPECT_EQ(obj, -1234);
+	EXPECT_TRUE(u32text.empty());
+}
+
+TEST(JsonParser, deserialize_iterative_invalid) {
+	json_parse_state state;
+	for (std::u8string_view json_data : { u8"[1,]"sv, u8"[1"sv, u8"[1 2]"sv, u8"{\"key\"}"sv, u8"{\"key\":1,}"sv,
+		u8"{\"key\":1"sv, u8"{key:1}"sv, u8"[tru]"sv, u8"["sv, u8"{"sv }) {
+		object obj{ u8"untouched"sv };
+		std::u8string_view read_view = json_data;
+		EXPECT_FALSE((deserialize_json_iterative<char8_t, false>(obj, read_view, state)));
+		EXPECT_EQ(obj, u8"untouched"sv);
+
+		read_view = json_data;
+		EXPECT_THROW((deserialize_json_iterative<char8_t, true>(obj, read_view, state)), std::invalid_argument);
+	}
+}
+
+TEST(JsonParser, deserialize_iterative_max_depth) {
+	std::u8string json_data = std::u8string(4, u8'[') + std::u8string(4, u8']');
+	object obj;
+	std::u8string_view read_view = json_data;
+	EXPECT_TRUE(deserialize_json_iterative(obj, read_view, 4));
+	EXPECT_EQ(obj[0][0][0].type(), object::type::array);
+	EXPECT_EQ(obj[0][0][0].size(), 0U);
+
+	read_view = json_data;
+	EXPECT_FALSE((deserialize_json_iterative<char8_t, false>(obj, read_view, 3)));
+
+	read_view = json_data;
+	EXPECT_THROW((deserialize_json_iterative<char8_t, true>(obj, read_view, 3)), std::invalid_argument);
+}
+
+TEST(JsonParser, deserialize_adversarial_depth) {
+	json_parser parser;
+
+	// Deep enough to overflow the stack if parsed recursively
+	std::u8string json_data = std::u8string(1'000'000, u8'[') + std::u8string(1'000'000, u8']');
+	EXPECT_THROW(parser.deserialize(std::u8string_view{ json_data }), std::invalid_argument);
+
+	json_data = std::u8string(json_default_max_depth, u8'[') + std::u8string(json_default_max_depth, u8']');
+	EXPECT_EQ(parser.deserialize(std::u8string_view{ json_data }).type(), object::type::array);
+}
+
+/** try_deserialize_json */
+
+TEST(JsonParser, try_deserialize_valid) {
+	json_parse_result result = try_deserialize_json(u8R"json({ "key" : [ 1, 2, 3 ] })json"sv);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(result.error, json_error::none);
+	EXPECT_EQ(result.value[u8"key"], (std::vector<int>{ 1, 2, 3 }));
+
+	result = try_deserialize_json(u8""sv);
+	EXPECT_TRUE(result);
+	EXPECT_TRUE(result.value.null());
+
+	// Trailing whitespace is fine
+	result = try_deserialize_json(u8" [ 1 ] \r\n\t"sv);
+	EXPECT_TRUE(result);
+	EXPECT_EQ(result.value, std::vector<int>{ 1 });
+}
+
+TEST(JsonParser, try_deserialize_errors) {
+	struct error_case {
+		std::u8string_view data;
+		json_error error;
+		size_t offset;
+	};
+
+	for (const error_case& test : {
+		error_case{ u8"[1,2"sv, json_error::unexpected_end, 4 },
+		error_case{ u8"[1,2 3]"sv, json_error::unexpected_token, 5 },
+		error_case{ u8"[1,]"sv, json_error::unexpected_token, 3 },
+		error_case{ u8"{\"key\" 1}"sv, json_error::unexpected_token, 7 },
+		error_case{ u8"{\"key\":1,2}"sv, json_error::unexpected_token, 9 },
+		error_case{ u8"{\"key"sv, json_error::invalid_string, 1 },
+		error_case{ u8"[\"\\q\"]"sv, json_error::invalid_string, 1 },
+		error_case{ u8"[0, -]"sv, json_error::invalid_number, 4 },
+		error_case{ u8"[true, nul]"sv, json_error::invalid_literal, 7 },
+		error_case{ u8"[[[]]]"sv, json_error::max_depth_exceeded, 2 },
+		error_case{ u8"[1] x"sv, json_error::unexpected_token, 4 },
+		error_case{ u8"{} {\"a\":1}"sv, json_error::unexpected_token, 3 },
+		error_case{ u8"1 2"sv, json_error::unexpected_token, 2 },
+		error_case{ u8"true false"sv, json_error::unexpected_token, 5 },
+		error_case{ u8"\"a\"b"sv, json_error::unexpected_token, 3 } }) {
+		json_parse_result result = try_deserialize_json(test.data, 2);
+		EXPECT_FALSE(result);
+		EXPECT_EQ(result.error, test.error) << reinterpret_cast<const char*>(test.data.data());
+		EXPECT_EQ(result.offset, test.offset) << reinterpret_cast<const char*>(test.data.data());
+		EXPECT_EQ(result.line, 1U);
+		EXPECT_EQ(result.column, test.offset + 1);
+	}
+}
+
+TEST(JsonParser, try_deserialize_line_column) {
+	json_parse_result result = try_deserialize_json(u8"{\n\t\"k\u00E9y\" : 1,\n\t\"\u00E9\" : tru\n}"sv);
+	EXPECT_EQ(result.error, json_error::invalid_literal);
+	EXPECT_EQ(result.line, 3U);
+	EXPECT_EQ(result.column, 8U);
+	EXPECT_EQ(result.offset, 23U);
+
+	result = try_deserialize_json(u"[\n1,\n\"\u00E9\" x]"sv);
+	EXPECT_EQ(result.error, json_error::unexpected_token);
+	EXPECT_EQ(result.line, 3U);
+	EXPECT_EQ(result.column, 5U);
+	EXPECT_EQ(result.offset, 9U * sizeof(char16_t));
+}
+
+TEST(JsonParser, try_deserialize_bytes) {
+	json_parser parser;
+	std::string fu16text = make_foreign_string(uR"json([ "text", )json"sv);
+	json_parse_result result = parser.try_deserialize_bytes(fu16text, text_encoding::utf_16_foreign);
+	EXPECT_EQ(result.error, json_error::unexpected_end);
+	EXPECT_EQ(result.offset, fu16text.size());
+
+	fu16text = make_foreign_string(uR"json([ "text" ])json"sv);
+	result = parser.try_deserialize_bytes(fu16text, text_encoding::utf_16_foreign);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(result.value, std::vector<object>{ u8"text" });
+}
+
+TEST(JsonParser, deserialize_map_no_exceptions) {
+	for (std::u8string_view json_data : { u8"{\"key\""sv, u8"{\"key\" 1}"sv, u8"{\"key\":1"sv }) {
+		object obj;
+		std::u8string_view read_view = json_data;
+		EXPECT_FALSE((deserialize_json<char8_t, false>(obj, read_view)));
+	}
+}
+
+TEST(JsonParser, deserialize_escaped_backslash) {
+	object obj;
+	std::u8string_view read_view = u8R"json([ "C:\\", "\\\"" ])json"sv;
+	EXPECT_TRUE(deserialize_json(obj, read_view));
+	EXPECT_EQ(obj, (std::vector<std::u8string>{ u8"C:\\", u8"\\\"" }));
+
+	std::u16string_view u16text = uR"json([ "C:\\", "\\\"" ])json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, u16text));
+	EXPECT_EQ(obj, (std::vector<std::u8string>{ u8"C:\\", u8"\\\"" }));
+}
+
+TEST(JsonParser, deserialize_u16_multibyte_string) {
+	object obj;
+	std::u16string_view u16text = uR"json([ "\u00e9t\u00e9", "\U0001f600" ])json"sv;
+	EXPECT_TRUE(deserialize_json(obj, u16text));
+	EXPECT_EQ(obj, (std::vector<std::u8string>{ u8"\u00e9t\u00e9", u8"\U0001f600" }));
+	EXPECT_TRUE(u16text.empty());
+}
+
+TEST(JsonParser, deserialize_interned_keys) {
+	json_parse_state state;
+	object obj;
+	std::u8string_view read_view = u8R"json([ { "id" : 1, "na\u006De" : "a" }, { "id" : 2, "name" : "b" } ])json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, read_view, state));
+	EXPECT_EQ(obj[1][u8"id"], 2);
+	EXPECT_EQ(obj[0][u8"name"], u8"a");
+	EXPECT_EQ(obj[1][u8"name"], u8"b");
+	EXPECT_EQ(state.keys.size(), 3U); // Escaped & unescaped "name" are interned separately
+
+	// Keys persist between parses, until the data's encoding changes
+	read_view = u8R"json({ "id" : 3 })json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, read_view, state));
+	EXPECT_EQ(obj[u8"id"], 3);
+	EXPECT_EQ(state.keys.size(), 3U);
+
+	std::u16string_view u16text = uR"json({ "id" : 4 })json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, u16text, state));
+	EXPECT_EQ(obj[u8"id"], 4);
+	EXPECT_EQ(state.keys.size(), 1U);
+}
+
+TEST(JsonParser, deserialize_interned_keys_full) {
+	json_parse_state state{ {}, json_key_pool{ 1 } };
+	object obj;
+	std::u8string_view read_view = u8R"json({ "a" : 1, "b" : 2, "c" : { "a" : 3, "d" : 4 } })json"sv;
+	EXPECT_TRUE(deserialize_json_iterative(obj, read_view, state));
+	EXPECT_EQ(obj[u8"b"], 2);
+	EXPECT_EQ(obj[u8"c"][u8"a"], 3);
+	EXPECT_EQ(obj[u8"c"][u8"d"], 4);
+	EXPECT_EQ(state.keys.size(), 1U);
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "test.hpp"
+#include "jessilib/parsers/json_literal.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+// Parses JSON at runtime, for comparison
+object parse(std::u8string_view in_json) {
+	json_parser parser;
+	return parser.deserialize(in_json);
+}
+
+} // namespace
+
+TEST(JsonLiteral, scalars) {
+	EXPECT_TRUE(json_literal_v<u8"null">.to_object().null());
+	EXPECT_EQ(json_literal_v<u8"true">.to_object(), true);
+	EXPECT_EQ(json_literal_v<u8" false ">.to_object(), false);
+	EXPECT_EQ(json_literal_v<u8"1234">.to_object(), 1234);
+	EXPECT_EQ(json_literal_v<u8"-1234">.to_object(), -1234);
+	EXPECT_EQ(json_literal_v<u8"-9223372036854775808">.to_object(), std::numeric_limits<intmax_t>::min());
+	EXPECT_EQ(json_literal_v<u8"12.5">.to_object(), 12.5L);
+	EXPECT_EQ(json_literal_v<u8"-0.25">.to_object(), -0.25L);
+	EXPECT_EQ(json_literal_v<u8R"json("text\twithéescapes")json">.to_object(), u8"text\twithéescapes"sv);
+	EXPECT_EQ(json_literal_v<u8R"json("")json">.to_object(), u8""sv);
+}
+
+TEST(JsonLiteral, containers) {
+	EXPECT_EQ(json_literal_v<u8"[]">.to_object(), object{ object::array_type{} });
+	EXPECT_EQ(json_literal_v<u8"{}">.to_object(), object{ object::map_type{} });
+	EXPECT_EQ(json_literal_v<u8"[ 1, [ 2, [] ], 3 ]">.to_object(), parse(u8"[ 1, [ 2, [] ], 3 ]"));
+}
+
+TEST(JsonLiteral, matches_runtime_parse) {
+	static constexpr auto s_literal = json_literal_v<u8R"json({
+		"name" : "jessilib",
+		"port" : 6667,
+		"ratio" : 0.75,
+		"enabled" : true,
+		"owner" : null,
+		"channels" : [ "#jessilib", "#test" ],
+		"nested" : { "key\"" : [ { "a" : 1 }, { "b" : [ 2, 3 ] } ] }
+	})json">;
+
+	// 1 root, 5 scalars, 1 + 2 channels, 1 nested + 1 array + 2 maps + 3 values
+	static_assert(s_literal.nodes.size() == 17);
+	static_assert(s_literal.nodes[0].type == object::type::map);
+	static_assert(s_literal.nodes[0].size == 7);
+
+	EXPECT_EQ(s_literal.to_object(), parse(u8R"json({
+		"name" : "jessilib",
+		"port" : 6667,
+		"ratio" : 0.75,
+		"enabled" : true,
+		"owner" : null,
+		"channels" : [ "#jessilib", "#test" ],
+		"nested" : { "key\"" : [ { "a" : 1 }, { "b" : [ 2, 3 ] } ] }
+	})json"));
+}
+
+TEST(JsonLiteral, duplicate_keys) {
+	// Last value wins, same as deserialize_json
+	object obj = json_literal_v<u8R"json({ "key" : 1, "key" : 2 })json">.to_object();
+	EXPECT_EQ(obj.size(), 1U);
+	EXPECT_EQ(obj[u8"key"], 2);
+}
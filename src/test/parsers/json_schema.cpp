@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "test.hpp"
+#include "jessilib/parsers/json_schema.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+json_schema make_schema(std::u8string_view in_schema) {
+	json_parser parser;
+	return json_schema{ parser.deserialize(in_schema) };
+}
+
+const json_schema& record_schema() {
+	static const json_schema s_schema = make_schema(u8R"json({
+		"type" : "object",
+		"required" : [ "id", "name" ],
+		"additionalProperties" : false,
+		"properties" : {
+			"id" : { "type" : "integer", "minimum" : 1, "maximum" : 1000 },
+			"name" : { "type" : "string" },
+			"kind" : { "enum" : [ "user", "bot" ] },
+			"ratio" : { "type" : "number", "maximum" : 1.0 },
+			"tags" : { "type" : "array", "minItems" : 1, "maxItems" : 3, "items" : { "type" : "string" } },
+			"extra" : { "type" : [ "object", "null" ] }
+		}
+	})json"sv);
+
+	return s_schema;
+}
+
+bool matches(std::u8string_view in_data) {
+	return static_cast<bool>(try_deserialize_json(in_data, record_schema()));
+}
+
+} // namespace
+
+TEST(JsonSchema, valid) {
+	EXPECT_TRUE(matches(u8R"json({ "id" : 1, "name" : "text" })json"sv));
+	EXPECT_TRUE(matches(u8R"json({ "name" : "text", "id" : 1000, "kind" : "bot", "ratio" : 0.5 })json"sv));
+	EXPECT_TRUE(matches(u8R"json({ "id" : 1, "name" : "text", "ratio" : 1, "tags" : [ "a", "b", "c" ] })json"sv));
+	EXPECT_TRUE(matches(u8R"json({ "id" : 1, "name" : "text", "extra" : { "anything" : [ 1, { "goes" : null } ] } })json"sv));
+	EXPECT_TRUE(matches(u8R"json({ "id" : 1, "name" : "text", "extra" : null })json"sv));
+}
+
+TEST(JsonSchema, type) {
+	EXPECT_FALSE(matches(u8R"json([ { "id" : 1, "name" : "text" } ])json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : "1", "name" : "text" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1.5, "name" : "text" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : [ "text" ] })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "tags" : [ 1 ] })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "extra" : [] })json"sv));
+}
+
+TEST(JsonSchema, required) {
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1 })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "name" : "text", "kind" : "user" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({})json"sv));
+}
+
+TEST(JsonSchema, additional_properties) {
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "unknown" : true })json"sv));
+}
+
+TEST(JsonSchema, enum_values) {
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "kind" : "admin" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "kind" : 1 })json"sv));
+}
+
+TEST(JsonSchema, range) {
+	EXPECT_FALSE(matches(u8R"json({ "id" : 0, "name" : "text" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1001, "name" : "text" })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "ratio" : 1.5 })json"sv));
+}
+
+TEST(JsonSchema, array_bounds) {
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "tags" : [] })json"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text", "tags" : [ "a", "b", "c", "d" ] })json"sv));
+}
+
+TEST(JsonSchema, trailing_data) {
+	EXPECT_TRUE(matches(u8"{ \"id\" : 1, \"name\" : \"text\" }\r\n"sv));
+	EXPECT_FALSE(matches(u8R"json({ "id" : 1, "name" : "text" } junk)json"sv));
+}
+
+TEST(JsonSchema, early_abort) {
+	// Violation is reported at the offending value, before the rest of the (invalid) data is parsed
+	std::u8string_view json_data = u8R"json({ "id" : 1, "name" : 2, this isn't even JSON )json"sv;
+	json_parse_result result = try_deserialize_json(json_data, record_schema());
+	EXPECT_EQ(result.error, json_error::schema_violation);
+	EXPECT_EQ(result.offset, json_data.find(u8'2'));
+
+	result = try_deserialize_json(u8R"json({ "id" : 1, "unknown" : 2 })json"sv, record_schema());
+	EXPECT_EQ(result.error, json_error::schema_violation);
+	EXPECT_EQ(result.offset, 12U);
+}
+
+TEST(JsonSchema, exceptions) {
+	json_schema_validator validator{ record_schema() };
+	json_parse_state state;
+	json_error error{};
+	object obj;
+	std::u8string_view read_view = u8R"json({ "id" : 1 })json"sv;
+	EXPECT_THROW((deserialize_json_iterative<char8_t, true>(obj, read_view, state, json_default_max_depth, error, validator)),
+		std::invalid_argument);
+
+	// Validator state is reset between parses
+	read_view = u8R"json({ "id" : 1, "name" : "text" })json"sv;
+	EXPECT_TRUE((deserialize_json_iterative<char8_t, true>(obj, read_view, state, json_default_max_depth, error, validator)));
+	EXPECT_EQ(obj[u8"name"], u8"text");
+}
+
+TEST(JsonSchema, invalid_schema) {
+	EXPECT_THROW(make_schema(u8R"json([])json"sv), std::invalid_argument);
+	EXPECT_THROW(make_schema(u8R"json({ "type" : "text" })json"sv), std::invalid_argument);
+	EXPECT_THROW(make_schema(u8R"json({ "minItems" : -1 })json"sv), std::invalid_argument);
+	EXPECT_THROW(make_schema(u8R"json({ "required" : [ 1 ] })json"sv), std::invalid_argument);
+}
@@ -0,0 +1,213 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/pattern_matcher.hpp"
+#include <random>
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+using char_types = ::testing::Types<char8_t, char16_t, char32_t>;
+
+template<typename T>
+class PatternMatcherTest : public ::testing::Test {
+public:
+};
+TYPED_TEST_SUITE(PatternMatcherTest, char_types);
+
+namespace {
+
+// Matches as (pattern, offset, length) tuples, in terms of UTF-32 offsets into in_text
+template<typename CharT>
+std::vector<std::tuple<size_t, size_t, size_t>> match_codepoints(const pattern_matcher& in_matcher, std::u32string_view in_text) {
+	auto text = string_cast<CharT>(in_text);
+	std::vector<std::tuple<size_t, size_t, size_t>> result;
+	in_matcher.match(std::basic_string_view<CharT>{ text }, [&](const pattern_matcher::match_type& in_match) {
+		std::basic_string_view<CharT> prefix{ text.data(), in_match.offset };
+		std::basic_string_view<CharT> matched{ text.data() + in_match.offset, in_match.length };
+		result.emplace_back(in_match.pattern, string_cast<char32_t>(prefix).size(), string_cast<char32_t>(matched).size());
+	});
+	return result;
+}
+
+template<typename CharT>
+std::u32string folded(std::basic_string_view<CharT> in_text) {
+	std::u32string result = string_cast<char32_t>(in_text);
+	for (char32_t& codepoint : result) {
+		codepoint = fold(codepoint);
+	}
+	return result;
+}
+
+} // namespace
+
+TYPED_TEST(PatternMatcherTest, overlapping) {
+	pattern_matcher matcher{ false };
+	size_t he = matcher.add(string_cast<TypeParam>(u8"he"sv));
+	size_t she = matcher.add(string_cast<TypeParam>(u8"she"sv));
+	size_t his = matcher.add(string_cast<TypeParam>(u8"his"sv));
+	size_t hers = matcher.add(string_cast<TypeParam>(u8"hers"sv));
+	EXPECT_TRUE(matcher.dirty());
+	matcher.rebuild();
+	EXPECT_FALSE(matcher.dirty());
+	EXPECT_EQ(matcher.size(), 4U);
+
+	using result_type = std::vector<std::tuple<size_t, size_t, size_t>>;
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"ushers"), (result_type{ { she, 1, 3 }, { he, 2, 2 }, { hers, 2, 4 } }));
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"Ünïcödé his\U0001F604hers"), (result_type{ { his, 8, 3 }, { he, 12, 2 }, { hers, 12, 4 } }));
+	EXPECT_TRUE(match_codepoints<TypeParam>(matcher, U"USHERS").empty());
+
+	auto text = string_cast<TypeParam>(u8"ushers"sv);
+	EXPECT_TRUE(matcher.contains(std::basic_string_view<TypeParam>{ text }));
+	EXPECT_FALSE(matcher.contains(std::basic_string_view<TypeParam>{ text }.substr(3)));
+}
+
+TYPED_TEST(PatternMatcherTest, long_patterns) {
+	// Patterns longer than what's tracked on the stack while matching
+	pattern_matcher matcher{ false };
+	std::u32string long_text(300, U'é');
+	size_t long_pattern = matcher.add(string_cast<TypeParam>(long_text.substr(0, 200)));
+	size_t short_pattern = matcher.add(string_cast<TypeParam>(U"éa"sv));
+	matcher.rebuild();
+
+	long_text += U'a';
+	auto result = match_codepoints<TypeParam>(matcher, long_text);
+	ASSERT_EQ(result.size(), 102U);
+	EXPECT_EQ(result.front(), std::make_tuple(long_pattern, size_t{ 0 }, size_t{ 200 }));
+	EXPECT_EQ(result[100], std::make_tuple(long_pattern, size_t{ 100 }, size_t{ 200 }));
+	EXPECT_EQ(result.back(), std::make_tuple(short_pattern, size_t{ 299 }, size_t{ 2 }));
+
+	matcher.clear();
+	matcher.add(string_cast<TypeParam>(U"é"sv));
+	matcher.rebuild();
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, long_text).size(), 300U);
+}
+
+TYPED_TEST(PatternMatcherTest, case_insensitive) {
+	pattern_matcher matcher;
+	size_t kelvin = matcher.add(string_cast<TypeParam>(u8"Kelvin"sv));
+	size_t sigma = matcher.add(string_cast<TypeParam>(u8"ΣΊΣΥΦΟΣ"sv));
+	size_t long_s = matcher.add(string_cast<TypeParam>(u8"ſ"sv));
+	matcher.rebuild();
+
+	using result_type = std::vector<std::tuple<size_t, size_t, size_t>>;
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"KELVIN kelvin"), (result_type{ { kelvin, 0, 6 }, { kelvin, 7, 6 } }));
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"σίσυφοσ"), (result_type{ { sigma, 0, 7 } }));
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"Sſs"), (result_type{ { long_s, 0, 1 }, { long_s, 1, 1 }, { long_s, 2, 1 } }));
+}
+
+TYPED_TEST(PatternMatcherTest, invalid) {
+	pattern_matcher matcher;
+	EXPECT_EQ(matcher.add(std::basic_string_view<TypeParam>{}), pattern_matcher::npos);
+	EXPECT_EQ(matcher.size(), 0U);
+
+	size_t pattern = matcher.add(string_cast<TypeParam>(u8"ab"sv));
+	EXPECT_FALSE(matcher.contains(std::basic_string_view<TypeParam>{ string_cast<TypeParam>(u8"ab"sv) })); // Not built yet
+	matcher.rebuild();
+
+	if constexpr (sizeof(TypeParam) == 1) {
+		std::u8string pattern_text{ u8"a" };
+		pattern_text += static_cast<char8_t>(0x80);
+		EXPECT_EQ(matcher.add(pattern_text), pattern_matcher::npos);
+
+		// Invalid sequences in the text interrupt matches, but don't otherwise throw things off
+		std::u8string text{ u8"a" };
+		text += static_cast<char8_t>(0x80);
+		text += u8"b ab";
+		auto matches = matcher.match(std::u8string_view{ text });
+		ASSERT_EQ(matches.size(), 1U);
+		EXPECT_EQ(matches[0].pattern, pattern);
+		EXPECT_EQ(matches[0].offset, 4U);
+		EXPECT_EQ(matches[0].length, 2U);
+	}
+}
+
+TYPED_TEST(PatternMatcherTest, incremental) {
+	pattern_matcher matcher;
+	size_t first = matcher.add(string_cast<TypeParam>(u8"first"sv));
+	matcher.rebuild();
+
+	using result_type = std::vector<std::tuple<size_t, size_t, size_t>>;
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"first second"), (result_type{ { first, 0, 5 } }));
+
+	size_t second = matcher.add(string_cast<TypeParam>(u8"second"sv));
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"first second"), (result_type{ { first, 0, 5 } })); // Not rebuilt yet
+	matcher.rebuild();
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"first second"), (result_type{ { first, 0, 5 }, { second, 6, 6 } }));
+
+	// Removal takes effect immediately
+	EXPECT_TRUE(matcher.remove(first));
+	EXPECT_FALSE(matcher.remove(first));
+	EXPECT_FALSE(matcher.remove(12345));
+	EXPECT_EQ(matcher.size(), 1U);
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"first second"), (result_type{ { second, 6, 6 } }));
+
+	// Ids remain stable when removed patterns are pruned
+	size_t third = matcher.add(string_cast<TypeParam>(u8"third"sv));
+	EXPECT_TRUE(matcher.remove(second));
+	matcher.rebuild();
+	EXPECT_EQ(match_codepoints<TypeParam>(matcher, U"first second third"), (result_type{ { third, 13, 5 } }));
+
+	matcher.clear();
+	matcher.rebuild();
+	EXPECT_TRUE(match_codepoints<TypeParam>(matcher, U"first second third").empty());
+}
+
+TYPED_TEST(PatternMatcherTest, many_patterns) {
+	// Compare against searching each pattern individually
+	std::u32string text;
+	for (size_t index = 0; index != 20; ++index) {
+		text += U"PRIVMSG #Jessilib :Ünïcödé text, \U0001F604 and ΣΊΣΥΦΟΣ K ſ; "s;
+		text += static_cast<char32_t>(U'a' + index % 26);
+	}
+	auto lhs_text = string_cast<TypeParam>(text);
+
+	pattern_matcher matcher;
+	std::vector<std::basic_string<TypeParam>> patterns;
+	std::mt19937 generator{ 1234 };
+	for (size_t index = 0; index != 200; ++index) {
+		std::u32string pattern = text.substr(generator() % text.size(), 1 + generator() % 12);
+		patterns.push_back(string_cast<TypeParam>(pattern));
+		EXPECT_EQ(matcher.add(patterns.back()), index);
+
+		// Rebuild as patterns are added, to exercise incremental rebuilds
+		if (index % 64 == 0) {
+			matcher.rebuild();
+		}
+	}
+	matcher.rebuild();
+
+	std::vector<size_t> expected_counts(patterns.size());
+	for (size_t index = 0; index != patterns.size(); ++index) {
+		std::basic_string_view<TypeParam> remainder{ lhs_text };
+		size_t position;
+		while ((position = findi(remainder, std::basic_string_view<TypeParam>{ patterns[index] })) != decltype(remainder)::npos) {
+			++expected_counts[index];
+			remainder.remove_prefix(position + 1);
+		}
+	}
+
+	std::vector<size_t> counts(patterns.size());
+	matcher.match(std::basic_string_view<TypeParam>{ lhs_text }, [&](const pattern_matcher::match_type& in_match) {
+		++counts[in_match.pattern];
+		EXPECT_EQ(folded(std::basic_string_view<TypeParam>{ lhs_text }.substr(in_match.offset, in_match.length)),
+			folded(std::basic_string_view<TypeParam>{ patterns[in_match.pattern] }));
+	});
+	EXPECT_EQ(counts, expected_counts);
+}
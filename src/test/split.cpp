@@ -16,6 +16,7 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <list>
 #include "test_split.hpp"
 
 using namespace jessilib;
@@ -47,6 +48,12 @@ public:
 };
 TYPED_TEST_SUITE(SplitNTest, char_types);
 
+template<typename T>
+class SplitRangeTest : public ::testing::Test {
+public:
+};
+TYPED_TEST_SUITE(SplitRangeTest, char_types);
+
 TYPED_TEST(SplitSVTest, empty) {
 	std::basic_string_view<TypeParam> empty;
 	std::vector<std::basic_string<TypeParam>> split_result = split(empty, default_delim<TypeParam>);
@@ -276,3 +283,103 @@ TYPED_TEST(SplitStringTest, random_long_prefix_two_delim) {
 	std::vector<std::basic_string<TypeParam>> split_result = split(data.m_str, delim);
 	EXPECT_EQ(split_result, data.m_tokens);
 }
+
+/** SplitRangeTest */
+
+static_assert(std::ranges::view<decltype(split_range("a b"sv, ' '))>);
+static_assert(std::ranges::forward_range<decltype(split_range("a b"sv, " "sv))>);
+
+TYPED_TEST(SplitRangeTest, random) {
+	RandomTestData<TypeParam> data{};
+	std::vector<std::basic_string<TypeParam>> tokens;
+	for (std::basic_string_view<TypeParam> token : split_range(data.m_str, default_delim<TypeParam>)) {
+		tokens.emplace_back(token);
+	}
+
+	EXPECT_EQ(tokens, data.m_tokens);
+}
+
+TYPED_TEST(SplitRangeTest, random_long) {
+	auto delim = make_delim_long<TypeParam>();
+	RandomTestData<TypeParam> data{ delim };
+	data.m_str += delim;
+	data.m_tokens.emplace_back();
+	std::vector<std::basic_string<TypeParam>> tokens;
+	for (std::basic_string_view<TypeParam> token : split_range(data.m_str, delim)) {
+		tokens.emplace_back(token);
+	}
+
+	EXPECT_EQ(tokens, data.m_tokens);
+}
+
+TYPED_TEST(SplitRangeTest, take) {
+	RandomTestData<TypeParam> data{};
+	constexpr size_t n = 3;
+	auto range = split_range(data.m_str, default_delim<TypeParam>) | std::views::take(n);
+	size_t index = 0;
+	for (auto token : range) {
+		EXPECT_EQ(token, data.m_tokens[index]);
+		++index;
+	}
+	EXPECT_EQ(index, n);
+
+	// Remainder is available from the iterator, as with split_n
+	auto tokens = split_range(data.m_str, default_delim<TypeParam>);
+	auto split_itr = tokens.begin();
+	std::ranges::advance(split_itr, n);
+	EXPECT_EQ(std::basic_string<TypeParam>(split_itr.base(), data.m_str.cend()), data.get_remainder(n));
+}
+
+TEST(SplitRangeTest, edges) {
+	EXPECT_TRUE(split_range(""sv, ' ').empty());
+	EXPECT_TRUE(split_range(""sv, "ab"sv).empty());
+	EXPECT_EQ(std::ranges::distance(split_range(" "sv, ' ')), 2);
+	EXPECT_EQ(std::ranges::distance(split_range("abab"sv, "ab"sv)), 3);
+	EXPECT_EQ(split_range("abc"sv, ""sv).front(), "abc"sv);
+	EXPECT_EQ(split_range("a"sv, "abc"sv).front(), "a"sv);
+}
+
+TEST(SplitTest, mixed_iterators) {
+	// An iterator and a const_iterator may be passed together
+	std::string input = "a b  c"s;
+	std::string delim = "  "s;
+	std::vector<std::string> expected{ "a", "b", "", "c" };
+	EXPECT_EQ(split(input.cbegin(), input.end(), ' '), expected);
+	EXPECT_EQ(split(input.begin(), input.cend(), ' '), expected);
+	EXPECT_EQ(split(input.begin(), input.cend(), delim.cbegin(), delim.end()), (std::vector<std::string>{ "a b", "c" }));
+	EXPECT_EQ(split_n(input.cbegin(), input.end(), ' ', 1), (std::vector<std::string>{ "a", "b  c" }));
+	EXPECT_EQ(split_n(input.begin(), input.cend(), delim.begin(), delim.cend(), 1), (std::vector<std::string>{ "a b", "c" }));
+	EXPECT_EQ(std::ranges::distance(split_range(input.begin(), input.cend(), ' ')), 4);
+}
+
+TEST(SplitRangeTest, list) {
+	// Non-contiguous ranges yield subranges
+	std::list<int> list{ 1, 2, 0, 3, 0, 0 };
+	std::vector<std::vector<int>> tokens;
+	for (auto token : split_range(list, 0)) {
+		tokens.emplace_back(token.begin(), token.end());
+	}
+
+	EXPECT_EQ(tokens, (std::vector<std::vector<int>>{ { 1, 2 }, { 3 }, {}, {} }));
+}
+
+TEST(SplitRangeTest, constexpr_evaluation) {
+	constexpr size_t tokens = std::ranges::distance(split_range("a,b,,c"sv, ','));
+	EXPECT_EQ(tokens, 4U);
+}
+
+TEST(SplitRangeTest, periodic_delimiters) {
+	// Delimiters with repeating prefixes, which a naive search handles by backtracking
+	std::string input = "aaabaaabaab,abababab,aabaabaab"s;
+	for (std::string_view delim : { "aab"sv, "abab"sv, "aabaab"sv, "baaab"sv, "aaaa"sv, "ba"sv }) {
+		std::vector<std::string_view> expected;
+		size_t begin = 0;
+		for (size_t match = input.find(delim); match != std::string::npos; match = input.find(delim, begin)) {
+			expected.push_back(std::string_view{ input }.substr(begin, match - begin));
+			begin = match + delim.size();
+		}
+		expected.push_back(std::string_view{ input }.substr(begin));
+
+		EXPECT_EQ(split_view(input, delim), expected) << delim;
+	}
+}
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/syntax_tree_profile.hpp"
+#include "jessilib/unicode_syntax.hpp"
+#include "jessilib/object.hpp"
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+// Counts sums; "1+2+(3+4)"
+struct sum_context {
+	size_t terms{};
+};
+
+struct profiled_sum_context : sum_context {};
+
+template<typename ContextT>
+size_t term_action(ContextT& inout_context, std::u8string_view&) {
+	++inout_context.terms;
+	return 0;
+}
+
+template<typename ContextT>
+size_t group_end_action(ContextT&, std::u8string_view&) {
+	return 1;
+}
+
+template<typename ContextT>
+constexpr syntax_tree<char8_t, ContextT> group_tree{
+	{ U')', group_end_action<ContextT> },
+	{ U'+', term_action<ContextT> }
+};
+
+template<typename ContextT>
+constexpr syntax_tree<char8_t, ContextT> sum_tree{
+	make_tree_pair<char8_t, ContextT, U'(', group_tree<ContextT>, std::size(group_tree<ContextT>), noop_action<char8_t, ContextT>>(),
+	{ U'+', term_action<ContextT> }
+};
+
+template<typename ContextT>
+bool apply_sum(ContextT& inout_context, std::u8string_view in_expression) {
+	return apply_syntax_tree<char8_t, ContextT, sum_tree<ContextT>, std::size(sum_tree<ContextT>)>(inout_context, in_expression);
+}
+
+} // namespace
+
+template<>
+struct jessilib::syntax_tree_profiling<profiled_sum_context> {
+	static constexpr bool enabled = true;
+};
+
+TEST(SyntaxTreeProfileTest, counters) {
+	syntax_tree_profile profile;
+	profiled_sum_context context;
+	{
+		syntax_tree_profile::scope profile_scope{ profile };
+		EXPECT_EQ(syntax_tree_profile::current(), &profile);
+		EXPECT_TRUE(apply_sum(context, u8"1+2+(3+4)+5"sv));
+	}
+	EXPECT_EQ(syntax_tree_profile::current(), nullptr);
+	EXPECT_EQ(context.terms, 4U);
+
+	auto& trees = profile.trees();
+	ASSERT_EQ(trees.size(), 2U);
+
+	auto& sum_counters = trees.at(sum_tree<profiled_sum_context>);
+	EXPECT_EQ(sum_counters.members.size(), 2U);
+	EXPECT_EQ(sum_counters.members.at(U'+').invocations, 3U);
+	EXPECT_EQ(sum_counters.members.at(U'+').bytes, 3U);
+	EXPECT_EQ(sum_counters.members.at(U'(').invocations, 1U);
+	EXPECT_EQ(sum_counters.members.at(U'(').bytes, 5U); // "(3+4)", including the nested tree
+	EXPECT_EQ(sum_counters.default_action.invocations, 3U); // "1", "2", "5"
+	EXPECT_EQ(sum_counters.default_action.bytes, 3U);
+
+	auto& group_counters = trees.at(group_tree<profiled_sum_context>);
+	EXPECT_EQ(group_counters.members.at(U'+').invocations, 1U);
+	EXPECT_EQ(group_counters.members.at(U')').invocations, 1U);
+	EXPECT_EQ(group_counters.default_action.invocations, 2U);
+
+	// Nothing is recorded without an active profile
+	EXPECT_TRUE(apply_sum(context, u8"1+2"sv));
+	EXPECT_EQ(trees.at(sum_tree<profiled_sum_context>).members.at(U'+').invocations, 3U);
+
+	profile.clear();
+	EXPECT_TRUE(profile.trees().at(sum_tree<profiled_sum_context>).members.empty());
+}
+
+TEST(SyntaxTreeProfileTest, disabled) {
+	static_assert(!syntax_tree_profiling_v<sum_context> || syntax_tree_profiling_v<profiled_sum_context>);
+
+	syntax_tree_profile profile;
+	sum_context context;
+	syntax_tree_profile::scope profile_scope{ profile };
+	EXPECT_TRUE(apply_sum(context, u8"1+2+(3+4)+5"sv));
+	EXPECT_EQ(context.terms, 4U);
+	if constexpr (!syntax_tree_profiling_v<sum_context>) {
+		EXPECT_TRUE(profile.trees().empty());
+	}
+}
+
+TEST(SyntaxTreeProfileTest, to_object) {
+	syntax_tree_profile profile;
+	profile.set_tree_name(sum_tree<profiled_sum_context>, u8"sum");
+	profiled_sum_context context;
+	{
+		syntax_tree_profile::scope profile_scope{ profile };
+		EXPECT_TRUE(apply_sum(context, u8"12+(3)"sv));
+	}
+
+	object result = profile.to_object();
+	EXPECT_EQ(result.size(), 2U);
+	EXPECT_EQ(result[u8"sum"s][u8"+"s][u8"invocations"s].get<size_t>(), 1U);
+	EXPECT_EQ(result[u8"sum"s][u8"("s][u8"bytes"s].get<size_t>(), 3U);
+	EXPECT_EQ(result[u8"sum"s][u8"default_action"s][u8"invocations"s].get<size_t>(), 2U);
+	EXPECT_EQ(result[u8"sum"s][u8"default_action"s][u8"bytes"s].get<size_t>(), 2U);
+	EXPECT_TRUE(result[u8"sum"s][u8"default_action"s][u8"nanoseconds"s].has<intmax_t>());
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#pragma once
+
+#include <random>
+#include <span>
+#include "jessilib/unicode.hpp" // string_cast
+#include "jessilib/unicode_sequence.hpp"
+#include "test.hpp"
+
+/**
+ * Expects that skipping between triggers (apply_shrink_sequence_tree_runs) matches decoding every codepoint
+ * (apply_shrink_sequence_tree_codepoints), on random concatenations of in_pieces; including around block boundaries, and
+ * with invalid UTF-8 mixed in for byte strings
+ *
+ * @param in_pieces Pieces to concatenate; converted to CharT with string_cast
+ */
+template<typename CharT, const jessilib::shrink_sequence_tree<CharT> TreeBegin, size_t TreeSize>
+void expect_shrink_sequence_runs_match(std::span<const std::u8string_view> in_pieces) {
+	std::mt19937 generator{ 1234 };
+	for (size_t iteration = 0; iteration != 2000; ++iteration) {
+		std::basic_string<CharT> string;
+		size_t piece_count = generator() % 16;
+		for (size_t index = 0; index != piece_count; ++index) {
+			string += jessilib::string_cast<CharT>(in_pieces[generator() % in_pieces.size()]);
+		}
+		if constexpr (sizeof(CharT) == 1) {
+			if (generator() % 8 == 0) {
+				// Invalid UTF-8
+				string.insert(generator() % (string.size() + 1), 1, static_cast<CharT>(0x80));
+			}
+		}
+
+		auto runs_string = string;
+		auto codepoints_string = string;
+		EXPECT_EQ((jessilib::impl_unicode::apply_shrink_sequence_tree_runs<CharT, TreeBegin, TreeSize>(runs_string)),
+			(jessilib::impl_unicode::apply_shrink_sequence_tree_codepoints<CharT, TreeBegin, TreeSize>(codepoints_string)));
+		EXPECT_EQ(runs_string, codepoints_string);
+	}
+}
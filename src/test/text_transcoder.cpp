@@ -0,0 +1,214 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/text_transcoder.hpp"
+#include "jessilib/unicode.hpp"
+#include "jessilib/util.hpp"
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+namespace {
+
+constexpr text_encoding utf_encodings[]{
+	text_encoding::utf_8,
+	text_encoding::utf_16_little,
+	text_encoding::utf_16_big,
+	text_encoding::utf_32_little,
+	text_encoding::utf_32_big,
+	text_encoding::wchar
+};
+
+template<typename CharT>
+std::string to_bytes(const std::basic_string<CharT>& in_string, bool in_swap) {
+	std::string result{ reinterpret_cast<const char*>(in_string.data()), in_string.size() * sizeof(CharT) };
+	if (in_swap) {
+		string_byteswap<CharT>(result);
+	}
+	return result;
+}
+
+// Encodes in_string as raw bytes in in_encoding
+std::string encode(std::u32string_view in_string, text_encoding in_encoding) {
+	bool swap = in_encoding == text_encoding::utf_16_foreign || in_encoding == text_encoding::utf_32_foreign;
+	switch (in_encoding) {
+		case text_encoding::utf_8:
+			return to_bytes(string_cast<char8_t>(in_string), false);
+		case text_encoding::utf_16_little:
+		case text_encoding::utf_16_big:
+			return to_bytes(string_cast<char16_t>(in_string), swap);
+		case text_encoding::utf_32_little:
+		case text_encoding::utf_32_big:
+			return to_bytes(string_cast<char32_t>(in_string), swap);
+		case text_encoding::wchar:
+			return to_bytes(string_cast<wchar_t>(in_string), false);
+		default:
+			return {};
+	}
+}
+
+// Feeds in_data through in_transcoder in chunks of in_chunk_size bytes, with an output buffer of in_buffer_size bytes
+std::string transcode_chunked(text_transcoder& in_transcoder, std::string_view in_data, size_t in_chunk_size, size_t in_buffer_size) {
+	std::string result;
+	std::string buffer(in_buffer_size, '\0');
+	while (!in_data.empty()) {
+		std::string_view chunk = in_data.substr(0, in_chunk_size);
+		in_data.remove_prefix(chunk.size());
+		while (true) {
+			auto transcode_result = in_transcoder.transcode(chunk, buffer.data(), buffer.size());
+			result.append(buffer.data(), transcode_result.produced);
+			chunk.remove_prefix(transcode_result.consumed);
+			if (transcode_result.state == text_transcoder::status::complete) {
+				break;
+			}
+
+			EXPECT_EQ(transcode_result.state, text_transcoder::status::output_full);
+			if (transcode_result.state != text_transcoder::status::output_full) {
+				return result;
+			}
+		}
+	}
+
+	text_transcoder::result_type finish_result;
+	while ((finish_result = in_transcoder.finish(buffer.data(), buffer.size())).state == text_transcoder::status::output_full) {
+		result.append(buffer.data(), finish_result.produced);
+	}
+	result.append(buffer.data(), finish_result.produced);
+	EXPECT_EQ(finish_result.state, text_transcoder::status::complete);
+	return result;
+}
+
+} // namespace
+
+TEST(TextTranscoderTest, all_encodings) {
+	std::u32string text;
+	for (size_t index = 0; index != 20; ++index) {
+		text += U"PRIVMSG #Jessilib :Ünïcödé text, \U0001F604 and ΣΊΣΥΦΟΣ; 한국어 "s;
+	}
+
+	for (text_encoding read_encoding : utf_encodings) {
+		std::string input = encode(text, read_encoding);
+		for (text_encoding write_encoding : utf_encodings) {
+			std::string expected = encode(text, write_encoding);
+			text_transcoder transcoder{ read_encoding, write_encoding };
+			EXPECT_EQ(transcode_chunked(transcoder, input, input.size(), 4096), expected);
+			EXPECT_EQ(transcode_chunked(transcoder, input, 1, 4096), expected);
+			EXPECT_EQ(transcode_chunked(transcoder, input, 3, 4), expected);
+			EXPECT_EQ(transcode_chunked(transcoder, input, 7, 5), expected);
+			EXPECT_EQ(transcode_chunked(transcoder, input, 1000, 37), expected);
+		}
+	}
+}
+
+TEST(TextTranscoderTest, min_buffer_size) {
+	// Every sequence fits in a min_buffer_size buffer
+	std::u32string text = U"a\u00FC\u20AC\U0001F604";
+	for (text_encoding read_encoding : utf_encodings) {
+		for (text_encoding write_encoding : utf_encodings) {
+			text_transcoder transcoder{ read_encoding, write_encoding, true };
+			EXPECT_EQ(transcode_chunked(transcoder, encode(text, read_encoding), 1, text_transcoder::min_buffer_size),
+				encode(text, write_encoding));
+		}
+	}
+
+	text_transcoder multibyte_transcoder{ text_encoding::utf_8, text_encoding::multibyte, true };
+	EXPECT_FALSE(transcode_chunked(multibyte_transcoder, encode(text, text_encoding::utf_8), 1, text_transcoder::min_buffer_size).empty());
+
+	// Smaller buffers may never make progress
+	char buffer[3];
+	text_transcoder transcoder{ text_encoding::utf_8, text_encoding::utf_32_little };
+	auto result = transcoder.transcode("a"sv, buffer, sizeof(buffer));
+	EXPECT_EQ(result.state, text_transcoder::status::output_full);
+	EXPECT_EQ(result.consumed, 0U);
+	EXPECT_EQ(result.produced, 0U);
+}
+
+TEST(TextTranscoderTest, held_back) {
+	text_transcoder transcoder{ text_encoding::utf_8, text_encoding::utf_16_big };
+	char buffer[16];
+	std::string_view euro = "\xE2\x82\xAC"sv;
+
+	auto result = transcoder.transcode(euro.substr(0, 2), buffer, sizeof(buffer));
+	EXPECT_EQ(result.state, text_transcoder::status::complete);
+	EXPECT_EQ(result.consumed, 2U);
+	EXPECT_EQ(result.produced, 0U);
+	EXPECT_EQ(transcoder.pending(), 2U);
+
+	result = transcoder.transcode(euro.substr(2), buffer, sizeof(buffer));
+	EXPECT_EQ(result.state, text_transcoder::status::complete);
+	EXPECT_EQ(result.consumed, 1U);
+	ASSERT_EQ(result.produced, 2U);
+	EXPECT_EQ(std::string_view(buffer, 2), "\x20\xAC"sv);
+	EXPECT_EQ(transcoder.pending(), 0U);
+
+	// Output which doesn't fit isn't consumed
+	result = transcoder.transcode(euro, buffer, 1);
+	EXPECT_EQ(result.state, text_transcoder::status::output_full);
+	EXPECT_EQ(result.consumed, 0U);
+	EXPECT_EQ(result.produced, 0U);
+}
+
+TEST(TextTranscoderTest, invalid) {
+	char buffer[16];
+	text_transcoder transcoder{ text_encoding::utf_8, text_encoding::utf_8 };
+	std::string_view input = "a\x80" "b"sv;
+	auto result = transcoder.transcode(input, buffer, sizeof(buffer));
+	EXPECT_EQ(result.state, text_transcoder::status::invalid);
+	EXPECT_EQ(result.consumed, 2U);
+	EXPECT_EQ(result.produced, 1U);
+	result = transcoder.transcode(input.substr(result.consumed), buffer, sizeof(buffer));
+	EXPECT_EQ(result.state, text_transcoder::status::complete);
+	EXPECT_EQ(result.produced, 1U);
+
+	// Invalid sequences are caught across chunks, as well as ones which are truncated by the end of the stream
+	EXPECT_EQ(transcoder.transcode("\xE0"sv, buffer, sizeof(buffer)).state, text_transcoder::status::complete);
+	EXPECT_EQ(transcoder.transcode("\x80"sv, buffer, sizeof(buffer)).state, text_transcoder::status::invalid);
+	EXPECT_EQ(transcoder.transcode("\xE2\x82"sv, buffer, sizeof(buffer)).state, text_transcoder::status::complete);
+	EXPECT_EQ(transcoder.finish(buffer, sizeof(buffer)).state, text_transcoder::status::invalid);
+	EXPECT_EQ(transcoder.pending(), 0U);
+
+	// Lone surrogates
+	text_transcoder utf16_transcoder{ text_encoding::utf_16_foreign, text_encoding::utf_8 };
+	EXPECT_EQ(utf16_transcoder.transcode(encode(U"a", text_encoding::utf_16_foreign) + "\xDC\x00\xDC\x00"s, buffer,
+		sizeof(buffer)).state, text_transcoder::status::invalid);
+}
+
+TEST(TextTranscoderTest, replace_invalid) {
+	text_transcoder transcoder{ text_encoding::utf_8, text_encoding::utf_32_foreign, true };
+	std::string input = "a\x80" "b\xED\xA0\x80" "c\xF0\x9F\x98"s;
+	std::string expected = encode(U"a�b���c�", text_encoding::utf_32_foreign);
+	EXPECT_EQ(transcode_chunked(transcoder, input, input.size(), 64), expected);
+	EXPECT_EQ(transcode_chunked(transcoder, input, 1, 4), expected);
+}
+
+TEST(TextTranscoderTest, unknown_encoding) {
+	EXPECT_THROW(text_transcoder(text_encoding::unknown, text_encoding::utf_8), std::invalid_argument);
+	EXPECT_THROW(text_transcoder(text_encoding::utf_8, text_encoding::unknown), std::invalid_argument);
+}
+
+TEST(TextTranscoderTest, multibyte) {
+	// ASCII is representable in every locale, including "C"
+	text_transcoder read_transcoder{ text_encoding::multibyte, text_encoding::utf_16_big };
+	EXPECT_EQ(transcode_chunked(read_transcoder, "PRIVMSG #Jessilib :Hello"sv, 5, 7),
+		encode(U"PRIVMSG #Jessilib :Hello", text_encoding::utf_16_big));
+
+	text_transcoder write_transcoder{ text_encoding::utf_32_little, text_encoding::multibyte };
+	EXPECT_EQ(transcode_chunked(write_transcoder, encode(U"PRIVMSG #Jessilib :Hello", text_encoding::utf_32_little), 3, 2),
+		"PRIVMSG #Jessilib :Hello"s);
+}
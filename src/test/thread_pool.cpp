@@ -101,3 +101,23 @@ TEST(ThreadPoolTest, deadlockMultiThread) {
 	pool.join();
 	EXPECT_EQ(iterations, total_iterations);
 }
+
+TEST(ThreadPoolTest, waitWithoutJoin) {
+	// Tasks must run without a join() to flush them out, however they're pushed relative to threads going idle
+	thread_pool pool{ 3 };
+	repeat (total_iterations) {
+		std::mutex mutex;
+		std::condition_variable notifier;
+		size_t completed{};
+		repeat (4) {
+			pool.push([&]() {
+				std::lock_guard<std::mutex> guard(mutex);
+				++completed;
+				notifier.notify_all();
+			});
+		}
+
+		std::unique_lock<std::mutex> guard(mutex);
+		ASSERT_TRUE(notifier.wait_for(guard, 10s, [&completed]() { return completed == 4; }));
+	}
+}
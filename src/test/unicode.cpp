@@ -19,7 +19,10 @@
 #include "jessilib/unicode.hpp"
 #include <fstream>
 #include <charconv>
+#include <clocale>
 #include <algorithm>
+#include <random>
+#include <unordered_map>
 #include "jessilib/split.hpp"
 #include "test.hpp"
 
@@ -129,6 +132,89 @@ TEST(UTF32Test, decode_codepoint) {
 	DECODE_CODEPOINT_TEST(U"\U0001F604"sv, U'\U0001F604', 1U);
 }
 
+/** find_invalid */
+
+TEST(UTF8Test, find_invalid) {
+	auto bytes = [](std::initializer_list<unsigned int> in_bytes) {
+		std::u8string result;
+		for (unsigned int byte : in_bytes) {
+			result += static_cast<char8_t>(byte);
+		}
+		return result;
+	};
+
+	EXPECT_EQ(find_invalid(u8""sv), std::u8string_view::npos);
+	EXPECT_EQ(find_invalid(u8"Just some ASCII text, long enough to skip over a few words"sv), std::u8string_view::npos);
+	EXPECT_EQ(find_invalid(u8"\u0080\u07FF\u0800\uD7FF\uE000\uFFFF\U00010000\U0010FFFF\U0001F604 text"sv), std::u8string_view::npos);
+	EXPECT_TRUE(is_valid(u8"ASCII then \u65E5\u672C\u8A9E"sv));
+
+	EXPECT_EQ(find_invalid(bytes({ 'a', 0x80 })), 1U); // Lone continuation byte
+	EXPECT_EQ(find_invalid(bytes({ 'a', 'b', 0xC3 })), 2U); // Truncated sequence
+	EXPECT_EQ(find_invalid(bytes({ 0xC3, 'a' })), 0U); // Missing continuation byte
+	EXPECT_EQ(find_invalid(bytes({ 0xC0, 0xAF })), 0U); // Overlong '/'
+	EXPECT_EQ(find_invalid(bytes({ 0xE0, 0x80, 0xAF })), 0U); // Overlong '/'
+	EXPECT_EQ(find_invalid(bytes({ 0xF0, 0x80, 0x80, 0xAF })), 0U); // Overlong '/'
+	EXPECT_EQ(find_invalid(bytes({ 0xED, 0xA0, 0x80 })), 0U); // U+D800
+	EXPECT_EQ(find_invalid(bytes({ 0xF4, 0x90, 0x80, 0x80 })), 0U); // U+110000
+	EXPECT_EQ(find_invalid(bytes({ 0xF8, 0x88, 0x80, 0x80, 0x80 })), 0U); // 5 byte sequence
+	EXPECT_FALSE(is_valid(bytes({ 0xFF })));
+
+	// Invalid data after a run of ASCII long enough to be skipped in bulk
+	std::u8string text = u8"0123456789abcdef\u00E9"s + bytes({ 0xE2, 0x82 }) + u8"0123456789"s;
+	EXPECT_EQ(find_invalid(text), 18U);
+	EXPECT_EQ(find_invalid(std::u8string_view{ text }.substr(0, 18)), std::u8string_view::npos);
+}
+
+TEST(UTF8Test, find_invalid_blocks) {
+	// Compare against the scalar implementation with invalid data at & around block boundaries
+	std::mt19937 generator{ 1234 };
+	std::u8string valid_text = u8"ASCII \u00E9 \u65E5\u672C\u8A9E \U0001F604 \uFFFF \u0800 more ASCII text, and then some"s;
+	for (size_t iteration = 0; iteration != 20000; ++iteration) {
+		std::u8string text = valid_text;
+		size_t position = generator() % text.size();
+		uint32_t value = generator() | 0x80808080;
+		for (size_t index = 0; index != 4 && position + index < text.size(); ++index) {
+			text[position + index] = static_cast<char8_t>(value >> (8 * index));
+		}
+
+		std::u8string_view text_view = text;
+		text_view.remove_prefix(generator() % 4); // Vary alignment against block boundaries
+		EXPECT_EQ(find_invalid(text_view), impl_unicode::find_invalid_utf8_scalar(text_view)) << iteration;
+	}
+}
+
+TEST(UTF16Test, find_invalid) {
+	EXPECT_EQ(find_invalid(u""sv), std::u16string_view::npos);
+	EXPECT_EQ(find_invalid(u"ASCII \u65E5\u672C\u8A9E \U0001F604 \U0010FFFF text"sv), std::u16string_view::npos);
+
+	std::u16string text = u"0123456789";
+	text += char16_t{ 0xDC00 }; // Low surrogate without high surrogate
+	EXPECT_EQ(find_invalid(text), 10U);
+
+	text = u"0123456789";
+	text += char16_t{ 0xD800 }; // High surrogate without low surrogate
+	text += u"abc";
+	EXPECT_EQ(find_invalid(text), 10U);
+
+	text = u"01234";
+	text += char16_t{ 0xD800 }; // High surrogate at end of data
+	EXPECT_EQ(find_invalid(text), 5U);
+	EXPECT_FALSE(is_valid(text));
+}
+
+TEST(UTF32Test, find_invalid) {
+	EXPECT_EQ(find_invalid(U"ASCII \u65E5 \U0001F604 \U0010FFFF"sv), std::u32string_view::npos);
+
+	std::u32string text = U"abc";
+	text += char32_t{ 0xD800 };
+	EXPECT_EQ(find_invalid(text), 3U);
+
+	text = U"abc";
+	text += char32_t{ 0x110000 };
+	EXPECT_EQ(find_invalid(text), 3U);
+	EXPECT_FALSE(is_valid(text));
+}
+
 #ifdef JESSILIB_CHAR_AS_UTF8
 using char_type_combos = ::testing::Types<
 	std::pair<char, char>, std::pair<char, char8_t>, std::pair<char, char16_t>, std::pair<char, char32_t>,
@@ -163,6 +249,53 @@ TYPED_TEST(UnicodeFullTest, string_cast) {
 	EXPECT_TRUE(is_valid(abcd_string_view));
 }
 
+TYPED_TEST(UnicodeFullTest, string_cast_mixed) {
+	using InCharT = typename TypeParam::first_type;
+	using OutCharT = typename TypeParam::second_type;
+
+	// Long enough to hit block copies, with re-encoded codepoints on either side of block boundaries
+	std::u32string expected;
+	for (size_t index = 0; index != 16; ++index) {
+		expected += U"ASCII text, long enough for a few blocks"sv.substr(index);
+		expected += U"日本語のテキスト한국어"sv.substr(0, index % 5);
+		expected += U"\U0001F600é"sv.substr(index % 2);
+	}
+
+	auto in_str = string_cast<InCharT>(expected);
+	auto out_str = string_cast<OutCharT>(in_str);
+	EXPECT_EQ(string_cast<char32_t>(out_str), expected);
+	EXPECT_LE(out_str.size(), transcode_length<OutCharT>(std::basic_string_view<InCharT>{ in_str }));
+	EXPECT_LE(out_str.size(), (transcode_max_length<OutCharT, InCharT>(in_str.size())));
+}
+
+TEST(UTF8Test, transcode_invalid) {
+	char16_t buffer[8]{};
+	EXPECT_EQ(transcode(buffer, u8"AB\xC0"sv), std::u16string_view::npos);
+	EXPECT_EQ(transcode(buffer, u8"AB\x80"sv), std::u16string_view::npos);
+	EXPECT_TRUE(string_cast<char16_t>(u8"ABCDEFGH\xFF"sv).empty());
+	EXPECT_EQ(transcode(buffer, u8"AB\xC3\xA9"sv), 3U);
+	EXPECT_EQ((std::u16string_view{ buffer, 3 }), u"ABé"sv);
+}
+
+TEST(UTF8Test, mbstring_locale) {
+	// Multi-byte strings are recoded without libc where the locale allows it, and through it otherwise
+	std::string previous_locale = std::setlocale(LC_CTYPE, nullptr);
+	std::setlocale(LC_CTYPE, "C");
+	EXPECT_NE(impl_unicode::current_multibyte_encoding(), impl_unicode::multibyte_encoding::other);
+	EXPECT_EQ(mbstring_to_ustring<char16_t>("PRIVMSG #Jessilib :Hello"sv), std::make_pair(true, u"PRIVMSG #Jessilib :Hello"s));
+	EXPECT_EQ(ustring_to_mbstring(u"PRIVMSG #Jessilib :Hello"sv), std::make_pair(true, "PRIVMSG #Jessilib :Hello"s));
+
+	if (std::setlocale(LC_CTYPE, "C.UTF-8") != nullptr || std::setlocale(LC_CTYPE, "en_US.UTF-8") != nullptr) {
+		EXPECT_EQ(impl_unicode::current_multibyte_encoding(), impl_unicode::multibyte_encoding::utf_8);
+		std::string_view mbstring = "PRIVMSG #Jessilib :\xC3\x9Cn\xC3\xAF" "c\xC3\xB6" "d\xC3\xA9 \xF0\x9F\x98\x84"sv;
+		EXPECT_EQ(mbstring_to_ustring<char16_t>(mbstring), std::make_pair(true, u"PRIVMSG #Jessilib :Ünïcödé \U0001F604"s));
+		EXPECT_EQ(ustring_to_mbstring(U"PRIVMSG #Jessilib :Ünïcödé \U0001F604"sv), std::make_pair(true, std::string{ mbstring }));
+		EXPECT_FALSE(mbstring_to_ustring<char8_t>("Jessilib\xC3"sv).first);
+	}
+
+	std::setlocale(LC_CTYPE, previous_locale.c_str());
+}
+
 TEST(UTF8Test, string_view_cast) {
 	std::string_view abcd_str = "ABCD";
 	auto view = string_view_cast<char8_t>(abcd_str);
@@ -201,6 +334,84 @@ TYPED_TEST(UnicodeFullTest, equalsi) {
 		jessilib::string_cast<typename TypeParam::second_type>(U"abCD")));
 }
 
+TYPED_TEST(UnicodeFullTest, equalsi_long) {
+	using LhsCharT = typename TypeParam::first_type;
+	using RhsCharT = typename TypeParam::second_type;
+
+	// Long enough to be compared in blocks; mismatches & non-ASCII codepoints at each position
+	std::u32string text = U"PRIVMSG #Jessilib :Some text, [long] enough for {several} blocks @ ~`";
+	std::u32string upper = U"privmsg #jESSILIB :sOME TEXT, [LONG] ENOUGH FOR {SEVERAL} BLOCKS @ ~`";
+	EXPECT_TRUE(equalsi(string_cast<LhsCharT>(text), string_cast<RhsCharT>(upper)));
+	EXPECT_TRUE(starts_withi(string_cast<LhsCharT>(text), string_cast<RhsCharT>(upper.substr(0, 40))));
+	EXPECT_TRUE(starts_with(string_cast<LhsCharT>(text), string_cast<RhsCharT>(text.substr(0, 40))));
+	EXPECT_EQ(starts_with_lengthi(string_cast<LhsCharT>(text), string_cast<RhsCharT>(upper.substr(0, 40))), 40U);
+
+	for (size_t index = 0; index != text.size(); ++index) {
+		std::u32string mismatch = upper;
+		mismatch[index] = U'é'; // Never an ASCII character
+		EXPECT_FALSE(equalsi(string_cast<LhsCharT>(text), string_cast<RhsCharT>(mismatch)));
+		EXPECT_FALSE(starts_withi(string_cast<LhsCharT>(text), string_cast<RhsCharT>(mismatch)));
+
+		// Non-ASCII codepoints fall back to full case folding
+		std::u32string upper_e = text;
+		upper_e[index] = U'É';
+		std::u32string lower_e = upper;
+		lower_e[index] = U'é';
+		EXPECT_TRUE(equalsi(string_cast<LhsCharT>(upper_e), string_cast<RhsCharT>(lower_e)));
+		EXPECT_FALSE(equals(string_cast<LhsCharT>(upper_e), string_cast<RhsCharT>(lower_e)));
+
+		// '[' & '{' differ only by 0x20, same as case
+		std::u32string bracket = text;
+		bracket[index] = U'[';
+		std::u32string brace = text;
+		brace[index] = U'{';
+		EXPECT_FALSE(equalsi(string_cast<LhsCharT>(bracket), string_cast<RhsCharT>(brace)));
+	}
+}
+
+/** text_hash */
+
+TYPED_TEST(UnicodeFullTest, text_hash) {
+	using LhsCharT = typename TypeParam::first_type;
+	using RhsCharT = typename TypeParam::second_type;
+
+	// Mixed lengths & content, so that both the ASCII & decoding paths are hit
+	for (std::u32string text : { U""s, U"nick"s, U"#Jessilib_Channel_Name"s, U"#Jéssilib_Chännel_Name_ΣΊΣΥΦΟΣ"s, U"ASCII then \U0001F604"s }) {
+		auto lhs = string_cast<LhsCharT>(text);
+		auto rhs = string_cast<RhsCharT>(text);
+		EXPECT_EQ(text_hash{}(lhs), text_hash{}(rhs));
+		EXPECT_EQ(text_hashi{}(lhs), text_hashi{}(rhs));
+		EXPECT_EQ(text_hash::hash(text.data(), text.data() + text.size()), text_hash{}(lhs));
+
+		std::u32string folded;
+		for (char32_t codepoint : text) {
+			folded += fold(codepoint);
+		}
+		EXPECT_EQ(text_hashi{}(lhs), text_hash{}(string_cast<RhsCharT>(folded)));
+	}
+
+	EXPECT_NE(text_hash{}(string_cast<LhsCharT>(U"#Jessilib_Channel_Name")),
+		text_hash{}(string_cast<RhsCharT>(U"#JESSILIB_CHANNEL_NAME")));
+	EXPECT_EQ(text_hashi{}(string_cast<LhsCharT>(U"#Jessilib_Channel_Name")),
+		text_hashi{}(string_cast<RhsCharT>(U"#JESSILIB_CHANNEL_NAME")));
+}
+
+TYPED_TEST(UnicodeFullTest, text_hash_unordered_map) {
+	using LhsCharT = typename TypeParam::first_type;
+	using RhsCharT = typename TypeParam::second_type;
+
+	std::unordered_map<std::basic_string<LhsCharT>, int, text_hashi, text_equali> channels;
+	channels[string_cast<LhsCharT>(U"#Jessilib")] = 1;
+	channels[string_cast<LhsCharT>(U"#Ünïcödé")] = 2;
+
+	auto key = string_cast<RhsCharT>(U"#ÜNÏCÖDÉ");
+	auto itr = channels.find(std::basic_string_view<RhsCharT>{ key });
+	ASSERT_NE(itr, channels.end());
+	EXPECT_EQ(itr->second, 2);
+	EXPECT_EQ(channels.count(string_cast<RhsCharT>(U"#JESSILIB")), 1U);
+	EXPECT_EQ(channels.count(string_cast<RhsCharT>(U"#jessilib2")), 0U);
+}
+
 /** starts_with */
 
 TYPED_TEST(UnicodeFullTest, starts_with) {
@@ -327,6 +538,54 @@ TYPED_TEST(UnicodeFullTest, find) {
 	EXPECT_EQ(find(double_abcd_str, jessilib::string_cast<typename TypeParam::second_type>(U"DA")), decltype(double_abcd_str)::npos);
 }
 
+TYPED_TEST(UnicodeFullTest, find_long) {
+	using LhsCharT = typename TypeParam::first_type;
+	using RhsCharT = typename TypeParam::second_type;
+
+	// Compare against searching folded UTF-32 text; simple case folding never changes the number of codepoints
+	std::u32string text;
+	for (size_t index = 0; index != 40; ++index) {
+		text += U"PRIVMSG #Jessilib :Ünïcödé text, \U0001F604 and ΣΊΣΥΦΟΣ \u212A ſ; "s;
+		text += static_cast<char32_t>(U'a' + index % 26);
+	}
+	std::u32string folded_text;
+	for (char32_t codepoint : text) {
+		folded_text += fold(codepoint);
+	}
+
+	auto lhs_text = string_cast<LhsCharT>(text);
+	auto lhs_position = [&text](size_t in_position) {
+		if (in_position == std::u32string::npos) {
+			return std::basic_string<LhsCharT>::npos;
+		}
+		return string_cast<LhsCharT>(text.substr(0, in_position)).size();
+	};
+
+	std::mt19937 generator{ 1234 };
+	for (size_t iteration = 0; iteration != 500; ++iteration) {
+		size_t start = generator() % text.size();
+		std::u32string substring = text.substr(start, 1 + generator() % 24);
+		if (iteration % 3 == 0) {
+			substring.back() = U'\U0001F600'; // Usually not present
+		}
+		std::u32string swapped_case;
+		for (char32_t codepoint : substring) {
+			swapped_case += (codepoint >= U'a' && codepoint <= U'z') ? codepoint - 32 : fold(codepoint);
+		}
+		std::u32string folded_substring;
+		for (char32_t codepoint : substring) {
+			folded_substring += fold(codepoint);
+		}
+
+		EXPECT_EQ(find(lhs_text, string_cast<RhsCharT>(substring)), lhs_position(text.find(substring)));
+		EXPECT_EQ(findi(lhs_text, string_cast<RhsCharT>(swapped_case)), lhs_position(folded_text.find(folded_substring)));
+	}
+
+	// Needles only found case-insensitively, through non-ASCII codepoints which fold to ASCII
+	EXPECT_EQ(find(lhs_text, string_cast<RhsCharT>(U"k s;")), decltype(lhs_text)::npos);
+	EXPECT_EQ(findi(lhs_text, string_cast<RhsCharT>(U"k s;")), lhs_position(text.find(U"\u212A ſ;")));
+}
+
 TYPED_TEST(UnicodeFullTest, findi) {
 	auto abcd_str = jessilib::string_cast<typename TypeParam::first_type>(U"ABCD");
 
@@ -395,6 +654,7 @@ TYPED_TEST(UnicodeFullTest, findi) {
 struct folding_info {
 	uint32_t in_codepoint;
 	uint32_t out_codepoint;
+	std::u32string out_full; // Full case folding; empty if none
 };
 
 constexpr bool operator<(const folding_info& lhs, uint32_t rhs) {
@@ -406,10 +666,16 @@ constexpr bool operator<(uint32_t lhs, const folding_info& rhs) {
 }
 
 // TODO: make this just download from unicode.org (https://www.unicode.org/Public/UCD/latest/ucd/CaseFolding.txt)
-std::vector<folding_info> read_CaseFolding_txt(const char* filename = JESSITEST_DATA_DIR "CaseFolding.txt") {
+std::vector<folding_info> read_CaseFolding_txt(const char* filename = JESSITEST_UNICODE_DATA_DIR "CaseFolding.txt") {
 	std::vector<folding_info> result;
 	std::ifstream file{ filename };
 
+	auto parse_codepoint = [](std::string_view in_text) {
+		uint32_t codepoint{};
+		std::from_chars(in_text.data(), in_text.data() + in_text.size(), codepoint, 16);
+		return codepoint;
+	};
+
 	while (file.good() && !file.eof()) {
 		std::string line;
 		std::getline(file, line);
@@ -418,116 +684,27 @@ std::vector<folding_info> read_CaseFolding_txt(const char* filename = JESSITEST_
 			continue;
 		}
 
-		// From CaseFolding.txt usage; we're doing simple case folding:
+		// From CaseFolding.txt usage:
 		// "A. To do a simple case folding, use the mappings with status C + S."
 		// "B. To do a full case folding, use the mappings with status C + F."
-		if (split_line[1] == "C" || split_line[1] == "S") {
-			folding_info info;
-			std::from_chars(split_line[0].data(), split_line[0].data() + split_line[0].size(), info.in_codepoint, 16);
-			std::from_chars(split_line[2].data(), split_line[2].data() + split_line[2].size(), info.out_codepoint, 16);
-			result.push_back(info);
-		}
-		//else {
-		//	std::cout << "ignoring: " << line << std::endl;
-		//}
-	}
-
-	return result;
-}
-
-// describes a range
-struct folding_set {
-	enum class mode_type {
-		constant,
-		alternating,
-		single
-	} mode = mode_type::single;
-
-	uint32_t range_start; // inclusive
-	uint32_t range_end; // inclusive
-	int64_t diff; // difference between two codepoints
-
-	const char* type() const {
-		switch (mode) {
-			case mode_type::constant:
-				return "constant";
-			case mode_type::alternating:
-				return "alternating";
-			case mode_type::single:
-				return "single";
-			default:
-				break;
-		}
-
-		return nullptr;
-	}
-};
-
-std::vector<folding_set> folding_sets_from_folding_info(const std::vector<folding_info>& in_info) {
-	std::vector<folding_set> result;
-
-	folding_set current{};
-	uint32_t last_match{};
-	for (auto& info : in_info) {
-		int64_t diff = static_cast<int64_t>(info.out_codepoint) - static_cast<int64_t>(info.in_codepoint);
-
-		if (current.diff == 0) {
-			// this is a new set; set range_start and diff
-			current.range_start = info.in_codepoint;
-			current.diff = diff;
-			last_match = info.in_codepoint;
+		// S & F entries for the same codepoint are adjacent, in either order
+		uint32_t in_codepoint = parse_codepoint(split_line[0]);
+		if (split_line[1] != "C" && split_line[1] != "S" && split_line[1] != "F") {
 			continue;
 		}
 
-		if (current.mode == folding_set::mode_type::single) {
-			// We don't know what mode we are yet; check if this is constant
-			if (diff == current.diff
-				&& info.in_codepoint == last_match + 1) {
-				// diff is same for range_start + 1; must be a constant-diff continuous set
-				current.mode = folding_set::mode_type::constant;
-				last_match = info.in_codepoint;
-				continue;
-			}
-
-			// Either one-off fold, or alternating set. Check if in_codepoint is last_match + 2
-			if (diff == current.diff
-				&& info.in_codepoint == last_match + 2) {
-				// Looks like an alternating set
-				current.mode = folding_set::mode_type::alternating;
-				last_match = info.in_codepoint;
-				continue;
-			}
+		if (result.empty() || result.back().in_codepoint != in_codepoint) {
+			result.push_back({ in_codepoint, in_codepoint, {} });
 		}
 
-		if (current.mode == folding_set::mode_type::constant // For constant offset diffs to continue...
-			&& current.diff == diff // Diff must be the same
-			&& last_match + 1 == info.in_codepoint) { // And current codepoint must be 1 higher than previous
-			// This matches the current range pattern; just update last_match and carry on
-			last_match = info.in_codepoint;
-			continue;
+		if (split_line[1] == "F") {
+			for (auto& codepoint : jessilib::split(split_line[2], ' ')) {
+				result.back().out_full += static_cast<char32_t>(parse_codepoint(codepoint));
+			}
 		}
-
-		if (current.mode == folding_set::mode_type::alternating // For alternating sets to continue...
-			&& current.diff == diff // Diff must be same
-			&& last_match + 2 == info.in_codepoint) { // And current codepoint must be 2 higher than previous
-			last_match = info.in_codepoint;
-			continue;
+		else {
+			result.back().out_codepoint = parse_codepoint(split_line[2]);
 		}
-
-		// This isn't a continuation of the current set; push current and start a new set
-		current.range_end = last_match;
-		result.push_back(current);
-
-		current = folding_set{};
-		current.range_start = info.in_codepoint;
-		current.diff = diff;
-		last_match = info.in_codepoint;
-	}
-
-	// Push final range
-	if (current.diff != 0) {
-		current.range_end = last_match;
-		result.push_back(current);
 	}
 
 	return result;
@@ -542,32 +719,23 @@ TEST(jess, unicode_case_folding_txt) {
 		EXPECT_EQ(jessilib::fold(folded_codepoint.in_codepoint), folded_codepoint.out_codepoint)
 			<< std::hex << std::uppercase << "lhs: " << std::setw(4) << folded_codepoint.in_codepoint << "; rhs: " << std::setw(8) << folded_codepoint.out_codepoint;
 		EXPECT_TRUE(jessilib::equalsi(folded_codepoint.in_codepoint, folded_codepoint.out_codepoint));
-	}
-
-	// If the above failed, print out what the fold table needs to be replaced with
-	if (::testing::Test::HasFailure()) {
-		auto folding_sets = folding_sets_from_folding_info(folded_codepoints);
-		ASSERT_FALSE(folding_sets.empty());
-		for (auto& set : folding_sets) {
-			// Generate code in the format: { folding_set::mode_type::constant, 0x1234, 0x2345, 1 },
-			std::cout << std::hex << std::uppercase << std::setfill('0') << "{ "
-				<< "folding_set::mode_type::" << set.type()
-				<< ", "
-				<< "0x" << std::setw(4) << set.range_start << ", "
-				<< "0x" << std::setw(4) << set.range_end << ", "
-				<< std::dec << set.diff
-				<< " }," << std::endl;
-		}
 
-		std::cout << "folded_codepoints.size(): " << folded_codepoints.size() << "; folding_sets.size(): " << folding_sets.size() << std::endl;
+		char32_t full[max_fold_full_length]{};
+		size_t full_length = fold_full(folded_codepoint.in_codepoint, full);
+		std::u32string expected_full = folded_codepoint.out_full.empty()
+			? std::u32string(1, folded_codepoint.out_codepoint)
+			: folded_codepoint.out_full;
+		EXPECT_EQ(std::u32string_view(full, full_length), expected_full)
+			<< std::hex << std::uppercase << "lhs: " << std::setw(4) << folded_codepoint.in_codepoint;
 	}
 
-	// Test that every non-folded codepoint in [0, 0xFFFF] is equal to itself; we already tested folded ones above
-	for (char32_t codepoint = 0; codepoint != 0x10000; ++codepoint) {
-		bool is_folded = std::binary_search(folded_codepoints.begin(), folded_codepoints.end(), codepoint);
-		if (!is_folded) {
-			EXPECT_EQ(codepoint, jessilib::fold(codepoint));
-			EXPECT_TRUE(jessilib::equalsi(codepoint, codepoint));
+	// Test that every other codepoint folds to itself; we already tested folded ones above
+	for (char32_t codepoint = 0; codepoint != 0x110000; ++codepoint) {
+		if (!std::binary_search(folded_codepoints.begin(), folded_codepoints.end(), codepoint)) {
+			ASSERT_EQ(codepoint, jessilib::fold(codepoint));
+			char32_t full[max_fold_full_length]{};
+			ASSERT_EQ(fold_full(codepoint, full), 1U);
+			ASSERT_EQ(full[0], codepoint);
 		}
 	}
 }
@@ -0,0 +1,286 @@
+/**
+ * Copyright (C) 2021 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include "jessilib/unicode_normalization.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <unordered_map>
+#include "jessilib/split.hpp"
+#include "test.hpp"
+
+using namespace jessilib;
+using namespace std::literals;
+
+using char_types = ::testing::Types<char8_t, char16_t, char32_t>;
+
+template<typename T>
+class NormalizationTest : public ::testing::Test {
+public:
+};
+TYPED_TEST_SUITE(NormalizationTest, char_types);
+
+namespace {
+
+template<typename CharT>
+std::u32string normalize_u32(std::u32string_view in_string, normalization_form in_form) {
+	auto string = string_cast<CharT>(in_string);
+	return string_cast<char32_t>(normalize(std::basic_string_view<CharT>{ string }, in_form));
+}
+
+struct normalization_test_line {
+	std::u32string source;
+	std::u32string nfc;
+	std::u32string nfd;
+	std::u32string nfkc;
+	std::u32string nfkd;
+	int part;
+};
+
+// Reads a file in the format of NormalizationTest.txt (https://www.unicode.org/Public/UCD/latest/ucd/NormalizationTest.txt)
+std::vector<normalization_test_line> read_NormalizationTest_txt(const char* filename = JESSITEST_DATA_DIR "NormalizationReference.txt") {
+	std::vector<normalization_test_line> result;
+	std::ifstream file{ filename };
+
+	auto parse_codepoints = [](std::string_view in_text) {
+		std::u32string codepoints;
+		for (auto& code : jessilib::split_view(in_text, ' ')) {
+			uint32_t codepoint{};
+			std::from_chars(code.data(), code.data() + code.size(), codepoint, 16);
+			codepoints += static_cast<char32_t>(codepoint);
+		}
+		return codepoints;
+	};
+
+	int part = 0;
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.starts_with("@Part")) {
+			part = line[5] - '0';
+			continue;
+		}
+
+		// Format: <source>;<NFC>;<NFD>;<NFKC>;<NFKD>; # <comment>
+		line = line.substr(0, line.find('#'));
+		auto split_line = jessilib::split_view(line, ';');
+		if (split_line.size() < 5) {
+			continue;
+		}
+
+		result.push_back({ parse_codepoints(split_line[0]), parse_codepoints(split_line[1]), parse_codepoints(split_line[2]),
+			parse_codepoints(split_line[3]), parse_codepoints(split_line[4]), part });
+	}
+
+	return result;
+}
+
+std::string hex_string(std::u32string_view in_string) {
+	std::string result;
+	for (char32_t codepoint : in_string) {
+		char buffer[8];
+		auto to_chars_result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<uint32_t>(codepoint), 16);
+		if (!result.empty()) {
+			result += ' ';
+		}
+		result.append(buffer, to_chars_result.ptr);
+	}
+
+	return result;
+}
+
+} // namespace
+
+TYPED_TEST(NormalizationTest, normalize) {
+	// Composition & decomposition
+	EXPECT_EQ(normalize_u32<TypeParam>(U"e\u0301", normalization_form::nfc), U"é");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"é", normalization_form::nfd), U"e\u0301");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"Jessi\u0301lib", normalization_form::nfc), U"Jessílib");
+
+	// Canonical ordering of combining marks; U+0323 (220) sorts before U+0307 (230)
+	EXPECT_EQ(normalize_u32<TypeParam>(U"s\u0307\u0323", normalization_form::nfd), U"s\u0323\u0307");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"s\u0307\u0323", normalization_form::nfc), U"ṩ");
+
+	// Singletons & composition exclusions never compose
+	EXPECT_EQ(normalize_u32<TypeParam>(U"\u212B", normalization_form::nfc), U"Å"); // ANGSTROM SIGN
+	EXPECT_EQ(normalize_u32<TypeParam>(U"\u0958", normalization_form::nfc), U"क\u093C");
+
+	// Hangul
+	EXPECT_EQ(normalize_u32<TypeParam>(U"한", normalization_form::nfd), U"\u1112\u1161\u11AB");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"\u1112\u1161\u11AB", normalization_form::nfc), U"한");
+
+	// Compatibility
+	EXPECT_EQ(normalize_u32<TypeParam>(U"ﬁ", normalization_form::nfc), U"ﬁ");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"ﬁ", normalization_form::nfkc), U"fi");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"ẛ\u0323", normalization_form::nfkc), U"ṩ");
+	EXPECT_EQ(normalize_u32<TypeParam>(U"ẛ\u0323", normalization_form::nfkd), U"s\u0323\u0307");
+
+	// Normalized text is untouched
+	EXPECT_EQ(normalize_u32<TypeParam>(U"PRIVMSG #Jessilib :Ünïcödé \U0001F604", normalization_form::nfc),
+		U"PRIVMSG #Jessilib :Ünïcödé \U0001F604");
+}
+
+TYPED_TEST(NormalizationTest, quick_check) {
+	auto check = [](std::u32string_view in_string, normalization_form in_form) {
+		auto string = string_cast<TypeParam>(in_string);
+		return quick_check(std::basic_string_view<TypeParam>{ string }, in_form);
+	};
+
+	EXPECT_EQ(check(U"", normalization_form::nfc), quick_check_result::yes);
+	EXPECT_EQ(check(U"ASCII text is always normalized", normalization_form::nfkd), quick_check_result::yes);
+	EXPECT_EQ(check(U"é", normalization_form::nfc), quick_check_result::yes);
+	EXPECT_EQ(check(U"é", normalization_form::nfd), quick_check_result::no);
+	EXPECT_EQ(check(U"e\u0301", normalization_form::nfc), quick_check_result::maybe);
+	EXPECT_EQ(check(U"e\u0301", normalization_form::nfd), quick_check_result::yes);
+	EXPECT_EQ(check(U"s\u0307\u0323", normalization_form::nfd), quick_check_result::no); // Out of order
+	EXPECT_EQ(check(U"\u212B", normalization_form::nfc), quick_check_result::no);
+	EXPECT_EQ(check(U"ﬁ", normalization_form::nfc), quick_check_result::yes);
+	EXPECT_EQ(check(U"ﬁ", normalization_form::nfkc), quick_check_result::no);
+
+	auto normalized = [](std::u32string_view in_string, normalization_form in_form) {
+		auto string = string_cast<TypeParam>(in_string);
+		return is_normalized(std::basic_string_view<TypeParam>{ string }, in_form);
+	};
+
+	EXPECT_TRUE(normalized(U"क\u0301", normalization_form::nfc)); // Maybe, but doesn't compose
+	EXPECT_FALSE(normalized(U"e\u0301", normalization_form::nfc));
+	EXPECT_FALSE(normalized(U"\u212B", normalization_form::nfc));
+}
+
+TYPED_TEST(NormalizationTest, invalid) {
+	if constexpr (sizeof(TypeParam) == 1) {
+		std::u8string text{ u8"e\u0301" };
+		text += static_cast<char8_t>(0x80);
+		EXPECT_EQ(quick_check(std::u8string_view{ text }), quick_check_result::no);
+		EXPECT_FALSE(is_normalized(std::u8string_view{ text }));
+		EXPECT_TRUE(normalize(std::u8string_view{ text }).empty());
+		EXPECT_FALSE(equals_normalized(std::u8string_view{ text }, std::u8string_view{ text }));
+	}
+}
+
+TYPED_TEST(NormalizationTest, equals_normalized) {
+	auto lhs = string_cast<TypeParam>(U"Jessi\u0301lib \u212B"sv);
+	EXPECT_TRUE(equals_normalized(lhs, u8"Jessílib Å"sv));
+	EXPECT_TRUE(equals_normalized(lhs, U"Jessi\u0301lib A\u030A"sv));
+	EXPECT_FALSE(equals_normalized(lhs, u8"Jessilib Å"sv));
+	EXPECT_FALSE(equals_normalized(lhs, u8"JESSÍLIB å"sv));
+	EXPECT_TRUE(equalsi_normalized(lhs, u8"JESSÍLIB å"sv));
+	EXPECT_TRUE(equalsi_normalized(lhs, U"JESSI\u0301LIB a\u030A"sv));
+	EXPECT_FALSE(equalsi_normalized(lhs, u8"JESSILIB å"sv));
+
+	// Folding alters lengths; same-type comparisons must not be rejected for it
+	auto long_s = string_cast<TypeParam>(U"ſi\u0301"sv);
+	auto short_s = string_cast<TypeParam>(U"Sí"sv);
+	EXPECT_TRUE(equalsi_normalized(long_s, short_s));
+}
+
+TYPED_TEST(NormalizationTest, text_hash_normalized) {
+	std::unordered_map<std::basic_string<TypeParam>, int, text_hash_normalized, text_equal_normalized> map;
+	map[string_cast<TypeParam>(U"Jessílib"sv)] = 1;
+	map[string_cast<TypeParam>(U"Jessi\u0301lib"sv)] += 1;
+	map[string_cast<TypeParam>(U"JESSÍLIB"sv)] += 1;
+	EXPECT_EQ(map.size(), 2U);
+	EXPECT_EQ(map[string_cast<TypeParam>(U"Jessílib"sv)], 2);
+
+	std::unordered_map<std::basic_string<TypeParam>, int, text_hashi_normalized, text_equali_normalized> mapi;
+	mapi[string_cast<TypeParam>(U"Jessílib"sv)] = 1;
+	mapi[string_cast<TypeParam>(U"Jessi\u0301lib"sv)] += 1;
+	mapi[string_cast<TypeParam>(U"JESSÍLIB"sv)] += 1;
+	mapi[string_cast<TypeParam>(U"JESSI\u0301LIB"sv)] += 1;
+	mapi[string_cast<TypeParam>(U"ſ"sv)] += 1;
+	mapi[string_cast<TypeParam>(U"s"sv)] += 1;
+	EXPECT_EQ(mapi.size(), 2U);
+	EXPECT_EQ(mapi[string_cast<TypeParam>(U"jessílib"sv)], 4);
+	EXPECT_EQ(mapi[string_cast<TypeParam>(U"S"sv)], 2);
+}
+
+TEST(NormalizationTest, all_codepoints) {
+	// Normalization forms are stable & consistent with each other, for every codepoint
+	for (char32_t codepoint = 0; codepoint <= 0x10FFFF; ++codepoint) {
+		if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+			continue;
+		}
+
+		std::u32string_view string{ &codepoint, 1 };
+		std::u32string nfc = normalize(string, normalization_form::nfc);
+		std::u32string nfd = normalize(string, normalization_form::nfd);
+		std::u32string nfkc = normalize(string, normalization_form::nfkc);
+		std::u32string nfkd = normalize(string, normalization_form::nfkd);
+		ASSERT_EQ(normalize(nfd, normalization_form::nfc), nfc);
+		ASSERT_EQ(normalize(nfc, normalization_form::nfd), nfd);
+		ASSERT_EQ(normalize(nfkd, normalization_form::nfkc), nfkc);
+		ASSERT_EQ(normalize(nfkc, normalization_form::nfkd), nfkd);
+		ASSERT_TRUE(is_normalized(std::u32string_view{ nfc }, normalization_form::nfc));
+		ASSERT_TRUE(is_normalized(std::u32string_view{ nfd }, normalization_form::nfd));
+		ASSERT_TRUE(is_normalized(std::u32string_view{ nfkc }, normalization_form::nfkc));
+		ASSERT_TRUE(is_normalized(std::u32string_view{ nfkd }, normalization_form::nfkd));
+		ASSERT_EQ(is_normalized(string, normalization_form::nfc), nfc == string);
+		ASSERT_EQ(is_normalized(string, normalization_form::nfd), nfd == string);
+	}
+}
+
+TEST(NormalizationTest, normalization_test_txt) {
+	auto test_lines = read_NormalizationTest_txt();
+	ASSERT_FALSE(test_lines.empty());
+
+	// Conformance, per NormalizationTest.txt:
+	// NFC: c2 == toNFC(c1) == toNFC(c2) == toNFC(c3); c4 == toNFC(c4) == toNFC(c5)
+	// NFD: c3 == toNFD(c1) == toNFD(c2) == toNFD(c3); c5 == toNFD(c4) == toNFD(c5)
+	// NFKC: c4 == toNFKC(c1) == toNFKC(c2) == toNFKC(c3) == toNFKC(c4) == toNFKC(c5)
+	// NFKD: c5 == toNFKD(c1) == toNFKD(c2) == toNFKD(c3) == toNFKD(c4) == toNFKD(c5)
+	std::vector<char32_t> part1_codepoints;
+	for (auto& test_line : test_lines) {
+		auto expect_normalized = [&test_line](std::initializer_list<const std::u32string*> in_sources, normalization_form in_form,
+			const std::u32string& in_expected) {
+			for (const std::u32string* source : in_sources) {
+				EXPECT_EQ(normalize(std::u32string_view{ *source }, in_form), in_expected)
+					<< "source: " << hex_string(test_line.source) << "; form: " << static_cast<int>(in_form);
+				EXPECT_EQ(is_normalized(std::u32string_view{ *source }, in_form), *source == in_expected)
+					<< "source: " << hex_string(test_line.source) << "; form: " << static_cast<int>(in_form);
+			}
+		};
+
+		expect_normalized({ &test_line.source, &test_line.nfc, &test_line.nfd }, normalization_form::nfc, test_line.nfc);
+		expect_normalized({ &test_line.nfkc, &test_line.nfkd }, normalization_form::nfc, test_line.nfkc);
+		expect_normalized({ &test_line.source, &test_line.nfc, &test_line.nfd }, normalization_form::nfd, test_line.nfd);
+		expect_normalized({ &test_line.nfkc, &test_line.nfkd }, normalization_form::nfd, test_line.nfkd);
+		expect_normalized({ &test_line.source, &test_line.nfc, &test_line.nfd, &test_line.nfkc, &test_line.nfkd },
+			normalization_form::nfkc, test_line.nfkc);
+		expect_normalized({ &test_line.source, &test_line.nfc, &test_line.nfd, &test_line.nfkc, &test_line.nfkd },
+			normalization_form::nfkd, test_line.nfkd);
+
+		if (test_line.part == 1) {
+			part1_codepoints.push_back(test_line.source.front());
+		}
+	}
+	ASSERT_FALSE(part1_codepoints.empty());
+
+	// Every codepoint not listed in part 1 is unchanged by every form
+	std::sort(part1_codepoints.begin(), part1_codepoints.end());
+	for (char32_t codepoint = 0; codepoint <= 0x10FFFF; ++codepoint) {
+		if ((codepoint >= 0xD800 && codepoint <= 0xDFFF)
+			|| std::binary_search(part1_codepoints.begin(), part1_codepoints.end(), codepoint)) {
+			continue;
+		}
+
+		std::u32string_view string{ &codepoint, 1 };
+		for (auto form : { normalization_form::nfc, normalization_form::nfd, normalization_form::nfkc, normalization_form::nfkd }) {
+			ASSERT_TRUE(is_normalized(string, form)) << hex_string(string);
+			ASSERT_EQ(normalize(string, form), string) << hex_string(string);
+		}
+	}
+}
@@ -18,8 +18,9 @@
 
 #include "jessilib/unicode_sequence.hpp"
 #include <charconv>
+#include <random>
 #include "jessilib/unicode.hpp" // string_cast
-#include "test.hpp"
+#include "test_sequence.hpp"
 
 using namespace std::literals;
 
@@ -32,6 +33,7 @@ constexpr std::u8string cpp_constexpr(std::u8string_view in_expression) {
 }
 ASSERT_COMPILES_CONSTEXPR(return cpp_constexpr(u8"test"s) == u8"test"s);
 ASSERT_COMPILES_CONSTEXPR(return cpp_constexpr(u8"\\r\\n"s) == u8"\r\n"s);
+ASSERT_COMPILES_CONSTEXPR(return jessilib::make_cpp_escape_sequences<char8_t>(u8"\r\n\x01"sv) == u8"\\r\\n\\001"s);
 #endif // __cpp_lib_constexpr_string
 
 #ifdef JESSILIB_CHAR_AS_UTF8
@@ -204,3 +206,56 @@ TYPED_TEST(UnicodeSequenceTest, cpp_u32) {
 		EXPECT_EQ(decode.codepoint, static_cast<char32_t>(codepoint));
 	}
 }
+
+TYPED_TEST(UnicodeSequenceTest, cpp_runs) {
+	// Skipping between triggers must match decoding every codepoint, including around block boundaries
+	constexpr std::u8string_view pieces[]{
+		u8"text", u8"Jessilib", u8"\\", u8"\\n", u8"\\\\", u8"\\x4A", u8"\\101", u8"\\u00e9", u8"\\q", u8"é", u8"\U0001F604", u8"\n"
+	};
+
+	constexpr size_t tree_size = std::size(jessilib::cpp_escapes_root_tree<TypeParam>);
+	expect_shrink_sequence_runs_match<TypeParam, jessilib::cpp_escapes_root_tree<TypeParam>, tree_size>(pieces);
+}
+
+TYPED_TEST(UnicodeSequenceTest, cpp_escape) {
+	auto escape = [](std::u8string_view in_string) {
+		return jessilib::make_cpp_escape_sequences<TypeParam>(jessilib::string_cast<TypeParam>(in_string));
+	};
+
+	EXPECT_EQ(escape(u8""), jessilib::string_cast<TypeParam>(u8""));
+	EXPECT_EQ(escape(u8"test"), jessilib::string_cast<TypeParam>(u8"test"));
+	EXPECT_EQ(escape(u8"\"test\"\r\n"), jessilib::string_cast<TypeParam>(u8"\\\"test\\\"\\r\\n"));
+	EXPECT_EQ(escape(u8"C:\\Windows\t\x01" "a\x7F"), jessilib::string_cast<TypeParam>(u8"C:\\\\Windows\\t\\001a\\177"));
+	EXPECT_EQ(escape(u8"Ünïcödé \U0001F604\a"), jessilib::string_cast<TypeParam>(u8"Ünïcödé \U0001F604\\a"));
+}
+
+TYPED_TEST(UnicodeSequenceTest, cpp_escape_round_trip) {
+	// Every ASCII unit, amongst runs of varying lengths so that they land at every offset within a block
+	std::mt19937 generator{ 1234 };
+	for (size_t iteration = 0; iteration != 500; ++iteration) {
+		std::basic_string<TypeParam> string;
+		size_t unit_count = generator() % 32;
+		for (size_t index = 0; index != unit_count; ++index) {
+			string += static_cast<TypeParam>(generator() % 0x80);
+			string += jessilib::string_cast<TypeParam>(u8"text"sv.substr(0, generator() % 5));
+			if (generator() % 4 == 0) {
+				string += jessilib::string_cast<TypeParam>(u8"Σ\U0001F604"sv);
+			}
+		}
+
+		auto escaped = jessilib::make_cpp_escape_sequences<TypeParam>(string);
+		EXPECT_EQ((jessilib::escaped_length<TypeParam, jessilib::cpp_escape_table>(string)), escaped.size());
+		EXPECT_TRUE(jessilib::apply_cpp_escape_sequences(escaped));
+		EXPECT_EQ(escaped, string);
+	}
+}
+
+TYPED_TEST(UnicodeSequenceTest, json_escape) {
+	auto escape = [](std::u8string_view in_string) {
+		return jessilib::make_json_escape_sequences<TypeParam>(jessilib::string_cast<TypeParam>(in_string));
+	};
+
+	EXPECT_EQ(escape(u8"test"), jessilib::string_cast<TypeParam>(u8"test"));
+	EXPECT_EQ(escape(u8"\"test\"\r\n\x1F\x7F"), jessilib::string_cast<TypeParam>(u8"\\\"test\\\"\\u000d\\u000a\\u001f\x7F"));
+	EXPECT_EQ(escape(u8"C:\\Windows/Ünïcödé"), jessilib::string_cast<TypeParam>(u8"C:\\\\Windows/Ünïcödé"));
+}
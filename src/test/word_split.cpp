@@ -58,6 +58,12 @@ public:
 };
 TYPED_TEST_SUITE(WordSplitNTest, char_types);
 
+template<typename T>
+class WordSplitRangeTest : public ::testing::Test {
+public:
+};
+TYPED_TEST_SUITE(WordSplitRangeTest, char_types);
+
 TYPED_TEST(WordSplitSVTest, empty) {
 	std::basic_string_view<TypeParam> empty;
 	std::vector<std::basic_string<TypeParam>> split_result = word_split(empty, default_delim<TypeParam>);
@@ -278,3 +284,79 @@ TYPED_TEST(WordSplitStringTest, random_long_prefix_two_delim) {
 	std::vector<std::basic_string<TypeParam>> split_result = word_split(data.m_str, delim);
 	EXPECT_EQ(split_result, data.m_tokens);
 }
+
+/** WordSplitRangeTest */
+
+static_assert(std::ranges::view<decltype(word_split_range("a b"sv, ' '))>);
+
+TYPED_TEST(WordSplitRangeTest, random) {
+	RandomWordTestData<TypeParam> data{};
+	std::vector<std::basic_string<TypeParam>> words;
+	for (std::basic_string_view<TypeParam> word : word_split_range(data.m_str, default_delim<TypeParam>)) {
+		words.emplace_back(word);
+	}
+
+	EXPECT_EQ(words, data.m_tokens);
+}
+
+TYPED_TEST(WordSplitRangeTest, random_long) {
+	auto delim = make_delim_long<TypeParam>(8);
+	RandomWordTestData<TypeParam> data{ delim };
+	data.m_str = delim + data.m_str + delim;
+	std::vector<std::basic_string<TypeParam>> words;
+	for (std::basic_string_view<TypeParam> word : word_split_range(data.m_str, delim)) {
+		words.emplace_back(word);
+	}
+
+	EXPECT_EQ(words, data.m_tokens);
+}
+
+TYPED_TEST(WordSplitRangeTest, take) {
+	RandomWordTestData<TypeParam> data{};
+	constexpr size_t n = 3;
+	size_t index = 0;
+	for (auto word : word_split_range(data.m_str, default_delim<TypeParam>) | std::views::take(n)) {
+		EXPECT_EQ(word, data.m_tokens[index]);
+		++index;
+	}
+	EXPECT_EQ(index, n);
+}
+
+TEST(WordSplitRangeTest, edges) {
+	EXPECT_TRUE(word_split_range(""sv, ' ').empty());
+	EXPECT_TRUE(word_split_range("   "sv, ' ').empty());
+	EXPECT_TRUE(word_split_range(" \t "sv, " \t"sv).empty());
+	EXPECT_EQ(word_split_range(" a b"sv, ""sv).front(), " a b"sv);
+	EXPECT_EQ(std::ranges::distance(word_split_range("\ta b \t c\t"sv, " \t"sv)), 3);
+}
+
+TEST(WordSplitTest, mixed_iterators) {
+	// An iterator and a const_iterator may be passed together
+	std::string input = " a b\t c "s;
+	std::string whitespace = " \t"s;
+	EXPECT_EQ(word_split(input.cbegin(), input.end(), ' '), (std::vector<std::string>{ "a", "b\t", "c" }));
+	EXPECT_EQ(word_split(input.begin(), input.cend(), whitespace.cbegin(), whitespace.end()), (std::vector<std::string>{ "a", "b", "c" }));
+	EXPECT_EQ(word_split_n(input.begin(), input.cend(), ' ', 1), (std::vector<std::string>{ "a", "b\t c " }));
+	EXPECT_EQ(word_split_n(input.cbegin(), input.end(), whitespace.begin(), whitespace.cend(), 1), (std::vector<std::string>{ "a", "b\t c " }));
+	EXPECT_EQ(std::ranges::distance(word_split_range(input.begin(), input.cend(), ' ')), 3);
+}
+
+TEST(WordSplitNTest, whitespace_set) {
+	// Any whitespace in the set separates words
+	auto split_result = word_split_n_view("  a \tb\tc  d "sv, " \t"sv, 2);
+	ASSERT_EQ(split_result.size(), 3U);
+	EXPECT_EQ(split_result[0], "a"sv);
+	EXPECT_EQ(split_result[1], "b"sv);
+	EXPECT_EQ(split_result[2], "c  d "sv);
+}
+
+TEST(WordSplitRangeTest, whitespace_set_wide) {
+	// Whitespace above 0xFF isn't in the bitmap
+	std::vector<std::u16string_view> words;
+	for (auto word : word_split_range(u"　a b 　c"sv, u"  　"sv)) {
+		words.push_back(word);
+	}
+
+	EXPECT_EQ(words, (std::vector<std::u16string_view>{ u"a"sv, u"b"sv, u"c"sv }));
+	EXPECT_EQ(word_split_view(u"aĠb"sv, u" 　"sv).size(), 1U); // Shares a low byte with ' '
+}